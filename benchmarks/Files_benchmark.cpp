@@ -0,0 +1,30 @@
+#include "Color.hpp"
+#include "FrameBuffer.hpp"
+#include "Files.hpp"
+
+#include "benchmark/benchmark.h"
+
+#include <filesystem>
+#include <string>
+
+static void BM_WritePpmWithGammaCorrection(benchmark::State& state)
+{
+    const size_t width  = static_cast<size_t>(state.range(0));
+    const size_t height = static_cast<size_t>(state.range(1));
+    FrameBuffer frameBuffer{ width, height };
+    for (size_t i = 0; i < frameBuffer.numPixels(); i++) {
+        frameBuffer.setPixel(i, Color((i % width) / float(width), (i / width) / float(height), 0.50f));
+    }
+
+    const std::string filepath = (std::filesystem::temp_directory_path() / "RayTracerBenchmarks.ppm").string();
+    for (auto _ : state) {
+        Files::writePpmWithGammaCorrection(filepath, frameBuffer, 2.20f);
+    }
+    std::filesystem::remove(filepath);
+    state.SetItemsProcessed(state.iterations() * frameBuffer.numPixels());
+    state.SetBytesProcessed(state.iterations() * frameBuffer.numPixels() * 3);
+}
+BENCHMARK(BM_WritePpmWithGammaCorrection)
+    ->Args({  640,  360 })
+    ->Args({ 1920, 1080 })
+    ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,29 @@
+#include "benchmark/benchmark.h"
+
+#include <string>
+#include <vector>
+
+// results are also written as json (to RayTracerBenchmarks.json unless --benchmark_out is given), for tracking
+// regressions across runs
+int main(int argc, char** argv) {
+    std::vector<char*> args(argv, argv + argc);
+    bool hasOutputFile = false;
+    for (const char* arg : args) {
+        hasOutputFile = hasOutputFile || std::string(arg).rfind("--benchmark_out=", 0) == 0;
+    }
+    std::string outputFileArg   = "--benchmark_out=RayTracerBenchmarks.json";
+    std::string outputFormatArg = "--benchmark_out_format=json";
+    if (!hasOutputFile) {
+        args.push_back(outputFileArg.data());
+        args.push_back(outputFormatArg.data());
+    }
+
+    int numArgs = static_cast<int>(args.size());
+    benchmark::Initialize(&numArgs, args.data());
+    if (benchmark::ReportUnrecognizedArguments(numArgs, args.data())) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
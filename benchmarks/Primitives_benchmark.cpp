@@ -0,0 +1,104 @@
+#include "Math.hpp"
+#include "Ray.hpp"
+#include "Material.hpp"
+#include "Objects.hpp"
+#include "Camera.hpp"
+#include "CameraRayGenerator.hpp"
+
+#include "benchmark/benchmark.h"
+
+#include <random>
+#include <vector>
+
+namespace {
+
+    // rays from a fixed origin towards random points on a square around the origin, about half of them passing
+    // within a unit distance of it, so hits and misses are mixed unpredictably
+    std::vector<Ray> createRays(size_t count)
+    {
+        std::mt19937 rng{ 13 };
+        std::uniform_real_distribution<float> offset{ -1.40f, 1.40f };
+        const Vec3 origin{ 0.0f, 0.0f, 10.0f };
+        std::vector<Ray> rays;
+        rays.reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            const Vec3 target{ offset(rng), offset(rng), 0.0f };
+            rays.push_back(Ray(origin, Math::direction(origin, target)));
+        }
+        return rays;
+    }
+
+    constexpr size_t NUM_RAYS = 1024;
+
+    template <typename Object>
+    void benchmarkIntersect(benchmark::State& state, const Object& object)
+    {
+        const std::vector<Ray> rays = createRays(NUM_RAYS);
+        size_t numHits = 0;
+        for (auto _ : state) {
+            for (const Ray& ray : rays) {
+                Intersection intersection;
+                numHits += object.intersect(ray, intersection);
+                benchmark::DoNotOptimize(intersection);
+            }
+        }
+        benchmark::DoNotOptimize(numHits);
+        state.SetItemsProcessed(state.iterations() * rays.size());
+    }
+}
+
+static void BM_SphereIntersect(benchmark::State& state)
+{
+    benchmarkIntersect(state, Sphere(Vec3(0.0f, 0.0f, 0.0f), 1.00f, Material()));
+}
+BENCHMARK(BM_SphereIntersect);
+
+static void BM_TriangleIntersect(benchmark::State& state)
+{
+    benchmarkIntersect(state, Triangle(Vec3(-1.5f, -1.0f, 0.0f), Vec3(1.5f, -1.0f, 0.0f), Vec3(0.0f, 1.5f, 0.0f), Material()));
+}
+BENCHMARK(BM_TriangleIntersect);
+
+static void BM_CameraViewportPointToRay(benchmark::State& state)
+{
+    Camera camera{};
+    camera.setAspectRatio(16.0f / 9.0f);
+    camera.lookAtFrom(Vec3(0.0f, 0.0f, 0.0f), Vec3(0.0f, 50.0f, 150.0f));
+
+    const size_t width  = 256;
+    const size_t height = 144;
+    for (auto _ : state) {
+        for (size_t row = 0; row < height; row++) {
+            for (size_t col = 0; col < width; col++) {
+                const Vec3 viewportPosition{ (col + 0.50f) / width, (row + 0.50f) / height, 0.00f };
+                benchmark::DoNotOptimize(camera.viewportPointToRay(viewportPosition));
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * width * height);
+}
+BENCHMARK(BM_CameraViewportPointToRay);
+
+static void BM_CameraRayGeneratorRows(benchmark::State& state)
+{
+    Camera camera{};
+    camera.setAspectRatio(16.0f / 9.0f);
+    camera.lookAtFrom(Vec3(0.0f, 0.0f, 0.0f), Vec3(0.0f, 50.0f, 150.0f));
+
+    // rows split into spans as wide as the ray tracer's tiles
+    const size_t width     = 256;
+    const size_t height    = 144;
+    const size_t spanWidth = 32;
+    const CameraRayGenerator generator{ camera, width, height };
+    RayBatch batch;
+    for (auto _ : state) {
+        for (size_t row = 0; row < height; row++) {
+            for (size_t colBegin = 0; colBegin < width; colBegin += spanWidth) {
+                generator.generateRow(row, colBegin, spanWidth, batch);
+                benchmark::DoNotOptimize(batch);
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * width * height);
+}
+BENCHMARK(BM_CameraRayGeneratorRows);
@@ -0,0 +1,179 @@
+#include "Color.hpp"
+#include "Camera.hpp"
+#include "Scene.hpp"
+#include "CompiledScene.hpp"
+#include "FrameBuffer.hpp"
+#include "RayTracer.hpp"
+#include "ThreadPool.hpp"
+#include "DemoScenes.hpp"
+#include "PerfCounters.hpp"
+
+#include "benchmark/benchmark.h"
+
+#include <random>
+#include <utility>
+#include <optional>
+#include <functional>
+
+namespace {
+
+    // average of a hardware event count per iteration, reported only if the event could be counted
+    void setPerfCounter(benchmark::State& state, const char* name, const std::optional<uint64_t>& count)
+    {
+        if (count) {
+            state.counters[name] = benchmark::Counter(static_cast<double>(*count), benchmark::Counter::kAvgIterations);
+        }
+    }
+
+    // traces the compiled scene into a 16:9 frame of given height, using the same settings as the app's demo unless
+    // changed by the given configuration
+    //
+    // when built with ray statistics, rays per frame are reported too, along with l1 data misses per ray
+    void benchmarkTraceScene(benchmark::State& state, const Scene& scene, size_t height,
+                             const std::function<void(RayTracer&)>& configure = {})
+    {
+        const size_t width = height * 16 / 9;
+        FrameBuffer frameBuffer{ width, height };
+        const CompiledScene compiledScene{ scene };
+        const PerfCounters perfCounters{};  // opened before the pool, so its workers are counted too
+        ThreadPool threadPool{};
+
+        RayTracer rayTracer{};
+        rayTracer.setBias(0.02f);
+        rayTracer.setMaxNumReflections(4);
+        rayTracer.setShadowColor(Color(0.125f, 0.125f, 0.125f));
+        rayTracer.setBackgroundColor(Palette::skyBlue);
+        if (configure) {
+            configure(rayTracer);
+        }
+
+        Camera camera{};
+        camera.setNearClip(0.50f);
+        camera.setFarClip(1000.0f);
+        camera.setAspectRatio(frameBuffer.aspectRatio());
+        camera.setFieldOfView(120.0f);
+        camera.lookAtFrom(Vec3(0, 0, 0), Vec3(0, 50, 150));
+
+        RayStats stats{};
+        const PerfCounts startCounts = perfCounters.read();
+        for (auto _ : state) {
+            stats = rayTracer.traceScene(camera, compiledScene, frameBuffer, threadPool);
+        }
+        const PerfCounts counts = perfCounters.read() - startCounts;
+        benchmark::DoNotOptimize(frameBuffer.getPixel(0));
+        state.SetItemsProcessed(state.iterations() * frameBuffer.numPixels());
+        state.counters["objects"] = static_cast<double>(scene.getNumObjects());
+        state.counters["threads"] = static_cast<double>(threadPool.numThreads());
+        setPerfCounter(state, "cycles",        counts.cycles);
+        setPerfCounter(state, "instructions",  counts.instructions);
+        setPerfCounter(state, "l1d-misses",    counts.l1DataMisses);
+        setPerfCounter(state, "llc-misses",    counts.lastLevelCacheMisses);
+        setPerfCounter(state, "branch-misses", counts.branchMisses);
+        if (stats.totalRays() > 0) {
+            state.counters["rays"] = static_cast<double>(stats.totalRays());
+            if (counts.l1DataMisses) {
+                const double raysTraced = static_cast<double>(stats.totalRays()) * static_cast<double>(state.iterations());
+                state.counters["l1d-misses/ray"] = static_cast<double>(*counts.l1DataMisses) / raysTraced;
+            }
+        }
+    }
+}
+
+static void BM_TraceSimpleGroundScene(benchmark::State& state)
+{
+    benchmarkTraceScene(state, DemoScenes::createSimpleGroundScene(), static_cast<size_t>(state.range(0)));
+}
+BENCHMARK(BM_TraceSimpleGroundScene)
+    ->ArgNames({ "height" })
+    ->Arg(240)->Arg(480)->Arg(720)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+static void BM_TraceRandomGroundScene(benchmark::State& state)
+{
+    benchmarkTraceScene(state, DemoScenes::createRandomGroundScene(), static_cast<size_t>(state.range(0)));
+}
+BENCHMARK(BM_TraceRandomGroundScene)
+    ->ArgNames({ "height" })
+    ->Arg(240)->Arg(480)->Arg(720)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+static void BM_TraceRandomFloatingScene(benchmark::State& state)
+{
+    const size_t numSpheres = static_cast<size_t>(state.range(1));
+    benchmarkTraceScene(state, DemoScenes::createRandomFloatingScene(numSpheres), static_cast<size_t>(state.range(0)));
+}
+BENCHMARK(BM_TraceRandomFloatingScene)
+    ->ArgNames({ "height", "spheres" })
+    ->ArgsProduct({ { 240, 480, 720 }, { 100, 1000 } })
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// the reflective demo scene traced by each integrator, with 0 for recursive and 1 for wavefront
+static void BM_TraceRandomGroundSceneByIntegrator(benchmark::State& state)
+{
+    const Integrator integrator = state.range(1) == 0 ? Integrator::Recursive : Integrator::Wavefront;
+    benchmarkTraceScene(state, DemoScenes::createRandomGroundScene(), static_cast<size_t>(state.range(0)),
+                        [integrator](RayTracer& rayTracer) { rayTracer.setIntegrator(integrator); });
+}
+BENCHMARK(BM_TraceRandomGroundSceneByIntegrator)
+    ->ArgNames({ "height", "wavefront" })
+    ->ArgsProduct({ { 240, 480 }, { 0, 1 } })
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// reflections of the reflective demo scene traced by the wavefront integrator, with 0 to leave them in the order they
+// were spawned and 1 to sort them for coherence before each bounce
+static void BM_TraceRandomGroundSceneBySorting(benchmark::State& state)
+{
+    const size_t numSpheres = static_cast<size_t>(state.range(1));
+    const bool sortsReflections = state.range(2) != 0;
+    benchmarkTraceScene(state, DemoScenes::createRandomGroundScene(numSpheres), static_cast<size_t>(state.range(0)),
+                        [sortsReflections](RayTracer& rayTracer) {
+                            rayTracer.setIntegrator(Integrator::Wavefront);
+                            rayTracer.setSortsReflections(sortsReflections);
+                        });
+}
+BENCHMARK(BM_TraceRandomGroundSceneBySorting)
+    ->ArgNames({ "height", "spheres", "sorted" })
+    ->ArgsProduct({ { 480 }, { 100, 10000 }, { 0, 1 } })
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// the reflective demo scene traced up to 16 reflections deep, with paths cut off below a minimum throughput (given
+// in thousandths, so 0 traces every reflection) and with 1 to enable russian roulette below it
+static void BM_TraceDeepReflectionsByMinThroughput(benchmark::State& state)
+{
+    const float minThroughput = static_cast<float>(state.range(1)) / 1000.0f;
+    const bool usesRussianRoulette = state.range(2) != 0;
+    benchmarkTraceScene(state, DemoScenes::createRandomGroundScene(), static_cast<size_t>(state.range(0)),
+                        [minThroughput, usesRussianRoulette](RayTracer& rayTracer) {
+                            rayTracer.setMaxNumReflections(16);
+                            rayTracer.setMinThroughput(minThroughput);
+                            rayTracer.setUsesRussianRoulette(usesRussianRoulette);
+                        });
+}
+BENCHMARK(BM_TraceDeepReflectionsByMinThroughput)
+    ->ArgNames({ "height", "min-throughput", "roulette" })
+    ->Args({ 480, 0, 0 })->Args({ 480, 1, 0 })->Args({ 480, 10, 0 })->Args({ 480, 10, 1 })
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// the random ground scene lit by many dim point lights scattered just above the ground, each falling off quadratically
+// so only those nearby reach a given hit
+static void BM_TraceManyLightsScene(benchmark::State& state)
+{
+    Scene scene = DemoScenes::createRandomGroundScene();
+    std::mt19937 rng{ 11 };
+    std::uniform_real_distribution<float> offset{ -150.0f, 150.0f };
+    for (int64_t i = 0; i < state.range(1); i++) {
+        scene.addLight(PointLight(Vec3(offset(rng), 5.0f, 150.0f + offset(rng)), Color(0.25f, 0.25f, 0.25f), 1.0f, 0.0f, 1.0f));
+    }
+    benchmarkTraceScene(state, scene, static_cast<size_t>(state.range(0)));
+}
+BENCHMARK(BM_TraceManyLightsScene)
+    ->ArgNames({ "height", "lights" })
+    ->ArgsProduct({ { 480 }, { 100, 1000, 4000 } })
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
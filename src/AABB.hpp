@@ -0,0 +1,92 @@
+#pragma once
+#include "Math.hpp"
+#include "Ray.hpp"
+
+
+// axis aligned bounding box, where an empty box has inverted (infinite) bounds so that expanding it
+// by any point or box yields exactly that point or box
+struct AABB {
+    Vec3 min;
+    Vec3 max;
+
+    constexpr AABB() noexcept
+        : min( Math::INF,  Math::INF,  Math::INF),
+          max(-Math::INF, -Math::INF, -Math::INF) {}
+    constexpr AABB(const Vec3& min, const Vec3& max) noexcept
+        : min(min), max(max) {}
+
+    inline constexpr bool isEmpty() const {
+        return min.x > max.x || min.y > max.y || min.z > max.z;
+    }
+
+    inline constexpr Vec3 center() const {
+        return 0.50f * (min + max);
+    }
+
+    inline constexpr Vec3 extent() const {
+        return max - min;
+    }
+
+    inline constexpr float surfaceArea() const {
+        if (isEmpty()) {
+            return 0.00f;
+        }
+        const Vec3 e = extent();
+        return 2.00f * (e.x * e.y + e.y * e.z + e.z * e.x);
+    }
+
+    inline constexpr size_t longestAxis() const {
+        const Vec3 e = extent();
+        if (e.x >= e.y && e.x >= e.z) {
+            return 0;
+        }
+        return e.y >= e.z ? 1 : 2;
+    }
+
+    inline constexpr bool contains(const Vec3& point) const {
+        return point.x >= min.x && point.x <= max.x &&
+               point.y >= min.y && point.y <= max.y &&
+               point.z >= min.z && point.z <= max.z;
+    }
+
+    inline constexpr AABB& expand(const Vec3& point) {
+        min = Math::min(min, point);
+        max = Math::max(max, point);
+        return *this;
+    }
+
+    inline constexpr AABB& expand(const AABB& box) {
+        min = Math::min(min, box.min);
+        max = Math::max(max, box.max);
+        return *this;
+    }
+
+    // slab test against a ray with precomputed reciprocal direction, accepting only overlaps with the interval [0, tMax]
+    inline bool intersect(const Ray& ray, const Vec3& invDirection, float tMax, float& tEntry) const {
+        const float tx0 = (min.x - ray.origin.x) * invDirection.x;
+        const float tx1 = (max.x - ray.origin.x) * invDirection.x;
+        const float ty0 = (min.y - ray.origin.y) * invDirection.y;
+        const float ty1 = (max.y - ray.origin.y) * invDirection.y;
+        const float tz0 = (min.z - ray.origin.z) * invDirection.z;
+        const float tz1 = (max.z - ray.origin.z) * invDirection.z;
+
+        const float tNear = Math::max(Math::max(Math::min(tx0, tx1), Math::min(ty0, ty1)),
+                                      Math::max(Math::min(tz0, tz1), 0.00f));
+        const float tFar  = Math::min(Math::min(Math::max(tx0, tx1), Math::max(ty0, ty1)),
+                                      Math::min(Math::max(tz0, tz1), tMax));
+        tEntry = tNear;
+        return tNear <= tFar;
+    }
+};
+
+inline constexpr AABB merge(const AABB& a, const AABB& b) {
+    return AABB(Math::min(a.min, b.min), Math::max(a.max, b.max));
+}
+
+inline std::ostream& operator<<(std::ostream& os, const AABB& box) {
+    os << "AABB("
+         << "min:(" << box.min << "),"
+         << "max:(" << box.max << ")"
+       << ")";
+    return os;
+}
@@ -2,20 +2,41 @@
 #include "App.hpp"
 #include "Text.hpp"
 #include "Files.hpp"
+#include "SceneCache.hpp"
+#include "PerfCounters.hpp"
 #include <string>
 #include <iostream>
+#include <filesystem>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
 
 
 std::ostream& operator<<(std::ostream& os, const AppOptions& appOptions) {
     os << "AppOptions("
          << "Output{"
-           << "logInfo:" << appOptions.logInfo          << ","
-           << "gamma:"   << appOptions.imageOutputGamma << ","
-           << "file:\'"  << appOptions.imageOutputFile  << "\',"
-           << "size:("   << appOptions.imageOutputSize  << ")}, "
+           << "logInfo:"         << appOptions.logInfo          << ","
+           << "gamma:"           << appOptions.imageOutputGamma << ","
+           << "file:\'"          << appOptions.imageOutputFile  << "\',"
+           << "scene-cache:\'"   << appOptions.sceneCacheFile   << "\',"
+           << "cost-heatmap:\'"  << appOptions.costHeatmapFile  << "\',"
+           << "profile-trace:\'" << appOptions.profileTraceFile << "\',"
+           << "perf-counters:"   << appOptions.perfCounters     << ","
+           << "size:("           << appOptions.imageOutputSize  << ")}, "
+         << "Scene{"
+           << "name:\'"        << appOptions.sceneName       << "\',"
+           << "sphere-count:"  << appOptions.sceneNumSpheres << ","
+           << "seed:"          << appOptions.sceneSeed       << "}, "
+         << "Benchmark{"
+           << "frame-count:" << appOptions.benchmarkFrameCount << "}, "
          << "RayTracing{"
            << "bias:"             << appOptions.rayTracingBias            << ","
            << "reflection-limit:" << appOptions.rayTracingReflectionLimit << ","
+           << "thread-count:"     << appOptions.rayTracingThreadCount     << ","
+           << "integrator:"       << RayTracer::integratorName(appOptions.rayTracingIntegrator) << ","
+           << "min-throughput:"   << appOptions.rayTracingMinThroughput   << ","
+           << "russian-roulette:" << appOptions.rayTracingRussianRoulette << ","
            << "sky-color:("       << appOptions.skyBoxColor               << "),"
            << "shadow-color:("    << appOptions.shadowColor               << ")}, "
          << "SceneViewing{"
@@ -29,12 +50,23 @@ std::ostream& operator<<(std::ostream& os, const AppOptions& appOptions) {
 }
 
 App::App(Scene&& scene, const AppOptions& options)
-    : options_    (options),
-      stopWatch_  (),
-      scene_      (std::move(scene)),
-      camera_     (),
-      rayTracer_  (),
-      frameBuffer_(options.imageOutputSize) {
+    : options_      (options),
+      stopWatch_    (),
+      perfCounters_ (options.perfCounters ? std::make_unique<PerfCounters>() : nullptr),
+      scene_        (std::move(scene)),
+      compiledScene_(),
+      camera_       (),
+      rayTracer_    (),
+      threadPool_   (options.rayTracingThreadCount),
+      frameBuffer_  (options.imageOutputSize) {
+
+    if (!options_.profileTraceFile.empty()) {
+        Profiler::setEnabled(true);
+    }
+    if (perfCounters_ && !perfCounters_->isAvailable()) {
+        std::cout << "Hardware performance counters are unavailable, so only wall time is reported" << "\n";
+        perfCounters_.reset();
+    }
 
     // preferably, we'd using a logging framework or custom logger,
     // but writing directly console will suffice for this class for now
@@ -47,6 +79,9 @@ App::App(Scene&& scene, const AppOptions& options)
     rayTracer_.setMaxNumReflections(options.rayTracingReflectionLimit);
     rayTracer_.setShadowColor(options.shadowColor);
     rayTracer_.setBackgroundColor(options.skyBoxColor);
+    rayTracer_.setIntegrator(options.rayTracingIntegrator);
+    rayTracer_.setMinThroughput(options.rayTracingMinThroughput);
+    rayTracer_.setUsesRussianRoulette(options.rayTracingRussianRoulette);
 
     camera_.setNearClip(options.cameraNearZ);
     camera_.setFarClip(options.cameraFarZ);
@@ -62,33 +97,191 @@ App::App(Scene&& scene, const AppOptions& options)
 
 
 void App::run() {
+    if (options_.benchmarkFrameCount > 0) {
+        benchmark();
+        return;
+    }
+
     if (options_.logInfo) {
         std::cout << "\n" << Text::padSides(" Tracing `" + Files::fileName(options_.imageOutputFile) + "` ", '*', 80) << "\n";
 
+        if (!compiledScene_) {
+            compileScene();
+        }
+
         std::cout << "Tracing started..." << std::flush;
-        stopWatch_.start();
-        rayTracer_.traceScene(camera_, scene_, frameBuffer_);
-        stopWatch_.stop();
-        std::cout << "finished in " << stopWatch_.elapsedTime() << " seconds" << "\n";
+        startTiming();
+        const RayStats rayStats = traceScene();
+        finishTiming();
+        if constexpr (RayStats::IS_ENABLED) {
+            std::cout << rayStats << "\n";
+        }
         
         std::cout << "Writing file started..." << std::flush;
-        stopWatch_.start();
-        Files::writePpmWithGammaCorrection(options_.imageOutputFile, frameBuffer_, options_.imageOutputGamma);
-        stopWatch_.stop();
-        std::cout << "finished in " << stopWatch_.elapsedTime() << " seconds" << "\n";
+        startTiming();
+        writeImage();
+        finishTiming();
 
         std::cout << "output saved to filepath at " << Files::resolveAbsolutePath(options_.imageOutputFile) << "\n";
+        if (!options_.profileTraceFile.empty()) {
+            Profiler::writeChromeTrace(options_.profileTraceFile);
+            std::cout << "profile saved to filepath at " << Files::resolveAbsolutePath(options_.profileTraceFile) << "\n";
+        }
     } else {
-        rayTracer_.traceScene(camera_, scene_, frameBuffer_);
-        Files::writePpmWithGammaCorrection(options_.imageOutputFile, frameBuffer_, options_.imageOutputGamma);
+        if (!compiledScene_) {
+            compileScene();
+        }
+        traceScene();
+        writeImage();
+        if (!options_.profileTraceFile.empty()) {
+            Profiler::writeChromeTrace(options_.profileTraceFile);
+        }
     }
 }
 
+// trace the same frame repeatedly without writing any images, reporting the spread of frame times (with p95 as the
+// nearest rank, so for fewer than 20 frames it's simply the slowest)
+void App::benchmark() {
+    if (options_.logInfo) {
+        std::cout << "\n" << Text::padSides(" Benchmarking `" + options_.sceneName + "` ", '*', 80) << "\n";
+    }
+    if (!compiledScene_) {
+        compileScene();
+    }
+
+    const size_t numFrames = options_.benchmarkFrameCount;
+    std::vector<double> frameTimes(numFrames);
+    for (size_t frame = 0; frame < numFrames; frame++) {
+        if (options_.logInfo) {
+            std::cout << "Tracing frame " << (frame + 1) << " of " << numFrames << " started..." << std::flush;
+        }
+        startTiming();
+        rayTracer_.traceScene(camera_, *compiledScene_, frameBuffer_, threadPool_);
+        if (options_.logInfo) {
+            finishTiming();
+        } else {
+            stopWatch_.stop();
+        }
+        frameTimes[frame] = stopWatch_.elapsedTime();
+    }
+
+    std::sort(frameTimes.begin(), frameTimes.end());
+    const double median = (numFrames % 2 == 1) ? frameTimes[numFrames / 2] :
+                                                 (frameTimes[(numFrames / 2) - 1] + frameTimes[numFrames / 2]) / 2.00;
+    const size_t p95Rank = static_cast<size_t>(std::ceil(0.95 * numFrames));
+    std::cout << "FrameTimes("
+                << "frames:"         << numFrames                << ","
+                << "min-seconds:"    << frameTimes.front()       << ","
+                << "median-seconds:" << median                   << ","
+                << "p95-seconds:"    << frameTimes[p95Rank - 1]  << ","
+                << "mega-pixels:"    << frameBuffer_.megaPixels()
+              << ")" << "\n";
+
+    if (!options_.profileTraceFile.empty()) {
+        Profiler::writeChromeTrace(options_.profileTraceFile);
+    }
+}
+
+// time the next phase, as well as count its hardware events if enabled
+void App::startTiming() {
+    stopWatch_.start();
+    if (perfCounters_) {
+        phaseStartCounts_ = perfCounters_->read();
+    }
+}
+
+void App::finishTiming() {
+    stopWatch_.stop();
+    std::cout << "finished in " << stopWatch_.elapsedTime() << " seconds" << "\n";
+    if (perfCounters_) {
+        std::cout << (perfCounters_->read() - phaseStartCounts_) << "\n";
+    }
+}
 
+// trace into the frame buffer, additionally recording and writing out per pixel costs if a heatmap file is given
+RayStats App::traceScene() {
+    ProfileZone zone{ "trace-scene" };
+    if (options_.costHeatmapFile.empty()) {
+        return rayTracer_.traceScene(camera_, *compiledScene_, frameBuffer_, threadPool_);
+    }
+    CostMap costMap{ frameBuffer_.width(), frameBuffer_.height() };
+    const RayStats rayStats = rayTracer_.traceScene(camera_, *compiledScene_, frameBuffer_, threadPool_, costMap);
+    writeCostHeatmaps(costMap);
+    return rayStats;
+}
+
+void App::writeImage() {
+    ProfileZone zone{ "write-image" };
+    Files::writePpmWithGammaCorrection(options_.imageOutputFile, frameBuffer_, options_.imageOutputGamma);
+}
+
+// write a heatmap per metric, e.g. `cost.ppm` as `cost-intersection-tests.ppm`, `cost-shadow-rays.ppm` and so on
+void App::writeCostHeatmaps(const CostMap& costMap) const {
+    ProfileZone zone{ "write-cost-heatmaps" };
+    const std::filesystem::path basePath{ options_.costHeatmapFile };
+    for (CostMetric metric : { CostMetric::IntersectionTests, CostMetric::ShadowRays, CostMetric::TraceTime }) {
+        std::filesystem::path filepath = basePath;
+        filepath.replace_filename(basePath.stem().string() + "-" + CostMap::metricName(metric) + basePath.extension().string());
+        Files::writeHeatmapPpm(filepath.string(), costMap, metric);
+    }
+}
+
+// compile the scene for tracing, unless a cache of this exact scene was written by an earlier run
+// the scene itself is still built and fingerprinted up front, so a cache only skips building the hierarchies and
+// arrays traced over; a cache that fails to read is treated like a stale one, and rebuilt
+void App::compileScene() {
+    const bool useCache = !options_.sceneCacheFile.empty();
+    const uint64_t fingerprint = useCache ? SceneCache::fingerprint(scene_) : 0;
+    if (useCache && SceneCache::isUpToDate(options_.sceneCacheFile, fingerprint)) {
+        if (options_.logInfo) {
+            std::cout << "Loading scene cache started..." << std::flush;
+            startTiming();
+        }
+        try {
+            ProfileZone zone{ "read-scene-cache" };
+            compiledScene_ = std::make_unique<CompiledScene>(SceneCache::read(options_.sceneCacheFile));
+        } catch (const std::runtime_error& error) {
+            if (options_.logInfo) {
+                std::cout << "failed (" << error.what() << ")\n";
+            }
+        }
+        if (compiledScene_) {
+            if (options_.logInfo) {
+                finishTiming();
+            }
+            return;
+        }
+    }
+
+    if (options_.logInfo) {
+        std::cout << "Compiling scene started..." << std::flush;
+        startTiming();
+    }
+    compiledScene_ = std::make_unique<CompiledScene>(scene_);
+    if (useCache) {
+        ProfileZone zone{ "write-scene-cache" };
+        SceneCache::write(options_.sceneCacheFile, *compiledScene_, fingerprint);
+    }
+    if (options_.logInfo) {
+        finishTiming();
+    }
+}
+
+
+// scenes are only listed object by object while small, as generated scenes can hold millions of objects
 inline std::ostream& operator<<(std::ostream& os, const App& app) {
+    constexpr size_t maxListedObjects = 100;
     os << app.frameBuffer_ << "\n\n"
        << app.rayTracer_   << "\n\n"
-       << app.scene_       << "\n\n"
-       << app.camera_      << "\n";
+       << app.threadPool_  << "\n\n";
+    if (app.scene_.getNumObjects() <= maxListedObjects) {
+        os << app.scene_ << "\n\n";
+    } else {
+        os << "Scene("
+             << "light-count:"  << app.scene_.getNumLights()  << ","
+             << "object-count:" << app.scene_.getNumObjects()
+           << ")" << "\n\n";
+    }
+    os << app.camera_ << "\n";
     return os;
 }
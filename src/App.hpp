@@ -3,10 +3,17 @@
 #include "Color.hpp"
 #include "Camera.hpp"
 #include "Scene.hpp"
+#include "CompiledScene.hpp"
 #include "StopWatch.hpp"
 #include "FrameBuffer.hpp"
+#include "CostMap.hpp"
+#include "Profiler.hpp"
+#include "PerfCounters.hpp"
 #include "RayTracer.hpp"
+#include "ThreadPool.hpp"
+#include "DemoScenes.hpp"
 #include <iostream>
+#include <memory>
 
 
 struct AppOptions {
@@ -15,10 +22,26 @@ struct AppOptions {
     std::string imageOutputFile{ "./scene.ppm" };
     Vec2        imageOutputSize{ CommonResolutions::HD_1080p };
     float       imageOutputGamma{ 2.20f };
+    std::string sceneCacheFile{ "" };    // when set, compiled scenes are cached here and reused while unchanged
+    std::string costHeatmapFile{ "" };   // when set, per pixel cost heatmaps are written here, suffixed by metric
+    std::string profileTraceFile{ "" };  // when set, profiled zones are written here as chrome trace json
+    bool        perfCounters{ false };   // when set, hardware event counts are logged alongside each phase's time
+
+    // default scene settings, for picking which demo scene to trace
+    std::string sceneName{ "random-ground" };
+    size_t      sceneNumSpheres{ DemoScenes::DEFAULT_NUM_SPHERES };
+    uint64_t    sceneSeed{ DemoScenes::DEFAULT_SEED };
+
+    // default benchmark settings
+    size_t benchmarkFrameCount{ 0 };  // when nonzero, frames are traced this many times and timed, with no output
 
     // default tracing settings
     float  rayTracingBias{ 0.02f };
     size_t rayTracingReflectionLimit{ 3 };
+    size_t rayTracingThreadCount{ 0 };  // zero for one thread per hardware thread
+    Integrator rayTracingIntegrator{ Integrator::Recursive };
+    float  rayTracingMinThroughput{ 1e-03f };   // reflections weighing less in their pixel than this are not traced
+    bool   rayTracingRussianRoulette{ false };  // when set, such reflections are instead traced at random, reweighted
 
     // default color settings
     Color skyBoxColor{ 0.125f, 0.125f, 0.125f };
@@ -47,12 +70,24 @@ public:
 private:
     AppOptions options_;
     StopWatch stopWatch_;
+    std::unique_ptr<PerfCounters> perfCounters_;  // opened before the thread pool, so its workers are counted too
+    PerfCounts phaseStartCounts_;
 
     Scene scene_;
+    std::unique_ptr<CompiledScene> compiledScene_;
     Camera camera_;
     RayTracer rayTracer_;
+    ThreadPool threadPool_;
     FrameBuffer frameBuffer_;
 
+    void compileScene();
+    void benchmark();
+    void startTiming();
+    void finishTiming();
+    RayStats traceScene();
+    void writeImage();
+    void writeCostHeatmaps(const CostMap& costMap) const;
+
 public:
     friend std::ostream& operator<<(std::ostream& os, const App& app);
 };
@@ -0,0 +1,198 @@
+#include "BVH.hpp"
+#include "Math.hpp"
+#include "AABB.hpp"
+#include "Profiler.hpp"
+#include <vector>
+#include <numeric>
+#include <algorithm>
+#include <assert.h>
+
+
+BVH::BVH(const std::vector<AABB>& primitiveBounds, size_t maxLeafSize)
+    : maxLeafSize_(maxLeafSize) {
+    ProfileZone zone{ "build-bvh" };
+    assert(maxLeafSize > 0);
+    if (primitiveBounds.empty()) {
+        return;
+    }
+
+    std::vector<Vec3> centroids;
+    centroids.reserve(primitiveBounds.size());
+    for (const AABB& box : primitiveBounds) {
+        centroids.push_back(box.center());
+    }
+
+    primitiveIndices_.resize(primitiveBounds.size());
+    std::iota(primitiveIndices_.begin(), primitiveIndices_.end(), 0);
+    nodes_.reserve(2 * primitiveBounds.size() - 1);
+    buildRecursive(primitiveBounds, centroids, 0, primitiveBounds.size(), 1);
+    nodes_.shrink_to_fit();
+}
+
+
+bool BVH::isEmpty() const {
+    return nodes_.empty();
+}
+
+size_t BVH::numNodes() const {
+    return nodes_.size();
+}
+
+size_t BVH::numPrimitives() const {
+    return primitiveIndices_.size();
+}
+
+size_t BVH::depth() const {
+    return depth_;
+}
+
+AABB BVH::bounds() const {
+    return nodes_.empty() ? AABB() : nodes_[0].bounds;
+}
+
+const BVH::Node& BVH::getNode(size_t index) const {
+    assert(index >= 0 && index < nodes_.size());
+    return nodes_[index];
+}
+
+size_t BVH::getPrimitiveIndex(size_t leafSlot) const {
+    assert(leafSlot >= 0 && leafSlot < primitiveIndices_.size());
+    return primitiveIndices_[leafSlot];
+}
+
+
+// partition primitives [begin, end) by binning their centroids along each axis and choosing the split plane that
+// minimizes the surface area heuristic, which estimates cost as proportional to the probability of a random ray
+// hitting each child (surface area relative to parent) times the number of primitives it contains
+//
+// cost(split) = C_trav + (A_left * N_left + A_right * N_right) / A_parent * C_isect
+//
+// falls back to an object median split when SAH can't separate the centroids or when the tree grows too deep,
+// so that depth stays within the fixed size of the traversal stack
+uint32_t BVH::buildRecursive(const std::vector<AABB>& primitiveBounds, const std::vector<Vec3>& centroids,
+                             size_t begin, size_t end, size_t depth) {
+    assert(depth <= MAX_DEPTH);
+    depth_ = std::max(depth_, depth);
+
+    const uint32_t nodeIndex = static_cast<uint32_t>(nodes_.size());
+    nodes_.push_back(Node{});
+
+    AABB bounds{};
+    AABB centroidBounds{};
+    for (size_t i = begin; i < end; i++) {
+        bounds.expand(primitiveBounds[primitiveIndices_[i]]);
+        centroidBounds.expand(centroids[primitiveIndices_[i]]);
+    }
+    nodes_[nodeIndex].bounds = bounds;
+
+    const size_t count = end - begin;
+    if (count == 1) {
+        makeLeaf(nodeIndex, begin, end);
+        return nodeIndex;
+    }
+
+    size_t bestAxis  = 0;
+    size_t bestSplit = 0;
+    float  bestCost  = Math::INF;
+    if (depth < MAX_SAH_DEPTH) {
+        for (size_t axis = 0; axis < 3; axis++) {
+            const float axisMin = centroidBounds.min[axis];
+            const float axisMax = centroidBounds.max[axis];
+            if (axisMax <= axisMin) {
+                continue;
+            }
+
+            AABB   binBounds[NUM_BINS]{};
+            size_t binCounts[NUM_BINS]{};
+            const float binScale = NUM_BINS / (axisMax - axisMin);
+            for (size_t i = begin; i < end; i++) {
+                const size_t primitive = primitiveIndices_[i];
+                const size_t bin = std::min(NUM_BINS - 1, static_cast<size_t>((centroids[primitive][axis] - axisMin) * binScale));
+                binBounds[bin].expand(primitiveBounds[primitive]);
+                binCounts[bin]++;
+            }
+
+            // sweep from the right to accumulate areas of each candidate right partition, then sweep from the left
+            float  rightAreas[NUM_BINS]{};
+            size_t rightCounts[NUM_BINS]{};
+            AABB   rightBounds{};
+            size_t rightCount = 0;
+            for (size_t bin = NUM_BINS - 1; bin > 0; bin--) {
+                rightBounds.expand(binBounds[bin]);
+                rightCount += binCounts[bin];
+                rightAreas[bin]  = rightBounds.surfaceArea();
+                rightCounts[bin] = rightCount;
+            }
+
+            AABB   leftBounds{};
+            size_t leftCount = 0;
+            for (size_t split = 1; split < NUM_BINS; split++) {
+                leftBounds.expand(binBounds[split - 1]);
+                leftCount += binCounts[split - 1];
+                if (leftCount == 0 || rightCounts[split] == 0) {
+                    continue;
+                }
+                const float cost = leftBounds.surfaceArea() * leftCount + rightAreas[split] * rightCounts[split];
+                if (cost < bestCost) {
+                    bestCost  = cost;
+                    bestAxis  = axis;
+                    bestSplit = split;
+                }
+            }
+        }
+    }
+
+    const float parentArea = bounds.surfaceArea();
+    const float leafCost   = INTERSECTION_COST * count;
+    const float splitCost  = parentArea > 0.00f ?
+        TRAVERSAL_COST + INTERSECTION_COST * bestCost / parentArea :
+        Math::INF;
+
+    size_t middle = begin;
+    if (bestCost < Math::INF) {
+        if (count <= maxLeafSize_ && leafCost <= splitCost) {
+            makeLeaf(nodeIndex, begin, end);
+            return nodeIndex;
+        }
+        const float axisMin  = centroidBounds.min[bestAxis];
+        const float binScale = NUM_BINS / (centroidBounds.max[bestAxis] - axisMin);
+        middle = std::partition(primitiveIndices_.begin() + begin, primitiveIndices_.begin() + end,
+            [&](uint32_t primitive) {
+                const size_t bin = std::min(NUM_BINS - 1, static_cast<size_t>((centroids[primitive][bestAxis] - axisMin) * binScale));
+                return bin < bestSplit;
+            }) - primitiveIndices_.begin();
+    }
+
+    if (middle == begin || middle == end) {
+        if (count <= maxLeafSize_) {
+            makeLeaf(nodeIndex, begin, end);
+            return nodeIndex;
+        }
+        const size_t axis = centroidBounds.longestAxis();
+        middle = begin + count / 2;
+        std::nth_element(primitiveIndices_.begin() + begin, primitiveIndices_.begin() + middle, primitiveIndices_.begin() + end,
+            [&](uint32_t a, uint32_t b) { return centroids[a][axis] < centroids[b][axis]; });
+    }
+
+    buildRecursive(primitiveBounds, centroids, begin, middle, depth + 1);
+    const uint32_t rightChild = buildRecursive(primitiveBounds, centroids, middle, end, depth + 1);
+    nodes_[nodeIndex].offset = rightChild;
+    nodes_[nodeIndex].count  = 0;
+    return nodeIndex;
+}
+
+void BVH::makeLeaf(uint32_t nodeIndex, size_t begin, size_t end) {
+    nodes_[nodeIndex].offset = static_cast<uint32_t>(begin);
+    nodes_[nodeIndex].count  = static_cast<uint32_t>(end - begin);
+}
+
+
+std::ostream& operator<<(std::ostream& os, const BVH& bvh) {
+    os << "BVH("
+         << "node-count:"      << bvh.numNodes()      << ","
+         << "primitive-count:" << bvh.numPrimitives() << ","
+         << "depth:"           << bvh.depth()         << ","
+         << "bounds:"          << bvh.bounds()
+       << ")";
+    return os;
+}
@@ -0,0 +1,291 @@
+#pragma once
+#include "Math.hpp"
+#include "Ray.hpp"
+#include "AABB.hpp"
+#include "RayPacket.hpp"
+#include "Simd.hpp"
+#include <vector>
+#include <cstdint>
+#include <utility>
+
+
+/*
+Bounding volume hierarchy over an arbitrary set of primitives, each described only by its bounding box.
+
+Built top down using binned surface area heuristic (SAH) splits, and stored as a flat array of nodes in depth first
+order such that an inner node's left child immediately follows it. Each leaf spans a contiguous range of slots in
+primitive order, which callers can either map back to their own indices via `getPrimitiveIndex`, or use directly
+after reordering their primitive data to match. Traversal is given a visitor for intersecting a single leaf, so the
+same hierarchy can be used over scene objects, triangles, lights, etc.
+*/
+class BVH {
+public:
+    struct Node {
+        AABB     bounds;
+        uint32_t offset;  // index of right child if inner node, otherwise index of first primitive in leaf
+        uint32_t count;   // number of primitives if leaf, otherwise zero
+
+        constexpr bool isLeaf() const { return count > 0; }
+    };
+
+    BVH() = default;
+    explicit BVH(const std::vector<AABB>& primitiveBounds, size_t maxLeafSize = DEFAULT_MAX_LEAF_SIZE);
+
+    bool   isEmpty()       const;
+    size_t numNodes()      const;
+    size_t numPrimitives() const;
+    size_t depth()         const;
+    AABB   bounds()        const;
+
+    const Node& getNode(size_t index) const;
+    size_t getPrimitiveIndex(size_t leafSlot) const;
+
+    // visit leaves overlapping the ray within [0, tMax], nearest child first
+    // `visit(firstSlot, count, tMax)` returns true on a hit, and is expected to shrink tMax to the distance of that hit
+    template <typename Visitor>
+    bool traverseClosest(const Ray& ray, float tMax, Visitor&& visit) const;
+
+    // visit leaves overlapping the ray within [0, tMax] in any order, stopping at first hit
+    // `visit(firstSlot, count, tMax)` returns true if any primitive in the leaf blocks the ray before tMax
+    template <typename Visitor>
+    bool traverseAny(const Ray& ray, float tMax, Visitor&& visit) const;
+
+    // packet counterpart of `traverseClosest`, with children ordered by the nearest entry of any lane and each lane
+    // bounded by its own tMax, where `visit(firstSlot, count, lanes)` is given the lanes overlapping the leaf
+    // and is expected to shrink the tMax of each lane it hits
+    template <typename Visitor>
+    void traverseClosest(const RayPacket& packet, float* tMax, Visitor&& visit) const;
+
+    // packet counterpart of `traverseAny` over the given lanes, returning those blocked before their own tMax, where
+    // `visit(firstSlot, count, lanes)` returns which of the given lanes are blocked within the leaf
+    template <typename Visitor>
+    uint32_t traverseAny(const RayPacket& packet, uint32_t lanes, const float* tMax, Visitor&& visit) const;
+
+    // visit leaves whose bounds contain the point in any order, as `visit(firstSlot, count)`
+    template <typename Visitor>
+    void traverseContaining(const Vec3& point, Visitor&& visit) const;
+
+    static constexpr size_t MAX_DEPTH             = 64;
+    static constexpr size_t DEFAULT_MAX_LEAF_SIZE = 4;
+
+private:
+    friend class SceneCache;
+
+    std::vector<Node>     nodes_;
+    std::vector<uint32_t> primitiveIndices_;
+    size_t                depth_{ 0 };
+    size_t                maxLeafSize_{ DEFAULT_MAX_LEAF_SIZE };
+
+    static constexpr size_t NUM_BINS            = 16;
+    static constexpr size_t MAX_SAH_DEPTH       = 24;
+    static constexpr float  TRAVERSAL_COST      = 1.00f;
+    static constexpr float  INTERSECTION_COST   = 1.00f;
+
+    uint32_t buildRecursive(const std::vector<AABB>& primitiveBounds, const std::vector<Vec3>& centroids,
+                            size_t begin, size_t end, size_t depth);
+    void makeLeaf(uint32_t nodeIndex, size_t begin, size_t end);
+
+    static Vec3 reciprocal(const Vec3& direction) {
+        return Vec3(1.00f / direction.x, 1.00f / direction.y, 1.00f / direction.z);
+    }
+};
+std::ostream& operator<<(std::ostream& os, const BVH& bvh);
+
+
+
+template <typename Visitor>
+bool BVH::traverseClosest(const Ray& ray, float tMax, Visitor&& visit) const {
+    if (nodes_.empty()) {
+        return false;
+    }
+
+    const Vec3 invDirection = reciprocal(ray.direction);
+    float tEntry = 0.00f;
+    if (!nodes_[0].bounds.intersect(ray, invDirection, tMax, tEntry)) {
+        return false;
+    }
+
+    // far children are deferred along with their entry distance, so they can be skipped once a closer hit is found
+    struct Deferred { uint32_t node; float tEntry; };
+    Deferred stack[MAX_DEPTH];
+    size_t stackSize = 0;
+
+    bool hit = false;
+    uint32_t current = 0;
+    while (true) {
+        const Node& node = nodes_[current];
+        if (node.isLeaf()) {
+            if (visit(static_cast<size_t>(node.offset), static_cast<size_t>(node.count), tMax)) {
+                hit = true;
+            }
+        } else {
+            uint32_t first  = current + 1;
+            uint32_t second = node.offset;
+            float tFirst  = 0.00f;
+            float tSecond = 0.00f;
+            const bool hitFirst  = nodes_[first ].bounds.intersect(ray, invDirection, tMax, tFirst);
+            const bool hitSecond = nodes_[second].bounds.intersect(ray, invDirection, tMax, tSecond);
+            if (hitFirst && hitSecond) {
+                if (tSecond < tFirst) {
+                    std::swap(first, second);
+                    std::swap(tFirst, tSecond);
+                }
+                assert(stackSize < MAX_DEPTH);
+                stack[stackSize++] = { second, tSecond };
+                current = first;
+                continue;
+            }
+            if (hitFirst || hitSecond) {
+                current = hitFirst ? first : second;
+                continue;
+            }
+        }
+
+        do {
+            if (stackSize == 0) {
+                return hit;
+            }
+            stackSize--;
+        } while (stack[stackSize].tEntry > tMax);
+        current = stack[stackSize].node;
+    }
+}
+
+template <typename Visitor>
+bool BVH::traverseAny(const Ray& ray, float tMax, Visitor&& visit) const {
+    if (nodes_.empty()) {
+        return false;
+    }
+
+    const Vec3 invDirection = reciprocal(ray.direction);
+    uint32_t stack[MAX_DEPTH];
+    size_t stackSize = 0;
+    stack[stackSize++] = 0;
+    while (stackSize > 0) {
+        const Node& node = nodes_[stack[--stackSize]];
+        float tEntry = 0.00f;
+        if (!node.bounds.intersect(ray, invDirection, tMax, tEntry)) {
+            continue;
+        }
+        if (node.isLeaf()) {
+            if (visit(static_cast<size_t>(node.offset), static_cast<size_t>(node.count), tMax)) {
+                return true;
+            }
+        } else {
+            assert(stackSize + 2 <= MAX_DEPTH);
+            stack[stackSize++] = node.offset;
+            stack[stackSize++] = static_cast<uint32_t>(&node - nodes_.data()) + 1;
+        }
+    }
+    return false;
+}
+
+// deferred children are retested once popped, as lanes that have since found a closer hit may no longer reach them
+template <typename Visitor>
+void BVH::traverseClosest(const RayPacket& packet, float* tMax, Visitor&& visit) const {
+    if (nodes_.empty()) {
+        return;
+    }
+
+    float tEntry = 0.00f;
+    uint32_t lanes = packet.intersect(nodes_[0].bounds, tMax, packet.lanes, tEntry);
+    if (lanes == 0) {
+        return;
+    }
+
+    uint32_t stack[MAX_DEPTH];
+    size_t stackSize = 0;
+    uint32_t current = 0;
+    while (true) {
+        const Node& node = nodes_[current];
+        if (node.isLeaf()) {
+            visit(static_cast<size_t>(node.offset), static_cast<size_t>(node.count), lanes);
+        } else {
+            uint32_t first  = current + 1;
+            uint32_t second = node.offset;
+            float tFirst  = 0.00f;
+            float tSecond = 0.00f;
+            uint32_t firstLanes  = packet.intersect(nodes_[first ].bounds, tMax, lanes, tFirst);
+            uint32_t secondLanes = packet.intersect(nodes_[second].bounds, tMax, lanes, tSecond);
+            if (firstLanes != 0 && secondLanes != 0) {
+                if (tSecond < tFirst) {
+                    std::swap(first, second);
+                    std::swap(firstLanes, secondLanes);
+                }
+                assert(stackSize < MAX_DEPTH);
+                stack[stackSize++] = second;
+                current = first;
+                lanes   = firstLanes;
+                continue;
+            }
+            if (firstLanes != 0 || secondLanes != 0) {
+                current = firstLanes != 0 ? first : second;
+                lanes   = firstLanes != 0 ? firstLanes : secondLanes;
+                continue;
+            }
+        }
+
+        do {
+            if (stackSize == 0) {
+                return;
+            }
+            current = stack[--stackSize];
+            lanes   = packet.intersect(nodes_[current].bounds, tMax, packet.lanes, tEntry);
+        } while (lanes == 0);
+    }
+}
+
+template <typename Visitor>
+uint32_t BVH::traverseAny(const RayPacket& packet, uint32_t lanes, const float* tMax, Visitor&& visit) const {
+    if (nodes_.empty() || lanes == 0) {
+        return 0;
+    }
+
+    uint32_t blocked = 0;
+    uint32_t stack[MAX_DEPTH];
+    size_t stackSize = 0;
+    stack[stackSize++] = 0;
+    while (stackSize > 0) {
+        const Node& node = nodes_[stack[--stackSize]];
+        float tEntry = 0.00f;
+        const uint32_t overlapping = packet.intersect(node.bounds, tMax, lanes & ~blocked, tEntry);
+        if (overlapping == 0) {
+            continue;
+        }
+        if (node.isLeaf()) {
+            blocked |= visit(static_cast<size_t>(node.offset), static_cast<size_t>(node.count), overlapping);
+            if (blocked == lanes) {
+                return blocked;
+            }
+        } else {
+            assert(stackSize + 2 <= MAX_DEPTH);
+            stack[stackSize++] = node.offset;
+            stack[stackSize++] = static_cast<uint32_t>(&node - nodes_.data()) + 1;
+        }
+    }
+    return blocked;
+}
+
+template <typename Visitor>
+void BVH::traverseContaining(const Vec3& point, Visitor&& visit) const {
+    if (nodes_.empty()) {
+        return;
+    }
+
+    uint32_t stack[MAX_DEPTH];
+    size_t stackSize = 0;
+    stack[stackSize++] = 0;
+    while (stackSize > 0) {
+        const Node& node = nodes_[stack[--stackSize]];
+        if (!node.bounds.contains(point)) {
+            continue;
+        }
+        if (node.isLeaf()) {
+            visit(static_cast<size_t>(node.offset), static_cast<size_t>(node.count));
+        } else {
+            assert(stackSize + 2 <= MAX_DEPTH);
+            stack[stackSize++] = node.offset;
+            stack[stackSize++] = static_cast<uint32_t>(&node - nodes_.data()) + 1;
+        }
+    }
+}
@@ -0,0 +1,78 @@
+#include "CameraRayGenerator.hpp"
+#include "Math.hpp"
+#include "Ray.hpp"
+#include "Simd.hpp"
+#include "Camera.hpp"
+#include <stdexcept>
+#include <assert.h>
+
+
+namespace {
+
+    alignas(64) constexpr float LANE_INDICES[] = { 0.00f, 1.00f, 2.00f, 3.00f, 4.00f, 5.00f, 6.00f, 7.00f };
+    static_assert(sizeof(LANE_INDICES) / sizeof(LANE_INDICES[0]) >= Simd::WIDTH);
+
+    // writes whole packs, so up to a pack's width minus one lanes past the end of the row (covered by the padding)
+    template <typename FloatT>
+    void generateDirections(const Vec3& rowStart, const Vec3& stepRight, size_t count, RayBatch& batch) {
+        const FloatT laneIndices = FloatT::load(LANE_INDICES);
+        const FloatT startX = FloatT::broadcast(rowStart.x);
+        const FloatT startY = FloatT::broadcast(rowStart.y);
+        const FloatT startZ = FloatT::broadcast(rowStart.z);
+        const FloatT stepX  = FloatT::broadcast(stepRight.x);
+        const FloatT stepY  = FloatT::broadcast(stepRight.y);
+        const FloatT stepZ  = FloatT::broadcast(stepRight.z);
+        for (size_t lane = 0; lane < count; lane += FloatT::width) {
+            const FloatT col = FloatT::broadcast(static_cast<float>(lane)) + laneIndices;
+            const FloatT x = startX + (col * stepX);
+            const FloatT y = startY + (col * stepY);
+            const FloatT z = startZ + (col * stepZ);
+            const FloatT length = Simd::sqrt((x * x) + (y * y) + (z * z));
+            (x / length).store(&batch.directionX[lane]);
+            (y / length).store(&batch.directionY[lane]);
+            (z / length).store(&batch.directionZ[lane]);
+        }
+    }
+}
+
+
+// image plane is the near plane, spanning the viewport size and centered along the forward direction
+CameraRayGenerator::CameraRayGenerator(const Camera& camera, size_t width, size_t height)
+    : width_ (width),
+      height_(height),
+      origin_(camera.position()) {
+    if (width == 0 || height == 0) {
+        throw std::invalid_argument("camera rays must cover dimensions greater than zero");
+    }
+    const Vec2 viewportSize = camera.viewportSize();
+    stepRight_ = (viewportSize.x / width)  * camera.rightDir();
+    stepUp_    = (viewportSize.y / height) * camera.upDir();
+    firstPixelOffset_ = (camera.nearClip() * camera.forwardDir())
+                      - ((0.50f * viewportSize.x) * camera.rightDir()) + (0.50f * stepRight_)
+                      - ((0.50f * viewportSize.y) * camera.upDir())    + (0.50f * stepUp_);
+}
+
+size_t CameraRayGenerator::width() const {
+    return width_;
+}
+
+size_t CameraRayGenerator::height() const {
+    return height_;
+}
+
+Ray CameraRayGenerator::ray(size_t row, size_t col) const {
+    const Vec3 offset = firstPixelOffset_ + (static_cast<float>(row) * stepUp_) + (static_cast<float>(col) * stepRight_);
+    return Ray(origin_, Math::normalize(offset));
+}
+
+void CameraRayGenerator::generateRow(size_t row, size_t colBegin, size_t count, RayBatch& batch) const {
+    assert(count <= RayBatch::CAPACITY && colBegin + count <= width_ && row < height_);
+    const Vec3 rowStart = firstPixelOffset_ + (static_cast<float>(row) * stepUp_) + (static_cast<float>(colBegin) * stepRight_);
+    generateDirections<Simd::FloatN>(rowStart, stepRight_, count, batch);
+    for (size_t i = 0; i < count; i++) {
+        batch.originX[i] = origin_.x;
+        batch.originY[i] = origin_.y;
+        batch.originZ[i] = origin_.z;
+    }
+    batch.count = count;
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include "Math.hpp"
+#include "Ray.hpp"
+#include "Simd.hpp"
+#include "Camera.hpp"
+#include <cstddef>
+
+
+// rays through a run of consecutive pixels in a row, with origins and directions stored as separate component arrays
+// (each padded so packs can always be loaded and stored whole)
+struct RayBatch {
+    static constexpr size_t CAPACITY = 64;
+
+    alignas(64) float originX   [CAPACITY + Simd::PADDING];
+    alignas(64) float originY   [CAPACITY + Simd::PADDING];
+    alignas(64) float originZ   [CAPACITY + Simd::PADDING];
+    alignas(64) float directionX[CAPACITY + Simd::PADDING];
+    alignas(64) float directionY[CAPACITY + Simd::PADDING];
+    alignas(64) float directionZ[CAPACITY + Simd::PADDING];
+    size_t count{ 0 };
+
+    Ray ray(size_t index) const {
+        return Ray(Vec3(originX[index], originY[index], originZ[index]),
+                   Vec3(directionX[index], directionY[index], directionZ[index]));
+    }
+};
+
+
+/*
+Primary rays of a frame through the center of each pixel, equivalent to `Camera::viewportPointToRay`.
+
+The direction to the first pixel's center, and the steps between neighboring pixel centers along the image plane's
+right and up directions, are computed once per frame. After that, the direction to any pixel center costs just a
+multiply-add per step and a normalization, evaluated a whole pack of pixels at a time when filling a batch.
+*/
+class CameraRayGenerator {
+public:
+    CameraRayGenerator(const Camera& camera, size_t width, size_t height);
+
+    size_t width()  const;
+    size_t height() const;
+
+    // ray through center of given pixel, counting rows upwards from the bottom of the image (as viewports do)
+    Ray ray(size_t row, size_t col) const;
+
+    // rays through centers of given number (at most a batch's capacity) of consecutive pixels in a row
+    void generateRow(size_t row, size_t colBegin, size_t count, RayBatch& batch) const;
+
+private:
+    size_t width_;
+    size_t height_;
+    Vec3 origin_;
+    Vec3 firstPixelOffset_;  // from origin to center of bottom left pixel
+    Vec3 stepRight_;         // between centers of horizontally adjacent pixels
+    Vec3 stepUp_;            // between centers of vertically adjacent pixels
+};
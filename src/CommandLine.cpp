@@ -0,0 +1,227 @@
+#include "CommandLine.hpp"
+#include "App.hpp"
+#include "Math.hpp"
+#include "Color.hpp"
+#include "FrameBuffer.hpp"
+#include "DemoScenes.hpp"
+#include "RayTracer.hpp"
+#include <string>
+#include <vector>
+#include <sstream>
+#include <charconv>
+#include <stdexcept>
+#include <algorithm>
+#include <cstdint>
+
+
+namespace {
+
+    struct NamedResolution {
+        const char* name;
+        Vec2        size;
+    };
+
+    constexpr NamedResolution NAMED_RESOLUTIONS[] = {
+        { "240p",  CommonResolutions::SD_240p  },
+        { "360p",  CommonResolutions::SD_360p  },
+        { "480p",  CommonResolutions::SD_480p  },
+        { "720p",  CommonResolutions::HD_720p  },
+        { "1080p", CommonResolutions::HD_1080p },
+        { "2k",    CommonResolutions::HD_2K    },
+        { "4k",    CommonResolutions::HD_4K    },
+        { "5k",    CommonResolutions::HD_5K    },
+        { "8k",    CommonResolutions::HD_8K    },
+        { "10k",   CommonResolutions::HD_10K   },
+        { "12k",   CommonResolutions::HD_12K   },
+    };
+
+    std::invalid_argument invalidValue(const std::string& flag, const std::string& value, const std::string& expected) {
+        return std::invalid_argument("invalid value \'" + value + "\' for " + flag + " - expected " + expected);
+    }
+
+    uint64_t parseUnsigned(const std::string& flag, const std::string& value) {
+        uint64_t result = 0;
+        const char* end = value.data() + value.size();
+        const auto [parsedEnd, error] = std::from_chars(value.data(), end, result);
+        if (value.empty() || error != std::errc() || parsedEnd != end) {
+            throw invalidValue(flag, value, "a non-negative integer");
+        }
+        return result;
+    }
+
+    float parsePositiveFloat(const std::string& flag, const std::string& value) {
+        float result = 0.00f;
+        const char* end = value.data() + value.size();
+        const auto [parsedEnd, error] = std::from_chars(value.data(), end, result);
+        if (value.empty() || error != std::errc() || parsedEnd != end || !(result > 0.00f)) {
+            throw invalidValue(flag, value, "a positive number");
+        }
+        return result;
+    }
+
+    float parseUnitFloat(const std::string& flag, const std::string& value) {
+        float result = 0.00f;
+        const char* end = value.data() + value.size();
+        const auto [parsedEnd, error] = std::from_chars(value.data(), end, result);
+        if (value.empty() || error != std::errc() || parsedEnd != end || !(result >= 0.00f && result <= 1.00f)) {
+            throw invalidValue(flag, value, "a number from 0 to 1");
+        }
+        return result;
+    }
+
+    // either a named resolution (e.g. `1080p` or `4k`), or `<width>x<height>` in pixels
+    Vec2 parseResolution(const std::string& flag, const std::string& value) {
+        for (const NamedResolution& resolution : NAMED_RESOLUTIONS) {
+            if (value == resolution.name) {
+                return resolution.size;
+            }
+        }
+        const size_t separator = value.find('x');
+        if (separator == std::string::npos) {
+            throw invalidValue(flag, value, "a named resolution or <width>x<height>");
+        }
+        const uint64_t width  = parseUnsigned(flag, value.substr(0, separator));
+        const uint64_t height = parseUnsigned(flag, value.substr(separator + 1));
+        if (width == 0 || height == 0) {
+            throw invalidValue(flag, value, "a resolution greater than zero");
+        }
+        return Vec2(static_cast<float>(width), static_cast<float>(height));
+    }
+
+    std::string parseSceneName(const std::string& flag, const std::string& value) {
+        for (const char* name : DemoScenes::SCENE_NAMES) {
+            if (value == name) {
+                return value;
+            }
+        }
+        throw invalidValue(flag, value, "one of the demo scenes listed by --help");
+    }
+
+    Integrator parseIntegrator(const std::string& flag, const std::string& value) {
+        for (Integrator integrator : { Integrator::Recursive, Integrator::Wavefront }) {
+            if (value == RayTracer::integratorName(integrator)) {
+                return integrator;
+            }
+        }
+        throw invalidValue(flag, value, "recursive or wavefront");
+    }
+}
+
+
+// the settings the app was tuned for, with the demo scene viewed from above at 8k
+AppOptions CommandLine::defaultOptions() {
+    AppOptions options;
+    options.imageOutputFile           = "./scene.ppm";
+    options.imageOutputSize           = CommonResolutions::HD_8K;
+    options.rayTracingReflectionLimit = 4;
+    options.skyBoxColor               = Palette::skyBlue;
+    options.shadowColor               = Color(0.125f, 0.125f, 0.125f);
+    options.viewTarget                = Vec3(0, 0, 0);
+    options.viewOffset                = Vec3(0, 50, 150);
+    return options;
+}
+
+// flags taking a value accept it either as the next argument or joined by an equals sign (e.g. `--threads=8`)
+AppOptions CommandLine::parse(const std::vector<std::string>& args) {
+    AppOptions options = defaultOptions();
+    for (size_t i = 0; i < args.size(); i++) {
+        std::string flag = args[i];
+        std::string value;
+        bool hasJoinedValue = false;
+        if (const size_t equals = flag.find('='); flag.rfind("--", 0) == 0 && equals != std::string::npos) {
+            value          = flag.substr(equals + 1);
+            flag           = flag.substr(0, equals);
+            hasJoinedValue = true;
+        }
+        if (hasJoinedValue && (flag == "--perf-counters" || flag == "--quiet" || flag == "--russian-roulette")) {
+            throw std::invalid_argument(flag + " does not take a value");
+        }
+        auto nextValue = [&]() -> const std::string& {
+            if (hasJoinedValue) {
+                return value;
+            }
+            if (i + 1 >= args.size()) {
+                throw std::invalid_argument("missing value for " + flag);
+            }
+            return args[++i];
+        };
+
+        if      (flag == "--scene")            { options.sceneName                 = parseSceneName(flag, nextValue());     }
+        else if (flag == "--spheres")          { options.sceneNumSpheres           = parseUnsigned(flag, nextValue());      }
+        else if (flag == "--seed")             { options.sceneSeed                 = parseUnsigned(flag, nextValue());      }
+        else if (flag == "--resolution")       { options.imageOutputSize           = parseResolution(flag, nextValue());    }
+        else if (flag == "--threads")          { options.rayTracingThreadCount     = parseUnsigned(flag, nextValue());      }
+        else if (flag == "--depth")            { options.rayTracingReflectionLimit = parseUnsigned(flag, nextValue());      }
+        else if (flag == "--integrator")       { options.rayTracingIntegrator      = parseIntegrator(flag, nextValue());    }
+        else if (flag == "--min-throughput")   { options.rayTracingMinThroughput   = parseUnitFloat(flag, nextValue());     }
+        else if (flag == "--russian-roulette") { options.rayTracingRussianRoulette = true;                                  }
+        else if (flag == "--gamma")            { options.imageOutputGamma          = parsePositiveFloat(flag, nextValue()); }
+        else if (flag == "--output")           { options.imageOutputFile           = nextValue();                           }
+        else if (flag == "--scene-cache")      { options.sceneCacheFile            = nextValue();                           }
+        else if (flag == "--cost-heatmap")     { options.costHeatmapFile           = nextValue();                           }
+        else if (flag == "--profile")          { options.profileTraceFile          = nextValue();                           }
+        else if (flag == "--bench")            { options.benchmarkFrameCount       = parseUnsigned(flag, nextValue());      }
+        else if (flag == "--perf-counters")    { options.perfCounters              = true;                                  }
+        else if (flag == "--quiet")            { options.logInfo                   = false;                                 }
+        else {
+            throw std::invalid_argument("unknown argument \'" + args[i] + "\'");
+        }
+    }
+
+    if (options.sceneNumSpheres == 0) {
+        throw invalidValue("--spheres", "0", "at least one sphere");
+    }
+    if (options.imageOutputFile.empty()) {
+        throw invalidValue("--output", "", "a file path");
+    }
+    return options;
+}
+
+bool CommandLine::isHelpRequested(const std::vector<std::string>& args) {
+    return std::any_of(args.begin(), args.end(), [](const std::string& arg) { return arg == "--help" || arg == "-h"; });
+}
+
+std::string CommandLine::usage(const std::string& programName) {
+    const AppOptions defaults = defaultOptions();
+    std::ostringstream os;
+    os << "usage: " << programName << " [options]\n"
+       << "\n"
+       << "scene:\n"
+       << "  --scene <name>          demo scene to trace, one of:";
+    for (const char* name : DemoScenes::SCENE_NAMES) {
+        os << " " << name;
+    }
+    os << " (default " << defaults.sceneName << ")\n"
+       << "  --spheres <count>       number of spheres in random scenes (default " << defaults.sceneNumSpheres << ")\n"
+       << "  --seed <seed>           seed of random scenes (default " << defaults.sceneSeed << ")\n"
+       << "\n"
+       << "tracing:\n"
+       << "  --resolution <size>     <width>x<height>, or one of:";
+    for (const NamedResolution& resolution : NAMED_RESOLUTIONS) {
+        os << " " << resolution.name;
+    }
+    os << " (default 8k)\n"
+       << "  --threads <count>       worker threads, zero for one per hardware thread (default "
+                                     << defaults.rayTracingThreadCount << ")\n"
+       << "  --depth <count>         maximum number of reflections (default " << defaults.rayTracingReflectionLimit << ")\n"
+       << "  --integrator <name>     recursive (each pixel depth first) or wavefront (each tile a bounce at a time)\n"
+       << "                          (default " << RayTracer::integratorName(defaults.rayTracingIntegrator) << ")\n"
+       << "  --min-throughput <w>    weight in the pixel below which reflections are not traced, from 0 to 1 (default "
+                                     << defaults.rayTracingMinThroughput << ")\n"
+       << "  --russian-roulette      trace reflections below the minimum throughput at random instead, reweighted to match\n"
+       << "\n"
+       << "output:\n"
+       << "  --output <file.ppm>     traced image (default " << defaults.imageOutputFile << ")\n"
+       << "  --gamma <gamma>         gamma correction of the traced image (default " << defaults.imageOutputGamma << ")\n"
+       << "  --scene-cache <file>    cache of the compiled scene, reused while the scene is unchanged\n"
+       << "  --cost-heatmap <file>   per pixel cost heatmaps, written with the metric appended to the name\n"
+       << "  --profile <file.json>   timing zones as chrome trace json\n"
+       << "  --perf-counters         log hardware event counts alongside each phase's time\n"
+       << "  --quiet                 log nothing but errors and benchmark results\n"
+       << "\n"
+       << "benchmarking:\n"
+       << "  --bench <frames>        trace given number of frames without writing images, and report min, median and\n"
+       << "                          p95 frame times\n"
+       << "  -h, --help              show this message\n";
+    return os.str();
+}
@@ -0,0 +1,18 @@
+#pragma once
+#include "App.hpp"
+#include <string>
+#include <vector>
+
+
+// command line interface of the TraceScene app, for tracing any demo scene at any settings without recompiling
+namespace CommandLine {
+
+    // options used when not overridden by any argument
+    AppOptions defaultOptions();
+
+    // options given by arguments (excluding the program name), with invalid or unknown arguments throwing
+    AppOptions parse(const std::vector<std::string>& args);
+
+    bool isHelpRequested(const std::vector<std::string>& args);
+    std::string usage(const std::string& programName);
+}
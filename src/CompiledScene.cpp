@@ -0,0 +1,449 @@
+#include "CompiledScene.hpp"
+#include "Math.hpp"
+#include "Ray.hpp"
+#include "Material.hpp"
+#include "MaterialTable.hpp"
+#include "Lights.hpp"
+#include "Objects.hpp"
+#include "Scene.hpp"
+#include "TriangleMesh.hpp"
+#include "BVH.hpp"
+#include "Simd.hpp"
+#include "Kernels.hpp"
+#include "Profiler.hpp"
+#include <vector>
+#include <algorithm>
+#include <assert.h>
+
+
+// objects are sorted by type, with their bvh built first so that their attributes can be emitted in leaf order
+CompiledScene::CompiledScene(const Scene& scene) {
+    ProfileZone zone{ "compile-scene" };
+    lights_.reserve(scene.getNumLights());
+    for (size_t index = 0; index < scene.getNumLights(); index++) {
+        const PointLight* light = dynamic_cast<const PointLight*>(&scene.getLight(index));
+        if (light == nullptr) {
+            throw std::invalid_argument("only point lights are supported in compiled scenes");
+        }
+        lights_.push_back(*light);
+    }
+    buildLightHierarchy();
+
+    std::vector<const Sphere*>       spheres;
+    std::vector<const Triangle*>     triangles;
+    std::vector<const TriangleMesh*> meshes;
+    std::vector<uint32_t>            sphereMaterials;
+    std::vector<uint32_t>            triangleMaterials;
+    std::vector<uint32_t>            meshMaterials;
+    materials_ = scene.getMaterialTable();
+    for (size_t index = 0; index < scene.getNumObjects(); index++) {
+        const IObject& object = scene.getObject(index);
+        const uint32_t material = scene.getObjectMaterial(index);
+        if (const Sphere* sphere = dynamic_cast<const Sphere*>(&object)) {
+            spheres.push_back(sphere);
+            sphereMaterials.push_back(material);
+        } else if (const Triangle* triangle = dynamic_cast<const Triangle*>(&object)) {
+            triangles.push_back(triangle);
+            triangleMaterials.push_back(material);
+        } else if (const TriangleMesh* mesh = dynamic_cast<const TriangleMesh*>(&object)) {
+            meshes.push_back(mesh);
+            meshMaterials.push_back(material);
+        } else {
+            throw std::invalid_argument("cannot compile object of unknown type: " + object.description());
+        }
+    }
+
+    std::vector<AABB> sphereBounds;
+    sphereBounds.reserve(spheres.size());
+    for (const Sphere* sphere : spheres) {
+        sphereBounds.push_back(sphere->bounds());
+    }
+    sphereBvh_ = BVH(sphereBounds, std::max(BVH::DEFAULT_MAX_LEAF_SIZE, Simd::WIDTH));
+    for (size_t slot = 0; slot < spheres.size(); slot++) {
+        const size_t index = sphereBvh_.getPrimitiveIndex(slot);
+        const Sphere& sphere = *spheres[index];
+        spheres_.centerX .push_back(sphere.center().x);
+        spheres_.centerY .push_back(sphere.center().y);
+        spheres_.centerZ .push_back(sphere.center().z);
+        spheres_.radius  .push_back(sphere.radius());
+        spheres_.material.push_back(sphereMaterials[index]);
+    }
+    // pad with degenerate spheres such that packs loaded at the end of the last leaf stay in bounds
+    for (size_t i = 0; i < Simd::PADDING; i++) {
+        spheres_.centerX.push_back(0.00f);
+        spheres_.centerY.push_back(0.00f);
+        spheres_.centerZ.push_back(0.00f);
+        spheres_.radius .push_back(0.00f);
+    }
+
+    std::vector<AABB> triangleBounds;
+    triangleBounds.reserve(triangles.size());
+    for (const Triangle* triangle : triangles) {
+        triangleBounds.push_back(triangle->bounds());
+    }
+    triangleBvh_ = BVH(triangleBounds);
+    for (size_t slot = 0; slot < triangles.size(); slot++) {
+        const size_t index = triangleBvh_.getPrimitiveIndex(slot);
+        const Triangle& triangle = *triangles[index];
+        const Vec3 edge1 = triangle.vert1() - triangle.vert0();
+        const Vec3 edge2 = triangle.vert2() - triangle.vert0();
+        triangles_.vert0X  .push_back(triangle.vert0().x);
+        triangles_.vert0Y  .push_back(triangle.vert0().y);
+        triangles_.vert0Z  .push_back(triangle.vert0().z);
+        triangles_.edge1X  .push_back(edge1.x);
+        triangles_.edge1Y  .push_back(edge1.y);
+        triangles_.edge1Z  .push_back(edge1.z);
+        triangles_.edge2X  .push_back(edge2.x);
+        triangles_.edge2Y  .push_back(edge2.y);
+        triangles_.edge2Z  .push_back(edge2.z);
+        triangles_.normalX .push_back(triangle.planeNormal().x);
+        triangles_.normalY .push_back(triangle.planeNormal().y);
+        triangles_.normalZ .push_back(triangle.planeNormal().z);
+        triangles_.material.push_back(triangleMaterials[index]);
+    }
+
+    std::vector<AABB> meshBounds;
+    meshBounds.reserve(meshes.size());
+    for (const TriangleMesh* mesh : meshes) {
+        meshBounds.push_back(mesh->bounds());
+    }
+    meshBvh_ = BVH(meshBounds, 1);
+    numPrimitives_ = spheres.size() + triangles.size();
+    for (size_t slot = 0; slot < meshes.size(); slot++) {
+        const size_t index = meshBvh_.getPrimitiveIndex(slot);
+        meshes_.mesh          .push_back(*meshes[index]);
+        meshes_.firstPrimitive.push_back(static_cast<uint32_t>(numPrimitives_));
+        meshes_.material      .push_back(meshMaterials[index]);
+        numPrimitives_ += meshes[index]->numTriangles();
+    }
+    if (numPrimitives_ >= Intersection::NO_INDEX) {
+        throw std::invalid_argument("cannot compile scene with more than 2^32 - 1 primitives");
+    }
+}
+
+
+// find closest primitive hit by given ray, with the triangle traversal starting off already bounded by any sphere hit
+bool CompiledScene::intersect(const Ray& ray, Intersection& result) const {
+    float tClosest = Math::INF;
+    uint32_t closest = Intersection::NO_INDEX;
+    sphereBvh_.traverseClosest(ray, tClosest, [&](size_t first, size_t count, float& tMax) {
+        const bool hit = intersectSpheres(ray, first, count, tMax, closest);
+        tClosest = tMax;
+        return hit;
+    });
+    triangleBvh_.traverseClosest(ray, tClosest, [&](size_t first, size_t count, float& tMax) {
+        const bool hit = intersectTriangles(ray, first, count, tMax, closest);
+        tClosest = tMax;
+        return hit;
+    });
+    meshBvh_.traverseClosest(ray, tClosest, [&](size_t first, size_t count, float& tMax) {
+        const bool hit = intersectMeshes(ray, first, count, tMax, closest);
+        tClosest = tMax;
+        return hit;
+    });
+
+    if (closest == Intersection::NO_INDEX) {
+        return false;
+    }
+    finalizeIntersection(ray, tClosest, closest, result);
+    return true;
+}
+
+// check if any primitive other than the ignored one is hit by given ray before reaching tMax
+bool CompiledScene::isOccluded(const Ray& ray, float tMax, uint32_t ignorePrimitive) const {
+    return
+        sphereBvh_.traverseAny(ray, tMax, [&](size_t first, size_t count, float) {
+            return occludedBySpheres(ray, first, count, tMax, ignorePrimitive);
+        }) ||
+        triangleBvh_.traverseAny(ray, tMax, [&](size_t first, size_t count, float) {
+            return occludedByTriangles(ray, first, count, tMax, ignorePrimitive);
+        }) ||
+        meshBvh_.traverseAny(ray, tMax, [&](size_t first, size_t count, float) {
+            return occludedByMeshes(ray, first, count, tMax, ignorePrimitive);
+        });
+}
+
+// nodes are traversed once per packet, while leaves are intersected lane by lane with the same kernels as single rays
+uint32_t CompiledScene::intersect(const RayPacket& packet, Intersection* results) const {
+    float    tClosest[RayPacket::SIZE];
+    uint32_t closest [RayPacket::SIZE];
+    for (size_t lane = 0; lane < RayPacket::SIZE; lane++) {
+        tClosest[lane] = Math::INF;
+        closest [lane] = Intersection::NO_INDEX;
+    }
+    sphereBvh_.traverseClosest(packet, tClosest, [&](size_t first, size_t count, uint32_t lanes) {
+        for (; lanes != 0; lanes &= lanes - 1) {
+            const int lane = Simd::lowestLane(lanes);
+            intersectSpheres(packet.rays[lane], first, count, tClosest[lane], closest[lane]);
+        }
+    });
+    triangleBvh_.traverseClosest(packet, tClosest, [&](size_t first, size_t count, uint32_t lanes) {
+        for (; lanes != 0; lanes &= lanes - 1) {
+            const int lane = Simd::lowestLane(lanes);
+            intersectTriangles(packet.rays[lane], first, count, tClosest[lane], closest[lane]);
+        }
+    });
+    meshBvh_.traverseClosest(packet, tClosest, [&](size_t first, size_t count, uint32_t lanes) {
+        for (; lanes != 0; lanes &= lanes - 1) {
+            const int lane = Simd::lowestLane(lanes);
+            intersectMeshes(packet.rays[lane], first, count, tClosest[lane], closest[lane]);
+        }
+    });
+
+    uint32_t hits = 0;
+    for (uint32_t lanes = packet.lanes; lanes != 0; lanes &= lanes - 1) {
+        const int lane = Simd::lowestLane(lanes);
+        if (closest[lane] != Intersection::NO_INDEX) {
+            finalizeIntersection(packet.rays[lane], tClosest[lane], closest[lane], results[lane]);
+            hits |= 1u << lane;
+        }
+    }
+    return hits;
+}
+
+uint32_t CompiledScene::isOccluded(const RayPacket& packet, const float* tMax, const uint32_t* ignorePrimitives) const {
+    auto blockedLanes = [&](uint32_t lanes, auto&& isBlocked) {
+        uint32_t blocked = 0;
+        for (; lanes != 0; lanes &= lanes - 1) {
+            const int lane = Simd::lowestLane(lanes);
+            if (isBlocked(lane)) {
+                blocked |= 1u << lane;
+            }
+        }
+        return blocked;
+    };
+
+    // lanes already blocked are dropped from the remaining hierarchies
+    uint32_t blocked = sphereBvh_.traverseAny(packet, packet.lanes, tMax, [&](size_t first, size_t count, uint32_t lanes) {
+        return blockedLanes(lanes, [&](int lane) {
+            return occludedBySpheres(packet.rays[lane], first, count, tMax[lane], ignorePrimitives[lane]);
+        });
+    });
+    blocked |= triangleBvh_.traverseAny(packet, packet.lanes & ~blocked, tMax, [&](size_t first, size_t count, uint32_t lanes) {
+        return blockedLanes(lanes, [&](int lane) {
+            return occludedByTriangles(packet.rays[lane], first, count, tMax[lane], ignorePrimitives[lane]);
+        });
+    });
+    blocked |= meshBvh_.traverseAny(packet, packet.lanes & ~blocked, tMax, [&](size_t first, size_t count, uint32_t lanes) {
+        return blockedLanes(lanes, [&](int lane) {
+            return occludedByMeshes(packet.rays[lane], first, count, tMax[lane], ignorePrimitives[lane]);
+        });
+    });
+    return blocked;
+}
+
+
+// lights too dim to reach even their own position are left out of both
+void CompiledScene::buildLightHierarchy() {
+    lightRadii_.clear();
+    unboundedLights_.clear();
+    boundedLights_.clear();
+    std::vector<AABB> lightBounds;
+    for (size_t index = 0; index < lights_.size(); index++) {
+        const float radius = lights_[index].influenceRadius(MIN_LIGHT_INTENSITY);
+        lightRadii_.push_back(radius);
+        if (radius == Math::INF) {
+            unboundedLights_.push_back(static_cast<uint32_t>(index));
+        } else if (radius > 0.00f) {
+            const Vec3 extent{ radius, radius, radius };
+            boundedLights_.push_back(static_cast<uint32_t>(index));
+            lightBounds.push_back(AABB(lights_[index].position() - extent, lights_[index].position() + extent));
+        }
+    }
+
+    lightBvh_ = BVH(lightBounds);
+    std::vector<uint32_t> leafOrder(boundedLights_.size());
+    for (size_t slot = 0; slot < leafOrder.size(); slot++) {
+        leafOrder[slot] = boundedLights_[lightBvh_.getPrimitiveIndex(slot)];
+    }
+    boundedLights_ = std::move(leafOrder);
+}
+
+// bounded lights are only merged with the unbounded ones when any reach the point, so points out of reach of every
+// bounded light (as in scenes of lights without falloff) get the unbounded lights as is, with nothing copied
+std::span<const uint32_t> CompiledScene::gatherLights(const Vec3& point, std::vector<uint32_t>& storage) const {
+    storage.clear();
+    lightBvh_.traverseContaining(point, [&](size_t firstSlot, size_t count) {
+        for (size_t slot = firstSlot; slot < firstSlot + count; slot++) {
+            const uint32_t light = boundedLights_[slot];
+            if (Math::magnitudeSquared(point - lights_[light].position()) <= Math::square(lightRadii_[light])) {
+                storage.push_back(light);
+            }
+        }
+    });
+    if (storage.empty()) {
+        return unboundedLights_;
+    }
+    storage.insert(storage.end(), unboundedLights_.begin(), unboundedLights_.end());
+    std::sort(storage.begin(), storage.end());
+    return storage;
+}
+
+const ILight& CompiledScene::getLight(size_t index) const {
+    assert(index >= 0 && index < lights_.size());
+    return lights_[index];
+}
+
+float CompiledScene::getLightInfluenceRadius(size_t index) const {
+    assert(index < lightRadii_.size());
+    return lightRadii_[index];
+}
+
+const Material& CompiledScene::getMaterial(size_t index) const {
+    return materials_.get(static_cast<MaterialTable::Index>(index));
+}
+
+size_t CompiledScene::getNumLights() const {
+    return lights_.size();
+}
+
+size_t CompiledScene::getNumMaterials() const {
+    return materials_.size();
+}
+
+size_t CompiledScene::getNumSpheres() const {
+    return spheres_.material.size();
+}
+
+size_t CompiledScene::getNumTriangles() const {
+    return triangles_.material.size();
+}
+
+size_t CompiledScene::getNumMeshes() const {
+    return meshes_.mesh.size();
+}
+
+size_t CompiledScene::getNumPrimitives() const {
+    return numPrimitives_;
+}
+
+
+
+// vectorized over as many spheres per instruction as the target supports
+bool CompiledScene::intersectSpheres(const Ray& ray, size_t first, size_t count, float& tClosest, uint32_t& closest) const {
+    size_t offset = 0;
+    if (!Kernels::intersectSpheres<Simd::FloatN>(&spheres_.centerX[first], &spheres_.centerY[first], &spheres_.centerZ[first],
+                                                 &spheres_.radius[first], count, ray, tClosest, offset)) {
+        return false;
+    }
+    closest = static_cast<uint32_t>(first + offset);
+    return true;
+}
+
+// moller-trumbore: solve for barycentrics (u, v) and distance t of `origin + t * direction = v0 + u * e1 + v * e2`
+// via cramer's rule, rejecting early once either barycentric falls outside the triangle
+// returns the distance to triangle i, or a negative value if the ray misses it
+inline float CompiledScene::intersectTriangle(const Ray& ray, size_t i) const {
+    const Vec3 edge1{ triangles_.edge1X[i], triangles_.edge1Y[i], triangles_.edge1Z[i] };
+    const Vec3 edge2{ triangles_.edge2X[i], triangles_.edge2Y[i], triangles_.edge2Z[i] };
+    const Vec3 p = Math::cross(ray.direction, edge2);
+    const float determinant = Math::dot(edge1, p);
+    if (determinant == 0.00f) {
+        return -1.00f;
+    }
+
+    const float invDeterminant = 1.00f / determinant;
+    const Vec3 s = ray.origin - Vec3(triangles_.vert0X[i], triangles_.vert0Y[i], triangles_.vert0Z[i]);
+    const float u = Math::dot(s, p) * invDeterminant;
+    if (u < 0.00f || u > 1.00f) {
+        return -1.00f;
+    }
+    const Vec3 q = Math::cross(s, edge1);
+    const float v = Math::dot(ray.direction, q) * invDeterminant;
+    if (v < 0.00f || u + v > 1.00f) {
+        return -1.00f;
+    }
+    return Math::dot(edge2, q) * invDeterminant;
+}
+
+bool CompiledScene::intersectTriangles(const Ray& ray, size_t first, size_t count, float& tClosest, uint32_t& closest) const {
+    bool hit = false;
+    for (size_t i = first; i < first + count; i++) {
+        const float t = intersectTriangle(ray, i);
+        if (t >= 0.00f && t < tClosest) {
+            tClosest = t;
+            closest  = static_cast<uint32_t>(getNumSpheres() + i);
+            hit      = true;
+        }
+    }
+    return hit;
+}
+
+bool CompiledScene::occludedBySpheres(const Ray& ray, size_t first, size_t count, float tMax, uint32_t ignore) const {
+    return Kernels::occludedBySpheres<Simd::FloatN>(&spheres_.centerX[first], &spheres_.centerY[first], &spheres_.centerZ[first],
+                                                    &spheres_.radius[first], count, ray, tMax, ignore - first);
+}
+
+bool CompiledScene::occludedByTriangles(const Ray& ray, size_t first, size_t count, float tMax, uint32_t ignore) const {
+    const size_t numSpheres = getNumSpheres();
+    for (size_t i = first; i < first + count; i++) {
+        if (numSpheres + i == ignore) {
+            continue;
+        }
+        const float t = intersectTriangle(ray, i);
+        if (t >= 0.00f && t < tMax) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool CompiledScene::intersectMeshes(const Ray& ray, size_t first, size_t count, float& tClosest, uint32_t& closest) const {
+    bool hit = false;
+    for (size_t i = first; i < first + count; i++) {
+        uint32_t triangle;
+        if (meshes_.mesh[i].intersect(ray, tClosest, triangle)) {
+            closest = meshes_.firstPrimitive[i] + triangle;
+            hit     = true;
+        }
+    }
+    return hit;
+}
+
+bool CompiledScene::occludedByMeshes(const Ray& ray, size_t first, size_t count, float tMax, uint32_t ignore) const {
+    for (size_t i = first; i < first + count; i++) {
+        const uint32_t firstPrimitive = meshes_.firstPrimitive[i];
+        const uint32_t ignoreTriangle = (ignore >= firstPrimitive && ignore - firstPrimitive < meshes_.mesh[i].numTriangles())
+            ? ignore - firstPrimitive
+            : Intersection::NO_INDEX;
+        if (meshes_.mesh[i].occluded(ray, tMax, ignoreTriangle)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void CompiledScene::finalizeIntersection(const Ray& ray, float t, uint32_t primitive, Intersection& result) const {
+    result.t         = t;
+    result.point     = ray.origin + ray.direction * t;
+    result.object    = nullptr;
+    result.primitive = primitive;
+    if (primitive < getNumSpheres()) {
+        const Vec3 center{ spheres_.centerX[primitive], spheres_.centerY[primitive], spheres_.centerZ[primitive] };
+        result.normal   = Math::direction(center, result.point);
+        result.material = spheres_.material[primitive];
+    } else if (primitive < getNumSpheres() + getNumTriangles()) {
+        const size_t i = primitive - getNumSpheres();
+        result.normal   = Vec3(triangles_.normalX[i], triangles_.normalY[i], triangles_.normalZ[i]);
+        result.material = triangles_.material[i];
+    } else {
+        // last mesh starting at or before the primitive
+        const auto next = std::upper_bound(meshes_.firstPrimitive.begin(), meshes_.firstPrimitive.end(), primitive);
+        const size_t i  = static_cast<size_t>(next - meshes_.firstPrimitive.begin()) - 1;
+        result.normal   = meshes_.mesh[i].planeNormal(primitive - meshes_.firstPrimitive[i]);
+        result.material = meshes_.material[i];
+    }
+}
+
+
+
+std::ostream& operator<<(std::ostream& os, const CompiledScene& scene) {
+    os << "CompiledScene("
+         << "light-count:"    << scene.getNumLights()    << ","
+         << "material-count:" << scene.getNumMaterials() << ","
+         << "sphere-count:"   << scene.getNumSpheres()   << ","
+         << "triangle-count:" << scene.getNumTriangles() << ","
+         << "mesh-count:"     << scene.getNumMeshes()
+       << ")";
+    return os;
+}
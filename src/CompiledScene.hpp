@@ -0,0 +1,122 @@
+#pragma once
+#include "Math.hpp"
+#include "Ray.hpp"
+#include "Material.hpp"
+#include "Lights.hpp"
+#include "Scene.hpp"
+#include "TriangleMesh.hpp"
+#include "MaterialTable.hpp"
+#include "BVH.hpp"
+#include "RayPacket.hpp"
+#include <vector>
+#include <span>
+#include <cstdint>
+
+
+/*
+Read only, flattened form of a scene for tracing, compiled once from a `Scene` after all objects are added.
+
+Spheres and triangles are each stored as structures of arrays, reordered such that every leaf of their bounding
+volume hierarchy spans a contiguous range. This way intersection runs as linear passes over plain floats, with no
+heap indirection or virtual dispatch per object, and only the closest hit is expanded into a full hit record.
+
+Meshes already carry their own hierarchy and compact shared buffers, so they are kept as is under a top level
+hierarchy over their bounds, rather than being expanded into triangles.
+
+Primitives are identified by a single index, with spheres preceding triangles, followed by each mesh's triangles
+in turn, and each references its material by index into the scene's table of distinct materials.
+
+Lights that fall off with distance only reach as far as their intensity stays above a minimum, so they are indexed
+by a hierarchy over their spheres of influence, letting each point gather just the lights that reach it.
+*/
+class CompiledScene {
+public:
+    explicit CompiledScene(const Scene& scene);
+
+    bool intersect(const Ray& ray, Intersection& result) const;
+    bool isOccluded(const Ray& ray, float tMax, uint32_t ignorePrimitive = Intersection::NO_INDEX) const;
+
+    // packet counterparts of the above, returning the lanes that hit something (filling in only their results), and
+    // the lanes blocked before their own tMax (each ignoring its own primitive) respectively
+    uint32_t intersect(const RayPacket& packet, Intersection* results) const;
+    uint32_t isOccluded(const RayPacket& packet, const float* tMax, const uint32_t* ignorePrimitives) const;
+
+    // indices of the lights reaching the point (within their influence radius) in ascending order, which are either
+    // just the lights without falloff, or otherwise are gathered into the given storage
+    std::span<const uint32_t> gatherLights(const Vec3& point, std::vector<uint32_t>& storage) const;
+
+    const ILight&   getLight(size_t index)    const;
+    float getLightInfluenceRadius(size_t index) const;
+    const Material& getMaterial(size_t index) const;
+
+    size_t getNumLights()     const;
+    size_t getNumMaterials()  const;
+    size_t getNumSpheres()    const;
+    size_t getNumTriangles()  const;
+    size_t getNumMeshes()     const;
+    size_t getNumPrimitives() const;
+
+    // intensity below which a light no longer counts as reaching a point
+    static constexpr float MIN_LIGHT_INTENSITY = 1e-03f;
+
+private:
+    friend class SceneCache;
+    CompiledScene() = default;
+
+    struct SphereArrays {
+        std::vector<float>    centerX;
+        std::vector<float>    centerY;
+        std::vector<float>    centerZ;
+        std::vector<float>    radius;
+        std::vector<uint32_t> material;
+    };
+
+    // vertex and edges are laid out for moller-trumbore intersection, with the normal kept only for shading
+    struct TriangleArrays {
+        std::vector<float>    vert0X;
+        std::vector<float>    vert0Y;
+        std::vector<float>    vert0Z;
+        std::vector<float>    edge1X;
+        std::vector<float>    edge1Y;
+        std::vector<float>    edge1Z;
+        std::vector<float>    edge2X;
+        std::vector<float>    edge2Y;
+        std::vector<float>    edge2Z;
+        std::vector<float>    normalX;
+        std::vector<float>    normalY;
+        std::vector<float>    normalZ;
+        std::vector<uint32_t> material;
+    };
+
+    struct MeshArrays {
+        std::vector<TriangleMesh> mesh;
+        std::vector<uint32_t>     firstPrimitive;
+        std::vector<uint32_t>     material;
+    };
+
+    std::vector<PointLight> lights_;
+    MaterialTable           materials_;
+    SphereArrays            spheres_;
+    TriangleArrays          triangles_;
+    MeshArrays              meshes_;
+    size_t                  numPrimitives_{ 0 };
+    BVH                     sphereBvh_;
+    BVH                     triangleBvh_;
+    BVH                     meshBvh_;
+    std::vector<float>      lightRadii_;       // influence radius of each light
+    std::vector<uint32_t>   unboundedLights_;  // lights without any falloff, which reach every point
+    std::vector<uint32_t>   boundedLights_;    // remaining lights reaching anywhere at all, in leaf order
+    BVH                     lightBvh_;         // over the bounds of the bounded lights' spheres of influence
+
+    void buildLightHierarchy();
+
+    float intersectTriangle(const Ray& ray, size_t i) const;
+    bool intersectSpheres(const Ray& ray, size_t first, size_t count, float& tClosest, uint32_t& closest) const;
+    bool intersectTriangles(const Ray& ray, size_t first, size_t count, float& tClosest, uint32_t& closest) const;
+    bool intersectMeshes(const Ray& ray, size_t first, size_t count, float& tClosest, uint32_t& closest) const;
+    bool occludedBySpheres(const Ray& ray, size_t first, size_t count, float tMax, uint32_t ignore) const;
+    bool occludedByTriangles(const Ray& ray, size_t first, size_t count, float tMax, uint32_t ignore) const;
+    bool occludedByMeshes(const Ray& ray, size_t first, size_t count, float tMax, uint32_t ignore) const;
+    void finalizeIntersection(const Ray& ray, float t, uint32_t primitive, Intersection& result) const;
+};
+std::ostream& operator<<(std::ostream& os, const CompiledScene& scene);
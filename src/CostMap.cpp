@@ -0,0 +1,128 @@
+#include "CostMap.hpp"
+#include "Math.hpp"
+#include "Color.hpp"
+#include "FrameBuffer.hpp"
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+#include <assert.h>
+
+
+CostMap::CostMap(const Vec2& dimensions)
+    : CostMap(static_cast<size_t>(dimensions.x), static_cast<size_t>(dimensions.y)) {}
+
+CostMap::CostMap(size_t width, size_t height)
+    : width_     (width),
+      height_    (height),
+      bufferSize_(width * height),
+      costs_     (std::make_unique<PixelCost[]>(bufferSize_)) {
+    if (width <= 0 || height <= 0 || bufferSize_ <= 0) {
+        throw std::invalid_argument("cost map must have dimensions greater than zero");
+    }
+}
+
+size_t CostMap::width() const {
+    return width_;
+}
+
+size_t CostMap::height() const {
+    return height_;
+}
+
+size_t CostMap::numPixels() const {
+    return bufferSize_;
+}
+
+
+const PixelCost& CostMap::getCost(size_t i) const noexcept {
+    assert((i >= 0 && i < bufferSize_));
+    return costs_[i];
+}
+
+const PixelCost& CostMap::getCost(size_t row, size_t col) const noexcept {
+    assert((row * width_) + col < bufferSize_);
+    return costs_[(row * width_) + col];
+}
+
+void CostMap::setCost(size_t row, size_t col, const PixelCost& cost) noexcept {
+    assert((row * width_) + col < bufferSize_);
+    costs_[(row * width_) + col] = cost;
+}
+
+uint64_t CostMap::total(CostMetric metric) const {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < bufferSize_; i++) {
+        sum += valueOf(costs_[i], metric);
+    }
+    return sum;
+}
+
+FrameBuffer CostMap::toHeatmap(CostMetric metric) const {
+    std::vector<uint64_t> values(bufferSize_);
+    for (size_t i = 0; i < bufferSize_; i++) {
+        values[i] = valueOf(costs_[i], metric);
+    }
+
+    // partially sort a copy to find the percentile value, without disturbing pixel order
+    std::vector<uint64_t> sorted = values;
+    const size_t percentileIndex = static_cast<size_t>(NORMALIZING_PERCENTILE * (bufferSize_ - 1));
+    std::nth_element(sorted.begin(), sorted.begin() + percentileIndex, sorted.end());
+    const float invScale = 1.00f / std::max<uint64_t>(1, sorted[percentileIndex]);
+
+    FrameBuffer heatmap{ width_, height_ };
+    for (size_t i = 0; i < bufferSize_; i++) {
+        heatmap.setPixel(i, heatmapColor(Math::min(1.00f, values[i] * invScale)));
+    }
+    return heatmap;
+}
+
+const char* CostMap::metricName(CostMetric metric) {
+    switch (metric) {
+        case CostMetric::IntersectionTests: return "intersection-tests";
+        case CostMetric::ShadowRays:        return "shadow-rays";
+        case CostMetric::TraceTime:         return "trace-time";
+    }
+    return "unknown";
+}
+
+
+uint64_t CostMap::valueOf(const PixelCost& cost, CostMetric metric) noexcept {
+    switch (metric) {
+        case CostMetric::IntersectionTests: return cost.intersectionTests;
+        case CostMetric::ShadowRays:        return cost.shadowRays;
+        case CostMetric::TraceTime:         return cost.nanoseconds;
+    }
+    return 0;
+}
+
+// piecewise linear ramp through evenly spaced stops, perceptually ordered so that brighter always means costlier
+Color CostMap::heatmapColor(float value) noexcept {
+    static constexpr Color STOPS[] = {
+        Color(0.000f, 0.000f, 0.000f),
+        Color(0.230f, 0.050f, 0.420f),
+        Color(0.730f, 0.210f, 0.330f),
+        Color(0.990f, 0.550f, 0.040f),
+        Color(0.990f, 1.000f, 0.640f),
+    };
+    static constexpr size_t NUM_SEGMENTS = (sizeof(STOPS) / sizeof(STOPS[0])) - 1;
+
+    const float position = Math::clamp(value, 0.00f, 1.00f) * NUM_SEGMENTS;
+    const size_t segment = std::min(static_cast<size_t>(position), NUM_SEGMENTS - 1);
+    const float  t       = position - segment;
+    const Color& from    = STOPS[segment];
+    const Color& to      = STOPS[segment + 1];
+    return Color(Math::lerp(t, from.r, to.r), Math::lerp(t, from.g, to.g), Math::lerp(t, from.b, to.b));
+}
+
+
+std::ostream& operator<<(std::ostream& os, const CostMap& costMap) {
+    os << "CostMap("
+         << "width:"              << costMap.width()                                << ","
+         << "height:"             << costMap.height()                               << ","
+         << "intersection-tests:" << costMap.total(CostMetric::IntersectionTests)   << ","
+         << "shadow-rays:"        << costMap.total(CostMetric::ShadowRays)          << ","
+         << "trace-nanoseconds:"  << costMap.total(CostMetric::TraceTime)
+       << ")";
+    return os;
+}
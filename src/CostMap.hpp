@@ -0,0 +1,65 @@
+#pragma once
+#include "Math.hpp"
+#include "FrameBuffer.hpp"
+#include <iostream>
+#include <memory>
+#include <cstdint>
+
+
+// work done tracing a single pixel, including all of its reflections
+struct PixelCost {
+    uint32_t intersectionTests{ 0 };
+    uint32_t shadowRays       { 0 };
+    uint64_t nanoseconds      { 0 };
+};
+
+
+// what a heatmap of a cost map shows
+enum class CostMetric { IntersectionTests, ShadowRays, TraceTime };
+
+
+// grid of per pixel tracing costs, laid out like the frame buffer it was recorded alongside, for finding the regions
+// of a scene that dominate render time
+//
+// heatmaps are normalized against a high percentile rather than the maximum, so a few outliers (e.g. pixels that
+// happened to be traced while the thread was preempted) don't wash out the rest of the image
+class CostMap {
+public:
+    CostMap()                     = delete;
+    CostMap(const CostMap&)       = delete;
+    CostMap& operator=(CostMap&)  = delete;
+    CostMap& operator=(CostMap&&) = default;
+    CostMap(CostMap&&)            = default;
+
+    explicit CostMap(const Vec2& dimensions);
+    CostMap(size_t width, size_t height);
+
+    size_t width()     const;
+    size_t height()    const;
+    size_t numPixels() const;
+
+    const PixelCost& getCost(size_t i) const noexcept;
+    const PixelCost& getCost(size_t row, size_t col) const noexcept;
+    void setCost(size_t row, size_t col, const PixelCost& cost) noexcept;
+
+    // given metric of every pixel summed over the whole map
+    uint64_t total(CostMetric metric) const;
+
+    // false color image of given metric, from black (cheapest) through purple and orange to pale yellow (costliest)
+    FrameBuffer toHeatmap(CostMetric metric) const;
+
+    static const char* metricName(CostMetric metric);
+
+private:
+    size_t width_;
+    size_t height_;
+    size_t bufferSize_;
+    std::unique_ptr<PixelCost[]> costs_;
+
+    static constexpr float NORMALIZING_PERCENTILE = 0.99f;
+
+    static uint64_t valueOf(const PixelCost& cost, CostMetric metric) noexcept;
+    static Color heatmapColor(float value) noexcept;
+};
+
+std::ostream& operator<<(std::ostream& os, const CostMap& costMap);
@@ -0,0 +1,257 @@
+#include "DemoScenes.hpp"
+#include "Math.hpp"
+#include "Color.hpp"
+#include "Material.hpp"
+#include "Lights.hpp"
+#include "Objects.hpp"
+#include "Scene.hpp"
+#include "Profiler.hpp"
+#include <cmath>
+#include <string>
+#include <vector>
+#include <random>
+#include <cstdint>
+#include <bit>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+
+
+namespace {
+
+    // uniform float in [lower, upper) from the top 24 bits of the generator, unlike `std::uniform_real_distribution`
+    // giving identical sequences on every standard library
+    float uniform(std::mt19937& gen, float lower, float upper) {
+        return lower + (upper - lower) * (static_cast<float>(gen() >> 8) * 0x1.0p-24f);
+    }
+
+    // spatial hash of spheres, bucketed by the grid cell (as wide as the largest sphere) their center lies in, so a
+    // sphere can only overlap spheres in the 27 cells around its own
+    //
+    // buckets are a fixed power of two table of linked lists, sized for the expected number of spheres, with cells
+    // sharing a bucket just adding a few extra candidates to check
+    class SphereHash {
+    public:
+        SphereHash(float maxRadius, size_t capacity)
+            : cellSize_(2.00f * maxRadius),
+              buckets_ (std::bit_ceil(std::max<size_t>(2 * capacity, 64)), NONE) {
+            centers_.reserve(capacity);
+            radii_  .reserve(capacity);
+            next_   .reserve(capacity);
+        }
+
+        bool overlapsAny(const Vec3& center, float radius) const {
+            const int64_t cx = cellCoordinate(center.x);
+            const int64_t cy = cellCoordinate(center.y);
+            const int64_t cz = cellCoordinate(center.z);
+            for (int64_t x = cx - 1; x <= cx + 1; x++) {
+                for (int64_t y = cy - 1; y <= cy + 1; y++) {
+                    for (int64_t z = cz - 1; z <= cz + 1; z++) {
+                        for (uint32_t i = buckets_[bucket(x, y, z)]; i != NONE; i = next_[i]) {
+                            if (Math::magnitudeSquared(centers_[i] - center) < Math::square(radius + radii_[i])) {
+                                return true;
+                            }
+                        }
+                    }
+                }
+            }
+            return false;
+        }
+
+        void insert(const Vec3& center, float radius) {
+            uint32_t& head = buckets_[bucket(cellCoordinate(center.x), cellCoordinate(center.y), cellCoordinate(center.z))];
+            next_.push_back(head);
+            head = static_cast<uint32_t>(centers_.size());
+            centers_.push_back(center);
+            radii_.push_back(radius);
+        }
+
+    private:
+        static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+        float                 cellSize_;
+        std::vector<uint32_t> buckets_;
+        std::vector<uint32_t> next_;
+        std::vector<Vec3>     centers_;
+        std::vector<float>    radii_;
+
+        int64_t cellCoordinate(float value) const {
+            return static_cast<int64_t>(std::floor(value / cellSize_));
+        }
+
+        // large primes of teschner et al. (2003), for spreading neighboring cells across the table
+        size_t bucket(int64_t x, int64_t y, int64_t z) const {
+            const uint64_t hash = (static_cast<uint64_t>(x) * 73856093u) ^
+                                  (static_cast<uint64_t>(y) * 19349663u) ^
+                                  (static_cast<uint64_t>(z) * 83492791u);
+            return static_cast<size_t>(hash & (buckets_.size() - 1));
+        }
+    };
+
+    // add spheres of random size, color, and material to the scene, without overlap, each centered within given
+    // bounds (raised by its radius when resting on the ground)
+    void addRandomSpheres(Scene& scene, size_t numSpheres, uint64_t seed, const Vec3& lower, const Vec3& upper, bool isOnGround) {
+        ProfileZone zone{ "place-random-spheres" };
+        constexpr float  MIN_RADIUS = 1.00f;
+        constexpr float  MAX_RADIUS = 10.0f;
+        constexpr size_t MAX_ATTEMPTS_PER_SPHERE = 10000;
+
+        std::seed_seq seedSequence{ static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32) };
+        std::mt19937 gen{ seedSequence };
+        SphereHash placed{ MAX_RADIUS, numSpheres };
+        for (size_t i = 0; i < numSpheres; i++) {
+            size_t attempts = 0;
+            Vec3 center;
+            float R;
+            do {
+                if (attempts++ == MAX_ATTEMPTS_PER_SPHERE) {
+                    throw std::runtime_error("unable to fit " + std::to_string(numSpheres) + " spheres without overlap");
+                }
+                R = uniform(gen, MIN_RADIUS, MAX_RADIUS);
+                center = Vec3(uniform(gen, lower.x, upper.x), isOnGround ? R : uniform(gen, lower.y, upper.y), uniform(gen, lower.z, upper.z));
+            } while (placed.overlapsAny(center, R));
+            placed.insert(center, R);
+
+            const Color c{ uniform(gen, 0.00f, 1.00f), uniform(gen, 0.00f, 1.00f), uniform(gen, 0.00f, 1.00f) };
+            const float intrinsity = uniform(gen, 0.00f, 1.00f);
+            Material material{};
+            material.setWeights(intrinsity, 1.0f - intrinsity);
+            material.setColors(c, c, c);
+            material.setShininess(10);
+            scene.addSceneObject(Sphere(center, R, material));
+        }
+    }
+
+    void addGround(Scene& scene, const Material& groundMaterial, float L) {
+        Vec3 v11{-L, 0.0f, -L};
+        Vec3 v12{ L, 0.0f, -L};
+        Vec3 v13{ L, 0.0f,  L};
+        scene.addSceneObject(Triangle(v11, v12, v13, groundMaterial));
+
+        Vec3 v21{-L, 0.0f, -L};
+        Vec3 v22{ L, 0.0f,  L};
+        Vec3 v23{-L, 0.0f,  L};
+        scene.addSceneObject(Triangle(v21, v22, v23, groundMaterial));
+    }
+}
+
+
+Scene DemoScenes::createTriangleScene() {
+    Scene scene{};
+
+    Color color = Palette::gray;
+    float intrinsity = 0.8;
+    float reflectivity = 1.0f - intrinsity;
+    Material Material{};
+    Material.setWeights(intrinsity, reflectivity);
+    Material.setColors(color, color, color);
+    Material.setShininess(1);
+
+    float L = 10.0;
+
+    Vec3 v1{0.0f, 0.0f, 0.0f};
+    Vec3 v2{L,    0.0f, 0.0f};
+    Vec3 v3{L,    L,    0.0f};
+    scene.addSceneObject(Triangle(v1, v2, v3, Material));
+
+    return scene;
+}
+
+Scene DemoScenes::createSimpleScene(const Vec3& localOrigin) {
+    Material reflectiveRed{};
+    reflectiveRed.setWeights(0.50f, 0.50f);
+    reflectiveRed.setColors(Palette::darkRed, Palette::red, Palette::orangeRed);
+    reflectiveRed.setShininess(10);
+
+    Material reflectiveGreen{};
+    reflectiveGreen.setWeights(0.50f, 0.50f);
+    reflectiveGreen.setColors(Palette::darkGreen, Palette::green, Palette::lightGreen);
+    reflectiveGreen.setShininess(10);
+
+    Material reflectiveBlue{};
+    reflectiveBlue.setWeights(0.50f, 0.50f);
+    reflectiveBlue.setColors(Palette::darkBlue, Palette::blue, Palette::lightBlue);
+    reflectiveBlue.setShininess(10);
+
+    Scene scene{};
+    scene.addLight(PointLight(localOrigin + Vec3(0, 55, 50), Palette::antiqueWhite));
+    scene.addSceneObject(Sphere(localOrigin + Vec3(0, 80, 0), 10.00f, reflectiveRed));
+    scene.addSceneObject(Sphere(localOrigin + Vec3(0, 55, 0), 15.00f, reflectiveGreen));
+    scene.addSceneObject(Sphere(localOrigin + Vec3(0, 20, 0), 20.00f, reflectiveBlue));
+    return scene;
+}
+
+// the demo's 100 spheres fill a 200x200x90 box, which grows with the sphere count to keep the same density
+Scene DemoScenes::createRandomFloatingScene(size_t numSpheres, uint64_t seed) {
+    Scene scene{};
+    scene.addLight(PointLight(Vec3(0.0f, 0.0f, 0.0f), Palette::antiqueWhite));
+
+    const float scale = std::max(1.00f, std::cbrt(numSpheres / static_cast<float>(DEFAULT_NUM_SPHERES)));
+    addRandomSpheres(scene, numSpheres, seed,
+        Vec3(-100.0f * scale, -100.0f * scale, 10.0f), Vec3(100.0f * scale, 100.0f * scale, 10.0f + 90.0f * scale), false);
+    return scene;
+}
+
+// the demo's 100 spheres rest on a 200x90 patch of ground, which grows with the sphere count to keep the same density
+Scene DemoScenes::createRandomGroundScene(size_t numSpheres, uint64_t seed) {
+    Scene scene{};
+    scene.addLight(PointLight(Vec3(50.0f, 200.0f, -10.0f), Palette::antiqueWhite));
+    scene.addLight(PointLight(Vec3(-50.0f, 200.0f, -10.0f), Palette::antiqueWhite));
+
+    Color groundColor = Palette::gray;
+    float groundIntrinsivity = 0.85;
+    float groundReflectivity = 1.0f - groundIntrinsivity;
+    Material groundMaterial{};
+    groundMaterial.setWeights(groundIntrinsivity, groundReflectivity);
+    groundMaterial.setColors(groundColor, groundColor, groundColor);
+    groundMaterial.setShininess(1);
+
+    const float scale = std::max(1.00f, std::sqrt(numSpheres / static_cast<float>(DEFAULT_NUM_SPHERES)));
+    addGround(scene, groundMaterial, 1000.0f * scale);
+    addRandomSpheres(scene, numSpheres, seed,
+        Vec3(-100.0f * scale, 0.0f, 10.0f), Vec3(100.0f * scale, 0.0f, 10.0f + 90.0f * scale), true);
+    return scene;
+}
+
+Scene DemoScenes::createSimpleGroundScene() {
+    Scene scene{};
+    scene.addLight(PointLight(Vec3(50.0f, 200.0f, -10.0f), Palette::antiqueWhite));
+    scene.addLight(PointLight(Vec3(-50.0f, 200.0f, -10.0f), Palette::antiqueWhite));
+
+    Color groundColor = Palette::darkGreen;
+    float groundIntrinsivity = 0.95;
+    float groundReflectivity = 1.0f - groundIntrinsivity;
+    Material groundMaterial{};
+    groundMaterial.setWeights(groundIntrinsivity, groundReflectivity);
+    groundMaterial.setColors(groundColor, groundColor, groundColor);
+    groundMaterial.setShininess(1);
+
+    addGround(scene, groundMaterial, 1000.0f);
+
+    Material reflectiveBlue{};
+    reflectiveBlue.setWeights(0.50f, 0.50f);
+    reflectiveBlue.setColors(Palette::darkBlue, Palette::blue, Palette::lightBlue);
+    reflectiveBlue.setShininess(10);
+
+    Material reflectiveRed{};
+    reflectiveRed.setWeights(0.50f, 0.50f);
+    reflectiveRed.setColors(Palette::darkRed, Palette::red, Palette::orangeRed);
+    reflectiveRed.setShininess(10);
+
+    float R;
+    R = 30.0f;
+    scene.addSceneObject(Sphere(Vec3(-1.5f*R, R, 0.0f), R, reflectiveBlue));
+    R = 20.0f;
+    scene.addSceneObject(Sphere(Vec3(1.5f*R, R, 0.0f), R, reflectiveRed));
+
+    return scene;
+}
+
+Scene DemoScenes::createNamedScene(const std::string& name, size_t numSpheres, uint64_t seed) {
+    if (name == "triangle")        { return createTriangleScene();                       }
+    if (name == "simple")          { return createSimpleScene();                         }
+    if (name == "simple-ground")   { return createSimpleGroundScene();                   }
+    if (name == "random-floating") { return createRandomFloatingScene(numSpheres, seed); }
+    if (name == "random-ground")   { return createRandomGroundScene(numSpheres, seed);   }
+    throw std::invalid_argument("unknown demo scene \'" + name + "\'");
+}
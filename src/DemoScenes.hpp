@@ -0,0 +1,26 @@
+#pragma once
+#include "Math.hpp"
+#include "Scene.hpp"
+#include <string>
+#include <cstdint>
+
+
+// the example scenes traced by the app, shared with the benchmarks
+namespace DemoScenes {
+
+    inline constexpr size_t   DEFAULT_NUM_SPHERES = 100;
+    inline constexpr uint64_t DEFAULT_SEED        = 2022;
+
+    Scene createTriangleScene();
+    Scene createSimpleScene(const Vec3& localOrigin = Vec3::zero());
+    Scene createSimpleGroundScene();
+
+    // spheres of random size, color, and material, placed without overlap in a region that grows with their count
+    // (scaling to millions), with the same seed always generating the same scene
+    Scene createRandomFloatingScene(size_t numSpheres = DEFAULT_NUM_SPHERES, uint64_t seed = DEFAULT_SEED);
+    Scene createRandomGroundScene(size_t numSpheres = DEFAULT_NUM_SPHERES, uint64_t seed = DEFAULT_SEED);
+
+    // any of the above by name (with sphere count and seed ignored by the fixed scenes)
+    inline constexpr const char* SCENE_NAMES[] = { "triangle", "simple", "simple-ground", "random-floating", "random-ground" };
+    Scene createNamedScene(const std::string& name, size_t numSpheres = DEFAULT_NUM_SPHERES, uint64_t seed = DEFAULT_SEED);
+}
@@ -1,9 +1,20 @@
 #pragma once
 #include "Files.hpp"
 #include "FrameBuffer.hpp"
+#include "CostMap.hpp"
+#include "Material.hpp"
+#include "TriangleMesh.hpp"
+#include "ThreadPool.hpp"
+#include "MappedFile.hpp"
+#include "Profiler.hpp"
+#include <vector>
 #include <fstream>
 #include <exception>
 #include <filesystem>
+#include <charconv>
+#include <algorithm>
+#include <limits>
+#include <cstdint>
 #include <assert.h>
 
 
@@ -35,6 +46,102 @@ namespace detail {
         }
         return ofs;
     }
+
+
+    // target size of the newline aligned chunks that an obj file is split into for parsing in parallel
+    inline constexpr size_t OBJ_CHUNK_SIZE = 256 * 1024;
+
+    // vertices and triangles parsed from a single chunk, with face indices converted to zero based, but those given
+    // relative to the end of the vertex list (negative in the file) only resolved up to the start of the chunk
+    struct ObjChunk {
+        const char*           begin{ nullptr };
+        const char*           end{ nullptr };
+        std::vector<Vec3>     vertices;
+        std::vector<int64_t>  indices;
+        std::vector<size_t>   relativeIndices;
+        std::exception_ptr    error;
+    };
+
+    inline bool isBlank(char c) {
+        return c == ' ' || c == '\t' || c == '\r';
+    }
+
+    inline const char* skipBlanks(const char* p, const char* end) {
+        while (p < end && isBlank(*p)) {
+            p++;
+        }
+        return p;
+    }
+
+    inline const char* skipToken(const char* p, const char* end) {
+        while (p < end && !isBlank(*p)) {
+            p++;
+        }
+        return p;
+    }
+
+    float parseObjFloat(const char*& p, const char* end) {
+        p = skipBlanks(p, end);
+        if (p < end && *p == '+') {
+            p++;
+        }
+        float value;
+        const auto [next, error] = std::from_chars(p, end, value);
+        if (error != std::errc()) {
+            throw std::runtime_error("malformed vertex coordinate");
+        }
+        p = next;
+        return value;
+    }
+
+    // parse every line starting within the chunk, without copying any of them
+    void parseObjChunk(ObjChunk& chunk) {
+        std::vector<int64_t> polygon;
+        std::vector<bool>    isRelative;
+        const auto emitIndex = [&](size_t corner) {
+            if (isRelative[corner]) {
+                chunk.relativeIndices.push_back(chunk.indices.size());
+            }
+            chunk.indices.push_back(polygon[corner]);
+        };
+
+        const char* line = chunk.begin;
+        while (line < chunk.end) {
+            const char* lineEnd = std::find(line, chunk.end, '\n');
+            const char* p = skipBlanks(line, lineEnd);
+            if (lineEnd - p >= 2 && p[0] == 'v' && isBlank(p[1])) {
+                p++;
+                const float x = parseObjFloat(p, lineEnd);
+                const float y = parseObjFloat(p, lineEnd);
+                const float z = parseObjFloat(p, lineEnd);
+                chunk.vertices.push_back(Vec3(x, y, z));
+            } else if (lineEnd - p >= 2 && p[0] == 'f' && isBlank(p[1])) {
+                // each vertex is given as `v`, `v/vt`, `v//vn` or `v/vt/vn`, of which only `v` is of use here
+                polygon.clear();
+                isRelative.clear();
+                for (p = skipBlanks(p + 1, lineEnd); p < lineEnd; p = skipBlanks(skipToken(p, lineEnd), lineEnd)) {
+                    int64_t index;
+                    const auto [next, error] = std::from_chars(p, lineEnd, index);
+                    if (error != std::errc() || index == 0) {
+                        throw std::runtime_error("malformed face index");
+                    }
+                    polygon.push_back(index < 0 ? static_cast<int64_t>(chunk.vertices.size()) + index : index - 1);
+                    isRelative.push_back(index < 0);
+                    p = next;
+                }
+                if (polygon.size() < 3) {
+                    throw std::runtime_error("face with less than three vertices");
+                }
+                // triangulate as a fan around the first vertex, which is exact for the convex polygons obj expects
+                for (size_t k = 2; k < polygon.size(); k++) {
+                    emitIndex(0);
+                    emitIndex(k - 1);
+                    emitIndex(k);
+                }
+            }
+            line = lineEnd + 1;
+        }
+    }
 }
 
 
@@ -110,4 +217,102 @@ namespace Files {
                 << static_cast<unsigned char>((Math::pow(color.b, invGamma) * 255) + 0.50f);
         }
     }
+
+    // save given metric of a cost map as a false color heatmap, written without gamma correction since its colors
+    // are already picked to be perceptually ordered
+    void writeHeatmapPpm(const std::string& filepath, const CostMap& costMap, CostMetric metric) {
+        writePpm(filepath, costMap.toHeatmap(metric));
+    }
+
+    // load the vertices and faces of a wavefront obj file into a single mesh, ignoring texture coordinates, normals,
+    // groups and materials (with a temporary pool using every hardware thread)
+    TriangleMesh readObj(const std::string& filepath, const Material& material) {
+        ThreadPool threadPool{};
+        return readObj(filepath, material, threadPool);
+    }
+
+    // load the vertices and faces of a wavefront obj file into a single mesh, ignoring texture coordinates, normals,
+    // groups and materials
+    //
+    // the file is mapped into memory and split into newline aligned chunks that are parsed in parallel, after which
+    // the chunks' vertices and indices are concatenated in parallel straight into the mesh's buffers
+    TriangleMesh readObj(const std::string& filepath, const Material& material, ThreadPool& threadPool) {
+        ProfileZone zone{ "read-obj" };
+        if (std::filesystem::path(filepath).extension() != ".obj") {
+            throw std::runtime_error("Cannot read file \'" + filepath + "\' - does not end with .obj");
+        }
+        if (!std::filesystem::exists(filepath)) {
+            throw std::runtime_error("Cannot read file \'" + filepath + "\' - does not exist");
+        }
+        const MappedFile file{ filepath };
+        const char* fileEnd = file.data() + file.size();
+
+        // each chunk ends just past the first newline at or after its even share of the file
+        const size_t numChunks = std::max<size_t>(1, file.size() / detail::OBJ_CHUNK_SIZE);
+        std::vector<detail::ObjChunk> chunks(numChunks);
+        for (size_t i = 0; i < numChunks; i++) {
+            chunks[i].begin = (i == 0) ? file.data() : chunks[i - 1].end;
+            chunks[i].end   = std::max(chunks[i].begin, file.data() + ((i + 1) * file.size()) / numChunks);
+            chunks[i].end   = std::find(chunks[i].end, fileEnd, '\n');
+            if (chunks[i].end != fileEnd) {
+                chunks[i].end++;
+            }
+        }
+
+        // errors are kept per chunk rather than left to propagate, so that the earliest failing chunk is the one reported,
+        // along with its byte range
+        threadPool.parallelFor(numChunks, [&](size_t i, size_t) {
+            try {
+                detail::parseObjChunk(chunks[i]);
+            } catch (...) {
+                chunks[i].error = std::current_exception();
+            }
+        });
+
+        size_t numVertices = 0;
+        size_t numIndices  = 0;
+        std::vector<size_t> vertexOffsets(numChunks);
+        std::vector<size_t> indexOffsets(numChunks);
+        for (size_t i = 0; i < numChunks; i++) {
+            if (chunks[i].error) {
+                try {
+                    std::rethrow_exception(chunks[i].error);
+                } catch (const std::exception& e) {
+                    throw std::runtime_error("Cannot read file \'" + filepath + "\' - " + e.what() + " within bytes " +
+                        std::to_string(chunks[i].begin - file.data()) + " to " + std::to_string(chunks[i].end - file.data()));
+                }
+            }
+            vertexOffsets[i] = numVertices;
+            indexOffsets[i]  = numIndices;
+            numVertices += chunks[i].vertices.size();
+            numIndices  += chunks[i].indices.size();
+        }
+        if (numVertices >= std::numeric_limits<uint32_t>::max()) {
+            throw std::runtime_error("Cannot read file \'" + filepath + "\' - too many vertices to index with 32 bits");
+        }
+        if (numIndices == 0) {
+            throw std::runtime_error("Cannot read file \'" + filepath + "\' - no faces");
+        }
+
+        std::vector<Vec3> vertices(numVertices);
+        std::vector<uint32_t> indices(numIndices);
+        std::vector<char> hasInvalidIndex(numChunks, false);
+        threadPool.parallelFor(numChunks, [&](size_t i, size_t) {
+            detail::ObjChunk& chunk = chunks[i];
+            for (size_t relative : chunk.relativeIndices) {
+                chunk.indices[relative] += static_cast<int64_t>(vertexOffsets[i]);
+            }
+            for (size_t k = 0; k < chunk.indices.size(); k++) {
+                const int64_t index = chunk.indices[k];
+                hasInvalidIndex[i] |= (index < 0 || index >= static_cast<int64_t>(numVertices));
+                indices[indexOffsets[i] + k] = static_cast<uint32_t>(index);
+            }
+            std::copy(chunk.vertices.begin(), chunk.vertices.end(), vertices.begin() + vertexOffsets[i]);
+        });
+        if (std::find(hasInvalidIndex.begin(), hasInvalidIndex.end(), true) != hasInvalidIndex.end()) {
+            throw std::runtime_error("Cannot read file \'" + filepath + "\' - face references a missing vertex");
+        }
+
+        return TriangleMesh(std::move(vertices), std::move(indices), material);
+    }
 }
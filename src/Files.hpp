@@ -1,4 +1,5 @@
 #pragma once
+#include <string>
 #include <fstream>
 #include <exception>
 #include <filesystem>
@@ -6,6 +7,11 @@
 
 
 class FrameBuffer;
+class CostMap;
+enum class CostMetric;
+class Material;
+class ThreadPool;
+class TriangleMesh;
 
 namespace Files {
 
@@ -18,4 +24,8 @@ namespace Files {
 
     void writePpm(const std::string& filepath, const FrameBuffer& frameBuffer);
     void writePpmWithGammaCorrection(const std::string& filepath, const FrameBuffer& frameBuffer, float gammaCorrection = 2.20f);
+    void writeHeatmapPpm(const std::string& filepath, const CostMap& costMap, CostMetric metric);
+
+    TriangleMesh readObj(const std::string& filepath, const Material& material);
+    TriangleMesh readObj(const std::string& filepath, const Material& material, ThreadPool& threadPool);
 }
@@ -2,23 +2,29 @@
 #include "FrameBuffer.hpp"
 #include "Math.hpp"
 #include "Color.hpp"
+#include "Radiance.hpp"
 #include <iostream>
 #include <assert.h>
 
 
-FrameBuffer::FrameBuffer(const Vec2& dimensions)
-    : FrameBuffer(static_cast<size_t>(dimensions.x), static_cast<size_t>(dimensions.y)) {}
+FrameBuffer::FrameBuffer(const Vec2& dimensions, PixelFormat pixelFormat)
+    : FrameBuffer(static_cast<size_t>(dimensions.x), static_cast<size_t>(dimensions.y), pixelFormat) {}
 
-FrameBuffer::FrameBuffer(size_t width, size_t height)
-    : width_     (width),
-      height_    (height),
-      bufferSize_(width * height),
-      pixels_    (std::make_unique<Color[]>(bufferSize_)) {
+FrameBuffer::FrameBuffer(size_t width, size_t height, PixelFormat pixelFormat)
+    : width_      (width),
+      height_     (height),
+      bufferSize_ (width * height),
+      pixelFormat_(pixelFormat),
+      pixels_     (std::make_unique<Radiance[]>(bufferSize_)) {
     if (width <= 0 || height <= 0 || bufferSize_ <= 0) {
         throw std::invalid_argument("frame buffer must have dimensions greater than zero");
     }
 }
 
+FrameBuffer::PixelFormat FrameBuffer::pixelFormat() const {
+    return pixelFormat_;
+}
+
 size_t FrameBuffer::width() const {
     return width_;
 }
@@ -50,23 +56,44 @@ std::pair<size_t, size_t> FrameBuffer::getPixelRowCol(size_t i) const noexcept {
 
 Color FrameBuffer::getPixel(size_t i) const noexcept {
     assert((i >= 0 && i < bufferSize_));
-    return pixels_[i];
+    return pixels_[i].toColor();
 }
 
 Color FrameBuffer::getPixel(size_t row, size_t col) const noexcept {
+    assert((row >= 0 && row < height_) && (col >= 0 && col < width_));
+    return pixels_[width_ * row + col].toColor();
+}
+
+Radiance FrameBuffer::getRadiance(size_t i) const noexcept {
+    assert((i >= 0 && i < bufferSize_));
+    return pixels_[i];
+}
+
+Radiance FrameBuffer::getRadiance(size_t row, size_t col) const noexcept {
     assert((row >= 0 && row < height_) && (col >= 0 && col < width_));
     return pixels_[width_ * row + col];
 }
 
 
-void FrameBuffer::setPixel(size_t i, const Color& color) noexcept {
+void FrameBuffer::setPixel(size_t i, const Radiance& radiance) noexcept {
     assert((i >= 0 && i < bufferSize_));
-    pixels_[i] = color;
+    pixels_[i] = toStoredFormat(radiance);
 }
 
-void FrameBuffer::setPixel(size_t row, size_t col, const Color& color) noexcept {
+void FrameBuffer::setPixel(size_t row, size_t col, const Radiance& radiance) noexcept {
     assert((row >= 0 && row < height_) && (col >= 0 && col < width_));
-    pixels_[width_ * row + col] = color;
+    pixels_[width_ * row + col] = toStoredFormat(radiance);
+}
+
+// add given sample to the pixel (eg for averaging several samples by scaling each by the reciprocal of their count)
+void FrameBuffer::accumulatePixel(size_t row, size_t col, const Radiance& radiance) noexcept {
+    assert((row >= 0 && row < height_) && (col >= 0 && col < width_));
+    Radiance& pixel = pixels_[width_ * row + col];
+    pixel = toStoredFormat(pixel + radiance);
+}
+
+Radiance FrameBuffer::toStoredFormat(const Radiance& radiance) const noexcept {
+    return pixelFormat_ == PixelFormat::HDR ? radiance : Radiance(radiance.toColor());
 }
 
 
@@ -77,6 +104,8 @@ std::ostream& operator<<(std::ostream& os, const FrameBuffer& frameBuffer) {
            << "width:"       << frameBuffer.width()     << ","
            << "height:"      << frameBuffer.height()    << ","
            << "pixel-count:" << frameBuffer.numPixels() << "}, "
+         << "Format{"
+           << "high-dynamic-range:" << (frameBuffer.pixelFormat() == FrameBuffer::PixelFormat::HDR) << "}, "
          << "MetaData{"
            << "mega-pixels:"  << frameBuffer.megaPixels()  << ","
            << "aspect-ratio:" << frameBuffer.aspectRatio() << "}"
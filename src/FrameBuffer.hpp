@@ -1,6 +1,8 @@
 #pragma once
 #include "Color.hpp"
+#include "Radiance.hpp"
 #include <iostream>
+#include <memory>
 
 
 namespace CommonResolutions {
@@ -17,17 +19,25 @@ namespace CommonResolutions {
     inline constexpr Vec2 HD_12K   = Vec2(12288, 6480);
 }
 
+// grid of pixels, stored either clamped to displayable colors as they're set (the default), or in high dynamic range
+// as unclamped radiance, for accumulating multiple samples per pixel or tone mapping later on
+//
+// either way reading a pixel as a color clamps it, so output is unaffected by the format
 class FrameBuffer {
 public:
+    enum class PixelFormat { LDR, HDR };
+
     FrameBuffer()                         = delete;
     FrameBuffer(const FrameBuffer&)       = delete;
     FrameBuffer& operator=(FrameBuffer&)  = delete;
     FrameBuffer& operator=(FrameBuffer&&) = default;
     FrameBuffer(FrameBuffer&&)            = default;
 
-    explicit FrameBuffer(const Vec2& dimensions);
-    FrameBuffer(size_t width, size_t height);
-    
+    explicit FrameBuffer(const Vec2& dimensions, PixelFormat pixelFormat = PixelFormat::LDR);
+    FrameBuffer(size_t width, size_t height, PixelFormat pixelFormat = PixelFormat::LDR);
+
+    PixelFormat pixelFormat() const;
+
     size_t width()      const;
     size_t height()     const;
     size_t numPixels()  const;
@@ -36,16 +46,22 @@ public:
 
     Color getPixel(size_t i) const noexcept;
     Color getPixel(size_t row, size_t col) const noexcept;
+    Radiance getRadiance(size_t i) const noexcept;
+    Radiance getRadiance(size_t row, size_t col) const noexcept;
     std::pair<size_t, size_t> getPixelRowCol(size_t i) const noexcept;
 
-    void setPixel(size_t i, const Color& color) noexcept;
-    void setPixel(size_t row, size_t col, const Color& color) noexcept;
+    void setPixel(size_t i, const Radiance& radiance) noexcept;
+    void setPixel(size_t row, size_t col, const Radiance& radiance) noexcept;
+    void accumulatePixel(size_t row, size_t col, const Radiance& radiance) noexcept;
 
 private:
     size_t width_;
     size_t height_;
     size_t bufferSize_;
-    std::unique_ptr<Color[]> pixels_;
+    PixelFormat pixelFormat_;
+    std::unique_ptr<Radiance[]> pixels_;
+
+    Radiance toStoredFormat(const Radiance& radiance) const noexcept;
 };
 
 std::ostream& operator<<(std::ostream& os, const FrameBuffer& frameBuffer);
@@ -0,0 +1,37 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+
+
+/*
+Incremental 64 bit FNV-1a, which is plenty for telling values apart (e.g. scenes or materials) without pulling in a
+dependency.
+
+Only arithmetic values can be added directly, so that padding bytes of structs never leak into a hash.
+*/
+class Fnv1aHash {
+public:
+    void add(const void* data, size_t numBytes) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < numBytes; i++) {
+            hash_ = (hash_ ^ bytes[i]) * PRIME;
+        }
+    }
+
+    template <typename T>
+    void add(T value) {
+        static_assert(std::is_arithmetic_v<T>, "only arithmetic values can be hashed by their bytes");
+        add(&value, sizeof(value));
+    }
+
+    uint64_t value() const {
+        return hash_;
+    }
+
+private:
+    static constexpr uint64_t OFFSET_BASIS = 0xcbf29ce484222325ull;
+    static constexpr uint64_t PRIME        = 0x100000001b3ull;
+
+    uint64_t hash_{ OFFSET_BASIS };
+};
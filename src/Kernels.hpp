@@ -0,0 +1,109 @@
+#pragma once
+#include "Math.hpp"
+#include "Ray.hpp"
+#include "Simd.hpp"
+#include <cstddef>
+#include <cstdint>
+
+
+/*
+Branch free intersection kernels over primitives stored as structures of arrays, written against `Simd` packs so
+the same code runs N primitives per instruction, or one at a time when instantiated with `Simd::Float1`.
+
+Kernels only find the distance and offset of the closest (or any) hit, leaving computation of the hit point and
+normal to the caller once the overall winner is known. Input arrays must satisfy the padding requirements of
+`Simd`, as lanes past `count` are loaded and then masked out.
+*/
+namespace Kernels {
+
+    // nearest non-negative root of each sphere less than tClosest, where a hit shrinks tClosest and sets closest to
+    // the offset of that sphere from the given pointers
+    //
+    // with a == d.d == 1, the roots simplify to t = -(d.L) +/- sqrt((d.L)^2 - (L.L - r^2)) for L = P_0 - P_c,
+    // of which we take the near root unless the ray starts inside the sphere
+    template <typename FloatN>
+    inline bool intersectSpheres(const float* centerX, const float* centerY, const float* centerZ, const float* radius,
+                                 size_t count, const Ray& ray, float& tClosest, size_t& closest) {
+        const FloatN originX    = FloatN::broadcast(ray.origin.x);
+        const FloatN originY    = FloatN::broadcast(ray.origin.y);
+        const FloatN originZ    = FloatN::broadcast(ray.origin.z);
+        const FloatN directionX = FloatN::broadcast(ray.direction.x);
+        const FloatN directionY = FloatN::broadcast(ray.direction.y);
+        const FloatN directionZ = FloatN::broadcast(ray.direction.z);
+        const FloatN zero       = FloatN::broadcast(0.00f);
+
+        bool hit = false;
+        for (size_t i = 0; i < count; i += FloatN::width) {
+            const FloatN Lx = originX - FloatN::load(centerX + i);
+            const FloatN Ly = originY - FloatN::load(centerY + i);
+            const FloatN Lz = originZ - FloatN::load(centerZ + i);
+            const FloatN r  = FloatN::load(radius + i);
+
+            const FloatN halfB = directionX * Lx + directionY * Ly + directionZ * Lz;
+            const FloatN c     = (Lx * Lx + Ly * Ly + Lz * Lz) - r * r;
+            const FloatN quarterDiscriminant = halfB * halfB - c;
+            const FloatN sqrtOfDiscriminant  = sqrt(max(quarterDiscriminant, zero));
+            const FloatN tNear = -halfB - sqrtOfDiscriminant;
+            const FloatN tFar  = -halfB + sqrtOfDiscriminant;
+            const FloatN t     = select(tNear >= zero, tNear, tFar);
+
+            const uint32_t valid = Simd::firstLanes(count - i, FloatN::width) &
+                ((quarterDiscriminant >= zero) & (t >= zero) & (t < FloatN::broadcast(tClosest))).bits();
+            if (valid == 0) {
+                continue;
+            }
+
+            // hits are rare enough per pack that resolving the winner lane by lane beats a masked reduction
+            float distances[FloatN::width];
+            t.store(distances);
+            for (uint32_t lanes = valid; lanes != 0; lanes &= lanes - 1) {
+                const int lane = Simd::lowestLane(lanes);
+                if (distances[lane] < tClosest) {
+                    tClosest = distances[lane];
+                    closest  = i + lane;
+                    hit      = true;
+                }
+            }
+        }
+        return hit;
+    }
+
+    // whether any sphere other than the one at offset `ignore` has its nearest non-negative root before tMax
+    template <typename FloatN>
+    inline bool occludedBySpheres(const float* centerX, const float* centerY, const float* centerZ, const float* radius,
+                                  size_t count, const Ray& ray, float tMax, size_t ignore) {
+        const FloatN originX    = FloatN::broadcast(ray.origin.x);
+        const FloatN originY    = FloatN::broadcast(ray.origin.y);
+        const FloatN originZ    = FloatN::broadcast(ray.origin.z);
+        const FloatN directionX = FloatN::broadcast(ray.direction.x);
+        const FloatN directionY = FloatN::broadcast(ray.direction.y);
+        const FloatN directionZ = FloatN::broadcast(ray.direction.z);
+        const FloatN zero       = FloatN::broadcast(0.00f);
+        const FloatN limit      = FloatN::broadcast(tMax);
+
+        for (size_t i = 0; i < count; i += FloatN::width) {
+            const FloatN Lx = originX - FloatN::load(centerX + i);
+            const FloatN Ly = originY - FloatN::load(centerY + i);
+            const FloatN Lz = originZ - FloatN::load(centerZ + i);
+            const FloatN r  = FloatN::load(radius + i);
+
+            const FloatN halfB = directionX * Lx + directionY * Ly + directionZ * Lz;
+            const FloatN c     = (Lx * Lx + Ly * Ly + Lz * Lz) - r * r;
+            const FloatN quarterDiscriminant = halfB * halfB - c;
+            const FloatN sqrtOfDiscriminant  = sqrt(max(quarterDiscriminant, zero));
+            const FloatN tNear = -halfB - sqrtOfDiscriminant;
+            const FloatN tFar  = -halfB + sqrtOfDiscriminant;
+            const FloatN t     = select(tNear >= zero, tNear, tFar);
+
+            uint32_t blocked = Simd::firstLanes(count - i, FloatN::width) &
+                ((quarterDiscriminant >= zero) & (t >= zero) & (t < limit)).bits();
+            if (ignore >= i && ignore < i + FloatN::width) {
+                blocked &= ~(1u << (ignore - i));
+            }
+            if (blocked != 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+}
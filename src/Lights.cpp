@@ -23,8 +23,7 @@ PointLight::PointLight(const Vec3& position, const Color& intensity)
 // compute intensity at given point according to inverse square law with respect to distance and attenuation coefficients
 Color PointLight::computeIntensityAtPoint(const Vec3& point) const {
     const float distanceSquared = Math::magnitudeSquared(point - this->position_);
-    const Vec3 direction = Math::direction(this->position_, point);
-    const float distance  = Math::square(distanceSquared);
+    const float distance        = Math::squareRoot(distanceSquared);
     return intensity_ / 
         ((attenuationConstant_) + (attenuationLinear_ * distance) + (attenuationQuadratic_ * distanceSquared));
 }
@@ -52,7 +51,29 @@ float PointLight::attenuationLinear() const {
 }
 
 float PointLight::attenuationQuadratic() const {
-    return attenuationConstant_;
+    return attenuationQuadratic_;
+}
+
+// solves for where the attenuation reaches the ratio of the light's intensity to the given one, as intensity only
+// ever falls off with distance (with the coefficients never negative)
+float PointLight::influenceRadius(float minIntensity) const {
+    const float maxIntensity = Math::max(intensity_.r, Math::max(intensity_.g, intensity_.b));
+    if (!(minIntensity > 0.00f)) {
+        return Math::INF;
+    }
+    const float attenuation = maxIntensity / minIntensity;
+    if (attenuation <= attenuationConstant_) {
+        return 0.00f;
+    }
+    if (attenuationQuadratic_ > 0.00f) {
+        const float discriminant = Math::square(attenuationLinear_) +
+                                   4.00f * attenuationQuadratic_ * (attenuation - attenuationConstant_);
+        return (Math::squareRoot(discriminant) - attenuationLinear_) / (2.00f * attenuationQuadratic_);
+    }
+    if (attenuationLinear_ > 0.00f) {
+        return (attenuation - attenuationConstant_) / attenuationLinear_;
+    }
+    return Math::INF;
 }
 
 // attenuation coefficients sum to create a falloff from source in range [0.0, 1.0],
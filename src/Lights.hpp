@@ -36,6 +36,9 @@ public:
     float attenuationLinear()    const;
     float attenuationQuadratic() const;
 
+    // distance beyond which the light's brightest channel falls below given intensity (infinite without any falloff)
+    float influenceRadius(float minIntensity) const;
+
     void setAttenuation(float constant, float linear, float quadratic);
 
 private:
@@ -0,0 +1,139 @@
+#include "MappedFile.hpp"
+#include <string>
+#include <utility>
+#include <stdexcept>
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+#endif
+
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& filepath) {
+    HANDLE file = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Cannot map file \'" + filepath + "\' - error while opening for read");
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        CloseHandle(file);
+        throw std::runtime_error("Cannot map file \'" + filepath + "\' - unable to query size");
+    }
+    fileHandle_ = file;
+    size_       = static_cast<size_t>(fileSize.QuadPart);
+    if (size_ == 0) {
+        return;  // empty files can't be mapped, but are still valid to read
+    }
+
+    mappingHandle_ = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mappingHandle_ != nullptr) {
+        data_ = static_cast<const char*>(MapViewOfFile(mappingHandle_, FILE_MAP_READ, 0, 0, 0));
+    }
+    if (data_ == nullptr) {
+        unmap();
+        throw std::runtime_error("Cannot map file \'" + filepath + "\' - error while mapping into memory");
+    }
+}
+
+void MappedFile::unmap() noexcept {
+    if (data_ != nullptr) {
+        UnmapViewOfFile(data_);
+    }
+    if (mappingHandle_ != nullptr) {
+        CloseHandle(mappingHandle_);
+    }
+    if (fileHandle_ != nullptr) {
+        CloseHandle(fileHandle_);
+    }
+    data_          = nullptr;
+    size_          = 0;
+    mappingHandle_ = nullptr;
+    fileHandle_    = nullptr;
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& filepath) {
+    const int file = open(filepath.c_str(), O_RDONLY);
+    if (file < 0) {
+        throw std::runtime_error("Cannot map file \'" + filepath + "\' - error while opening for read");
+    }
+    struct stat status;
+    if (fstat(file, &status) != 0) {
+        close(file);
+        throw std::runtime_error("Cannot map file \'" + filepath + "\' - unable to query size");
+    }
+    size_ = static_cast<size_t>(status.st_size);
+    if (size_ == 0) {
+        close(file);
+        return;  // empty files can't be mapped, but are still valid to read
+    }
+
+    // the mapping stays valid after closing the descriptor
+    void* mapping = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if (mapping == MAP_FAILED) {
+        size_ = 0;
+        throw std::runtime_error("Cannot map file \'" + filepath + "\' - error while mapping into memory");
+    }
+    madvise(mapping, size_, MADV_WILLNEED);
+    data_ = static_cast<const char*>(mapping);
+}
+
+void MappedFile::unmap() noexcept {
+    if (data_ != nullptr) {
+        munmap(const_cast<char*>(data_), size_);
+    }
+    data_ = nullptr;
+    size_ = 0;
+}
+
+#endif
+
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        unmap();
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+#ifdef _WIN32
+        std::swap(fileHandle_,    other.fileHandle_);
+        std::swap(mappingHandle_, other.mappingHandle_);
+#endif
+    }
+    return *this;
+}
+
+MappedFile::~MappedFile() {
+    unmap();
+}
+
+
+const char* MappedFile::data() const {
+    return data_;
+}
+
+size_t MappedFile::size() const {
+    return size_;
+}
+
+bool MappedFile::isEmpty() const {
+    return size_ == 0;
+}
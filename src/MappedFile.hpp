@@ -0,0 +1,35 @@
+#pragma once
+#include <string>
+#include <cstddef>
+
+
+/*
+Read only memory mapping of an entire file, unmapped on destruction.
+
+Lets large inputs be parsed (or used) in place straight from the page cache, without first copying them into a
+buffer. Note that the mapped bytes are not null terminated.
+*/
+class MappedFile {
+public:
+    MappedFile(const MappedFile&)            = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    explicit MappedFile(const std::string& filepath);
+    ~MappedFile();
+
+    const char* data()    const;
+    size_t      size()    const;
+    bool        isEmpty() const;
+
+private:
+    const char* data_{ nullptr };
+    size_t      size_{ 0 };
+#ifdef _WIN32
+    void*       fileHandle_{ nullptr };
+    void*       mappingHandle_{ nullptr };
+#endif
+
+    void unmap() noexcept;
+};
@@ -0,0 +1,80 @@
+#include "MaterialTable.hpp"
+#include "Material.hpp"
+#include "Color.hpp"
+#include "Hash.hpp"
+#include <vector>
+#include <limits>
+#include <stdexcept>
+#include <assert.h>
+
+
+MaterialTable::Index MaterialTable::add(const Material& material) {
+    std::vector<Index>& candidates = indicesByHash_[hash(material)];
+    for (Index index : candidates) {
+        if (isEqual(materials_[index], material)) {
+            return index;
+        }
+    }
+    if (materials_.size() >= std::numeric_limits<Index>::max()) {
+        throw std::length_error("material table is full");
+    }
+
+    const Index index = static_cast<Index>(materials_.size());
+    materials_.push_back(material);
+    candidates.push_back(index);
+    return index;
+}
+
+const Material& MaterialTable::get(Index index) const {
+    assert(index < materials_.size());
+    return materials_[index];
+}
+
+size_t MaterialTable::size() const {
+    return materials_.size();
+}
+
+bool MaterialTable::isEmpty() const {
+    return materials_.empty();
+}
+
+
+// FNV-1a over the bits of every property, such that only materials that are equal field by field collide
+uint64_t MaterialTable::hash(const Material& material) {
+    const Color ambient  = material.ambientColor();
+    const Color diffuse  = material.diffuseColor();
+    const Color specular = material.specularColor();
+    const float properties[] = {
+        ambient.r,  ambient.g,  ambient.b,
+        diffuse.r,  diffuse.g,  diffuse.b,
+        specular.r, specular.g, specular.b,
+        material.intrinsity(), material.reflectivity(), material.refractivity(), material.shininess(),
+    };
+
+    Fnv1aHash hash{};
+    for (float property : properties) {
+        hash.add(property);
+    }
+    return hash.value();
+}
+
+bool MaterialTable::isEqual(const Material& a, const Material& b) {
+    const auto isSameColor = [](const Color& x, const Color& y) {
+        return x.r == y.r && x.g == y.g && x.b == y.b;
+    };
+    return isSameColor(a.ambientColor(),  b.ambientColor())  &&
+           isSameColor(a.diffuseColor(),  b.diffuseColor())  &&
+           isSameColor(a.specularColor(), b.specularColor()) &&
+           a.intrinsity()   == b.intrinsity()   &&
+           a.reflectivity() == b.reflectivity() &&
+           a.refractivity() == b.refractivity() &&
+           a.shininess()    == b.shininess();
+}
+
+
+std::ostream& operator<<(std::ostream& os, const MaterialTable& materialTable) {
+    os << "MaterialTable("
+         << "material-count:" << materialTable.size()
+       << ")";
+    return os;
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include "Material.hpp"
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <iostream>
+
+
+/*
+Deduplicated list of the distinct materials in a scene, referenced by 32 bit index.
+
+Primitives store only the index of their material, rather than a full copy of it, so that arrays of primitives stay
+compact during traversal, and shading reads the (typically few) distinct materials straight out of the table by
+reference. Adding a material equal to one already in the table yields the existing index.
+*/
+class MaterialTable {
+public:
+    using Index = uint32_t;
+
+    MaterialTable() = default;
+
+    Index add(const Material& material);
+
+    const Material& get(Index index) const;
+    size_t size() const;
+    bool isEmpty() const;
+
+private:
+    std::vector<Material>                            materials_;
+    std::unordered_map<uint64_t, std::vector<Index>> indicesByHash_;
+
+    static uint64_t hash(const Material& material);
+    static bool isEqual(const Material& a, const Material& b);
+};
+std::ostream& operator<<(std::ostream& os, const MaterialTable& materialTable);
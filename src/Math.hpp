@@ -2,8 +2,24 @@
 #include <iomanip>
 #include <sstream>
 #include <cmath>
+#include <type_traits>
 #include <assert.h>
 
+// vec3 is backed by 4 wide sse or neon registers when built with RAYTRACER_SIMD_VEC3 (if the target has either),
+// and by plain scalar floats otherwise
+#if defined(RAYTRACER_SIMD_VEC3)
+    #if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+        #include <immintrin.h>
+        #define RAYTRACER_VEC3_SSE
+    #elif defined(__ARM_NEON) && defined(__aarch64__)
+        #include <arm_neon.h>
+        #define RAYTRACER_VEC3_NEON
+    #endif
+#endif
+#if defined(RAYTRACER_VEC3_SSE) || defined(RAYTRACER_VEC3_NEON)
+    #define RAYTRACER_VEC3_PACKED
+#endif
+
 
 struct Vec2 {
     float x;
@@ -81,10 +97,26 @@ inline std::ostream& operator<<(std::ostream& os, const Vec2& vec) {
 
 
 
+/*
+Three component vector of floats.
+
+In builds with a SIMD backend each vec3 is padded to 16 bytes so that operators load it into a single register. The
+fourth lane starts out zero, but its value after arithmetic is unspecified (e.g. dividing by a zero scalar leaves a NaN
+there), so it is never read back into x, y, or z, nor hashed or compared. All operations are still constexpr, falling
+back to scalar code during constant evaluation. Results match the scalar build bit for bit, other than
+`Math::normalize` (and `Math::direction`), which uses a refined reciprocal square root estimate instead.
+*/
+#if defined(RAYTRACER_VEC3_PACKED)
+struct alignas(16) Vec3 {
+#else
 struct Vec3 {
+#endif
     float x;
     float y;
     float z;
+#if defined(RAYTRACER_VEC3_PACKED)
+    float padding{ 0.00f };  // unspecified after arithmetic, see above
+#endif
     static constexpr size_t len = 3;
 
     Vec3() noexcept = default;
@@ -104,59 +136,169 @@ struct Vec3 {
     static constexpr Vec3 right()  { return Vec3( 1,  0,  0); };
     static constexpr Vec3 left()   { return Vec3(-1,  0,  0); };
 
-    inline constexpr Vec3& operator+=(const Vec3& rhs) {
-        x += rhs.x;
-        y += rhs.y;
-        z += rhs.z;
-        return *this;
+    // component access by axis index (0=x, 1=y, 2=z)
+    inline constexpr float operator[](size_t axis) const {
+        assert(axis < len);
+        return axis == 0 ? x : (axis == 1 ? y : z);
     }
 
-    inline constexpr Vec3& operator-=(const Vec3& rhs) {
-        x -= rhs.x;
-        y -= rhs.y;
-        z -= rhs.z;
-        return *this;
-    }
+    inline constexpr Vec3& operator+=(const Vec3& rhs);
+    inline constexpr Vec3& operator-=(const Vec3& rhs);
+    inline constexpr Vec3& operator*=(float rhs);
+    inline constexpr Vec3& operator/=(float rhs);
+};
+
+
+
+#if defined(RAYTRACER_VEC3_PACKED)
+// register level operations backing vec3, with lanes [x, y, z, padding]
+namespace Vec3Pack {
+
+#if defined(RAYTRACER_VEC3_SSE)
+    using Register = __m128;
+
+    inline Register load(const Vec3& v)      { return _mm_load_ps(&v.x); }
+    inline Register broadcast(float value)   { return _mm_set1_ps(value); }
+    inline Register add(Register a, Register b)      { return _mm_add_ps(a, b); }
+    inline Register subtract(Register a, Register b) { return _mm_sub_ps(a, b); }
+    inline Register multiply(Register a, Register b) { return _mm_mul_ps(a, b); }
+    inline Register divide(Register a, Register b)   { return _mm_div_ps(a, b); }
+    inline Register negate(Register a)               { return _mm_xor_ps(a, _mm_set1_ps(-0.00f)); }
+    inline Register min(Register a, Register b)      { return _mm_min_ps(a, b); }
+    inline Register max(Register a, Register b)      { return _mm_max_ps(a, b); }
+    // c - a * b, rounded once where fma is available
+    inline Register negativeMultiplyAdd(Register a, Register b, Register c) {
+    #if defined(__FMA__)
+        return _mm_fnmadd_ps(a, b, c);
+    #else
+        return _mm_sub_ps(c, _mm_mul_ps(a, b));
+    #endif
+    }
+    // lanes rotated to [y, z, x, padding]
+    inline Register rotate(Register a)               { return _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1)); }
+    // (x + y) + z, summed in the same order as the scalar code
+    inline float sum(Register a) {
+        const __m128 xy = _mm_add_ss(a, _mm_shuffle_ps(a, a, _MM_SHUFFLE(1, 1, 1, 1)));
+        return _mm_cvtss_f32(_mm_add_ss(xy, _mm_movehl_ps(a, a)));
+    }
+    // reciprocal square root estimate (12 bits) refined by a newton-raphson step to near full precision
+    inline float reciprocalSquareRoot(float value) {
+        const float estimate = _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(value)));
+        return estimate * (1.50f - 0.50f * value * estimate * estimate);
+    }
+    inline Vec3 store(Register a) {
+        Vec3 v;
+        _mm_store_ps(&v.x, a);
+        return v;
+    }
+#elif defined(RAYTRACER_VEC3_NEON)
+    using Register = float32x4_t;
+
+    inline Register load(const Vec3& v)      { return vld1q_f32(&v.x); }
+    inline Register broadcast(float value)   { return vdupq_n_f32(value); }
+    inline Register add(Register a, Register b)      { return vaddq_f32(a, b); }
+    inline Register subtract(Register a, Register b) { return vsubq_f32(a, b); }
+    inline Register multiply(Register a, Register b) { return vmulq_f32(a, b); }
+    inline Register divide(Register a, Register b)   { return vdivq_f32(a, b); }
+    inline Register negate(Register a)               { return vnegq_f32(a); }
+    // selects matching the scalar min/max (rather than vminq/vmaxq), which differ in their handling of nans
+    inline Register min(Register a, Register b)      { return vbslq_f32(vcleq_f32(a, b), a, b); }
+    inline Register max(Register a, Register b)      { return vbslq_f32(vcgeq_f32(a, b), a, b); }
+    inline Register negativeMultiplyAdd(Register a, Register b, Register c) { return vfmsq_f32(c, a, b); }
+    inline Register rotate(Register a) {
+        const float32x2_t xy = vget_low_f32(a);
+        const float32x2_t zw = vget_high_f32(a);
+        return vcombine_f32(vext_f32(xy, zw, 1), vcopy_lane_f32(zw, 0, xy, 0));
+    }
+    inline float sum(Register a) {
+        return (vgetq_lane_f32(a, 0) + vgetq_lane_f32(a, 1)) + vgetq_lane_f32(a, 2);
+    }
+    inline float reciprocalSquareRoot(float value) {
+        const float32x2_t v = vdup_n_f32(value);
+        const float32x2_t estimate = vrsqrte_f32(v);
+        return vget_lane_f32(vmul_f32(estimate, vrsqrts_f32(vmul_f32(v, estimate), estimate)), 0);
+    }
+    inline Vec3 store(Register a) {
+        Vec3 v;
+        vst1q_f32(&v.x, a);
+        return v;
+    }
+#endif
+}
+#endif
 
-    inline constexpr Vec3& operator*=(float rhs) {
-        x *= rhs;
-        y *= rhs;
-        z *= rhs;
-        return *this;
-    }
 
-    inline constexpr Vec3& operator/=(float rhs) {
-        x /= rhs;
-        y /= rhs;
-        z /= rhs;
-        return *this;
-    }
-};
 
 inline constexpr Vec3 operator-(const Vec3& v) {
+#if defined(RAYTRACER_VEC3_PACKED)
+    if (!std::is_constant_evaluated()) {
+        return Vec3Pack::store(Vec3Pack::negate(Vec3Pack::load(v)));
+    }
+#endif
     return Vec3(-v.x, -v.y, -v.z);
 }
 
 inline constexpr Vec3 operator+(const Vec3& lhs, const Vec3& rhs) {
+#if defined(RAYTRACER_VEC3_PACKED)
+    if (!std::is_constant_evaluated()) {
+        return Vec3Pack::store(Vec3Pack::add(Vec3Pack::load(lhs), Vec3Pack::load(rhs)));
+    }
+#endif
     return Vec3(lhs.x + rhs.x, lhs.y + rhs.y, lhs.z + rhs.z);
 }
 
 inline constexpr Vec3 operator-(const Vec3& lhs, const Vec3& rhs) {
+#if defined(RAYTRACER_VEC3_PACKED)
+    if (!std::is_constant_evaluated()) {
+        return Vec3Pack::store(Vec3Pack::subtract(Vec3Pack::load(lhs), Vec3Pack::load(rhs)));
+    }
+#endif
     return Vec3(lhs.x - rhs.x, lhs.y - rhs.y, lhs.z - rhs.z);
 }
 
 inline constexpr Vec3 operator/(const Vec3& lhs, float rhs) {
+#if defined(RAYTRACER_VEC3_PACKED)
+    if (!std::is_constant_evaluated()) {
+        return Vec3Pack::store(Vec3Pack::divide(Vec3Pack::load(lhs), Vec3Pack::broadcast(rhs)));
+    }
+#endif
     return Vec3(lhs.x / rhs, lhs.y / rhs, lhs.z / rhs);
 }
 
 inline constexpr Vec3 operator*(const Vec3& lhs, float rhs) {
+#if defined(RAYTRACER_VEC3_PACKED)
+    if (!std::is_constant_evaluated()) {
+        return Vec3Pack::store(Vec3Pack::multiply(Vec3Pack::load(lhs), Vec3Pack::broadcast(rhs)));
+    }
+#endif
     return Vec3(lhs.x * rhs, lhs.y * rhs, lhs.z * rhs);
 }
 
 inline constexpr Vec3 operator*(float lhs, const Vec3& rhs) {
+#if defined(RAYTRACER_VEC3_PACKED)
+    if (!std::is_constant_evaluated()) {
+        return Vec3Pack::store(Vec3Pack::multiply(Vec3Pack::broadcast(lhs), Vec3Pack::load(rhs)));
+    }
+#endif
     return Vec3(lhs * rhs.x, lhs * rhs.y, lhs * rhs.z);
 }
 
+inline constexpr Vec3& Vec3::operator+=(const Vec3& rhs) {
+    return *this = *this + rhs;
+}
+
+inline constexpr Vec3& Vec3::operator-=(const Vec3& rhs) {
+    return *this = *this - rhs;
+}
+
+inline constexpr Vec3& Vec3::operator*=(float rhs) {
+    return *this = *this * rhs;
+}
+
+inline constexpr Vec3& Vec3::operator/=(float rhs) {
+    return *this = *this / rhs;
+}
+
 inline std::ostream& operator<<(std::ostream& os, const Vec3& vec) {
     os << vec.x << "," << vec.y << "," << vec.z;
     return os;
@@ -233,6 +375,25 @@ namespace Math {
         return a >= b ? a : b;
     }
 
+    // component-wise min/max
+    inline constexpr Vec3 min(const Vec3& a, const Vec3& b) {
+#if defined(RAYTRACER_VEC3_PACKED)
+        if (!std::is_constant_evaluated()) {
+            return Vec3Pack::store(Vec3Pack::min(Vec3Pack::load(a), Vec3Pack::load(b)));
+        }
+#endif
+        return Vec3(min(a.x, b.x), min(a.y, b.y), min(a.z, b.z));
+    }
+
+    inline constexpr Vec3 max(const Vec3& a, const Vec3& b) {
+#if defined(RAYTRACER_VEC3_PACKED)
+        if (!std::is_constant_evaluated()) {
+            return Vec3Pack::store(Vec3Pack::max(Vec3Pack::load(a), Vec3Pack::load(b)));
+        }
+#endif
+        return Vec3(max(a.x, b.x), max(a.y, b.y), max(a.z, b.z));
+    }
+
     inline float roundToNearestInt(float a) {
         return std::round(a);
     }
@@ -294,6 +455,16 @@ namespace Math {
 
 
     inline constexpr Vec3 cross(const Vec3& lhs, const Vec3& rhs) {
+#if defined(RAYTRACER_VEC3_PACKED)
+        // [x, y, z] * [y, z, x] - [y, z, x] * [x, y, z] gives the cross product's [z, x, y]
+        if (!std::is_constant_evaluated()) {
+            const Vec3Pack::Register a = Vec3Pack::load(lhs);
+            const Vec3Pack::Register b = Vec3Pack::load(rhs);
+            const Vec3Pack::Register rotated = Vec3Pack::subtract(
+                Vec3Pack::multiply(a, Vec3Pack::rotate(b)), Vec3Pack::multiply(Vec3Pack::rotate(a), b));
+            return Vec3Pack::store(Vec3Pack::rotate(rotated));
+        }
+#endif
         return Vec3( (lhs.y * rhs.z - lhs.z * rhs.y),
                     -(lhs.x * rhs.z - lhs.z * rhs.x),
                      (lhs.x * rhs.y - lhs.y * rhs.x));
@@ -304,6 +475,11 @@ namespace Math {
     }
 
     inline constexpr float dot(const Vec3& lhs, const Vec3& rhs) {
+#if defined(RAYTRACER_VEC3_PACKED)
+        if (!std::is_constant_evaluated()) {
+            return Vec3Pack::sum(Vec3Pack::multiply(Vec3Pack::load(lhs), Vec3Pack::load(rhs)));
+        }
+#endif
         return lhs.x * rhs.x + lhs.y * rhs.y + lhs.z * rhs.z;
     }
 
@@ -313,6 +489,11 @@ namespace Math {
     }
 
     inline constexpr float magnitudeSquared(const Vec3& vec) {
+#if defined(RAYTRACER_VEC3_PACKED)
+        if (!std::is_constant_evaluated()) {
+            return Math::dot(vec, vec);
+        }
+#endif
         return vec.x * vec.x + vec.y * vec.y + vec.z * vec.z;
     }
 
@@ -329,7 +510,11 @@ namespace Math {
     }
 
     inline Vec3 normalize(const Vec3& vec) {
+#if defined(RAYTRACER_VEC3_PACKED)
+        return vec * Vec3Pack::reciprocalSquareRoot(Math::magnitudeSquared(vec));
+#else
         return vec / Math::magnitude(vec);
+#endif
     }
 
     inline Vec2 direction(const Vec2& from, const Vec2& to) {
@@ -354,6 +539,12 @@ namespace Math {
     }
 
     inline constexpr Vec3 reflect(const Vec3& inDirection, const Vec3& inNormal) {
+#if defined(RAYTRACER_VEC3_PACKED)
+        if (!std::is_constant_evaluated()) {
+            const Vec3Pack::Register scale = Vec3Pack::broadcast(2.00f * Math::dot(inDirection, inNormal));
+            return Vec3Pack::store(Vec3Pack::negativeMultiplyAdd(scale, Vec3Pack::load(inNormal), Vec3Pack::load(inDirection)));
+        }
+#endif
         return inDirection - (2.00f * Math::dot(inDirection, inNormal) * inNormal);
     }
 
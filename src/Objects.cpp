@@ -28,7 +28,7 @@ Sphere::Sphere(const Vec3& center, float radius, const Material& material)
 //
 // t_intersect = -b +/- sqrt(b^2 - 4*a*c)
 //
-bool Sphere::intersect(const Ray& ray, Intersection& result) const {
+bool Sphere::intersect(const Ray& ray, float& tClosest, uint32_t& part) const {
     const Vec3 L = ray.origin - this->position_;
     // const float a = Math::dot(ray.direction, ray.direction); a == 1.0
     const float b = 2.0f * Math::dot(ray.direction, L);
@@ -39,7 +39,7 @@ bool Sphere::intersect(const Ray& ray, Intersection& result) const {
         return false;
     }
 
-    // we have an intersection, calculate our t, and plug it in to find our normal/intersect-point
+    // we have an intersection, calculate our t, leaving normal/intersect-point until we know it's the closest hit
     float t1, t2;
     if (Math::isApproximately(discriminant, 0.00f)) {
         t1 = t2 = -b / 2.0f;
@@ -53,21 +53,53 @@ bool Sphere::intersect(const Ray& ray, Intersection& result) const {
         return false;
     }
 
+    float t;
     if (t1 < 0.00f) {
-        result.t = t2;
+        t = t2;
     }
     else if (t2 < 0.00f) {
-        result.t = t1;
+        t = t1;
     }
     else {
-        result.t = std::min(t1, t2);
+        t = std::min(t1, t2);
     }
 
-    result.point  = ray.origin + ray.direction * result.t;
+    if (t >= tClosest) {
+        return false;
+    }
+    tClosest = t;
+    part     = 0;
+    return true;
+}
+
+void Sphere::finalizeIntersection(const Ray& ray, float t, uint32_t /*part*/, Intersection& result) const {
+    result.t      = t;
+    result.point  = ray.origin + ray.direction * t;
     result.normal = Math::direction(this->position_, result.point);
     result.object = this;
+}
 
-    return true;
+// any-hit variant of intersect for shadow rays, which only checks if the nearest non-negative root lies before tMax
+// note: using half of b (as a == 1) simplifies the roots to t = -b/2 +/- sqrt((b/2)^2 - c)
+bool Sphere::occluded(const Ray& ray, float tMax) const {
+    const Vec3 L = ray.origin - this->position_;
+    const float halfB = Math::dot(ray.direction, L);
+    const float c = Math::dot(L, L) - Math::square(this->radius_);
+    const float quarterDiscriminant = Math::square(halfB) - c;
+    if (quarterDiscriminant < 0.00f) {
+        return false;
+    }
+
+    const float sqrtOfDiscriminant = Math::squareRoot(quarterDiscriminant);
+    const float tNear = -halfB - sqrtOfDiscriminant;
+    const float tFar  = -halfB + sqrtOfDiscriminant;
+    const float t = tNear >= 0.00f ? tNear : tFar;
+    return t >= 0.00f && t < tMax;
+}
+
+AABB Sphere::bounds() const {
+    const Vec3 extent{ radius_, radius_, radius_ };
+    return AABB(center_ - extent, center_ + extent);
 }
 
 std::string Sphere::description() const {
@@ -116,23 +148,38 @@ Triangle::Triangle(const Vec3& vert0, const Vec3& vert1, const Vec3& vert2, cons
 // given ray intersects triangle IFF given ray [X(t) = P + tD] intersects the plane [P.n = k] in a way such that
 // our intersection point is always to the LEFT side of EVERY edge
 // (aka our plane intersection point @[t = (k  P.n)/(D.n)] lies in between our triangle vertices)
-bool Triangle::intersect(const Ray& ray, Intersection& result) const {
+bool Triangle::intersect(const Ray& ray, float& tClosest, uint32_t& part) const {
     const float k = Math::dot(vert0_, planeNormal_);
     const float t = (k - Math::dot(ray.origin, planeNormal_)) / Math::dot(ray.direction, planeNormal_);
-    if (t < 0.0f) {
+    if (t < 0.0f || t >= tClosest) {
         return false;
     }
-    const Vec3 pointIntersectingPlane = ray.origin + ray.direction * t;
-    if (contains(pointIntersectingPlane)) {
-        result.t      = t;
-        result.point  = pointIntersectingPlane;
-        result.normal = planeNormal_;
-        result.object = this;
+    if (contains(ray.origin + ray.direction * t)) {
+        tClosest = t;
+        part     = 0;
         return true;
     }
     return false;
 }
 
+void Triangle::finalizeIntersection(const Ray& ray, float t, uint32_t /*part*/, Intersection& result) const {
+    result.t      = t;
+    result.point  = ray.origin + ray.direction * t;
+    result.normal = planeNormal_;
+    result.object = this;
+}
+
+// any-hit variant of intersect for shadow rays, skipping computation of the hit record
+bool Triangle::occluded(const Ray& ray, float tMax) const {
+    const float k = Math::dot(vert0_, planeNormal_);
+    const float t = (k - Math::dot(ray.origin, planeNormal_)) / Math::dot(ray.direction, planeNormal_);
+    return t >= 0.0f && t < tMax && contains(ray.origin + ray.direction * t);
+}
+
+AABB Triangle::bounds() const {
+    return AABB().expand(vert0_).expand(vert1_).expand(vert2_);
+}
+
 std::string Triangle::description() const {
     std::stringstream ss;
     ss << "Triangle("
@@ -2,15 +2,26 @@
 #include "Math.hpp"
 #include "Material.hpp"
 #include "Ray.hpp"
+#include "AABB.hpp"
+#include <cstdint>
 
 
 // virtual base class for ANY renderable (via ray-tracing) object in a scene
+//
+// intersection is split into a cheap search for the closest hit distance (and part of the object hit, such as the
+// triangle of a mesh), and a finalize step that builds the rest of the hit record for only the hit that ends up closest
 class IObject {
 public:
     virtual ~IObject() = default;
-    virtual bool intersect(const Ray& ray, Intersection& result) const = 0;
+    // closest hit before tClosest, on a hit shrinking tClosest to its distance and setting the part of the object hit
+    virtual bool intersect(const Ray& ray, float& tClosest, uint32_t& part) const = 0;
+    virtual void finalizeIntersection(const Ray& ray, float t, uint32_t part, Intersection& result) const = 0;
+    virtual bool occluded(const Ray& ray, float tMax) const = 0;
+    virtual AABB bounds() const = 0;
     virtual std::string description() const = 0;
     
+    bool intersect(const Ray& ray, Intersection& result) const;
+
     constexpr const Vec3&     position() const { return position_; }
     constexpr const Material& material() const { return material_; }
 
@@ -18,6 +29,15 @@ protected:
     Vec3     position_{};
     Material material_{};
 };
+inline bool IObject::intersect(const Ray& ray, Intersection& result) const {
+    float t = Math::INF;
+    uint32_t part = Intersection::NO_INDEX;
+    if (!intersect(ray, t, part)) {
+        return false;
+    }
+    finalizeIntersection(ray, t, part, result);
+    return true;
+}
 inline std::ostream& operator<<(std::ostream& os, const IObject& object) {
     os << object.description();
     return os;
@@ -29,7 +49,11 @@ class Sphere final : public virtual IObject {
 public:
     Sphere(const Vec3& center, float radius, const Material& material);
 
-    virtual bool intersect(const Ray& ray, Intersection& result) const override;
+    using IObject::intersect;
+    virtual bool intersect(const Ray& ray, float& tClosest, uint32_t& part) const override;
+    virtual void finalizeIntersection(const Ray& ray, float t, uint32_t part, Intersection& result) const override;
+    virtual bool occluded(const Ray& ray, float tMax) const override;
+    virtual AABB bounds() const override;
     virtual std::string description() const override;
 
     bool contains(const Vec3& point) const;
@@ -48,7 +72,11 @@ class Triangle final : public virtual IObject {
 public:
     Triangle(const Vec3& vert0, const Vec3& vert1, const Vec3& vert2, const Material& material);
     
-    virtual bool intersect(const Ray& ray, Intersection& result) const override;
+    using IObject::intersect;
+    virtual bool intersect(const Ray& ray, float& tClosest, uint32_t& part) const override;
+    virtual void finalizeIntersection(const Ray& ray, float t, uint32_t part, Intersection& result) const override;
+    virtual bool occluded(const Ray& ray, float tMax) const override;
+    virtual AABB bounds() const override;
     virtual std::string description() const override;
 
     bool contains(const Vec3& point) const;
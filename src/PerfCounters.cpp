@@ -0,0 +1,162 @@
+#include "PerfCounters.hpp"
+#include <string>
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+#include <optional>
+#include <cstdint>
+
+#ifdef __linux__
+    #include <linux/perf_event.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+    #include <cstring>
+#endif
+
+
+std::optional<double> PerfCounts::instructionsPerCycle() const {
+    if (!cycles || !instructions || *cycles == 0) {
+        return std::nullopt;
+    }
+    return static_cast<double>(*instructions) / static_cast<double>(*cycles);
+}
+
+bool PerfCounts::isEmpty() const {
+    return !cycles && !instructions && !l1DataMisses && !lastLevelCacheMisses && !branchMisses;
+}
+
+PerfCounts operator-(const PerfCounts& lhs, const PerfCounts& rhs) {
+    auto difference = [](const std::optional<uint64_t>& a, const std::optional<uint64_t>& b) -> std::optional<uint64_t> {
+        if (!a || !b) {
+            return std::nullopt;
+        }
+        return *a >= *b ? *a - *b : 0;  // scaled readings can dip slightly as multiplexing ratios shift
+    };
+    return PerfCounts{
+        difference(lhs.cycles,               rhs.cycles),
+        difference(lhs.instructions,         rhs.instructions),
+        difference(lhs.l1DataMisses,         rhs.l1DataMisses),
+        difference(lhs.lastLevelCacheMisses, rhs.lastLevelCacheMisses),
+        difference(lhs.branchMisses,         rhs.branchMisses),
+    };
+}
+
+std::ostream& operator<<(std::ostream& os, const PerfCounts& perfCounts) {
+    auto format = [](const auto& value) -> std::string {
+        if (!value) {
+            return "n/a";
+        }
+        std::ostringstream text;
+        text << std::setprecision(3) << *value;
+        return text.str();
+    };
+    os << "PerfCounts("
+         << "cycles:"        << format(perfCounts.cycles)                 << ","
+         << "instructions:"  << format(perfCounts.instructions)           << ","
+         << "ipc:"           << format(perfCounts.instructionsPerCycle()) << ","
+         << "l1d-misses:"    << format(perfCounts.l1DataMisses)           << ","
+         << "llc-misses:"    << format(perfCounts.lastLevelCacheMisses)   << ","
+         << "branch-misses:" << format(perfCounts.branchMisses)
+       << ")";
+    return os;
+}
+
+
+#ifdef __linux__
+
+namespace {
+
+    struct PerfEventType {
+        uint32_t type;
+        uint64_t config;
+    };
+
+    // in the same order as the fields of `PerfCounts`
+    constexpr PerfEventType PERF_EVENT_TYPES[] = {
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+        { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+    };
+
+    // counter for the calling thread and any it creates later on, counting user space only so it works under the
+    // default paranoia level, or -1 if the event can't be counted here
+    int openPerfEvent(const PerfEventType& eventType) {
+        perf_event_attr attributes;
+        std::memset(&attributes, 0, sizeof(attributes));
+        attributes.size           = sizeof(attributes);
+        attributes.type           = eventType.type;
+        attributes.config         = eventType.config;
+        attributes.read_format    = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        attributes.inherit        = 1;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv     = 1;
+        return static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0));
+    }
+
+    std::optional<uint64_t> readPerfEvent(int fileDescriptor) {
+        if (fileDescriptor < 0) {
+            return std::nullopt;
+        }
+        uint64_t values[3];  // value, time enabled, time running
+        if (::read(fileDescriptor, values, sizeof(values)) != static_cast<ssize_t>(sizeof(values)) || values[2] == 0) {
+            return std::nullopt;
+        }
+        if (values[2] == values[1]) {
+            return values[0];
+        }
+        return static_cast<uint64_t>(static_cast<double>(values[0]) * values[1] / values[2]);
+    }
+}
+
+PerfCounters::PerfCounters() {
+    static_assert(sizeof(PERF_EVENT_TYPES) / sizeof(PERF_EVENT_TYPES[0]) == NUM_EVENTS);
+    for (size_t i = 0; i < NUM_EVENTS; i++) {
+        fileDescriptors_[i] = openPerfEvent(PERF_EVENT_TYPES[i]);
+    }
+}
+
+PerfCounters::~PerfCounters() {
+    for (int fileDescriptor : fileDescriptors_) {
+        if (fileDescriptor >= 0) {
+            close(fileDescriptor);
+        }
+    }
+}
+
+PerfCounts PerfCounters::read() const {
+    return PerfCounts{
+        readPerfEvent(fileDescriptors_[0]),
+        readPerfEvent(fileDescriptors_[1]),
+        readPerfEvent(fileDescriptors_[2]),
+        readPerfEvent(fileDescriptors_[3]),
+        readPerfEvent(fileDescriptors_[4]),
+    };
+}
+
+#else
+
+PerfCounters::PerfCounters() {
+    for (size_t i = 0; i < NUM_EVENTS; i++) {
+        fileDescriptors_[i] = -1;
+    }
+}
+
+PerfCounters::~PerfCounters() {}
+
+PerfCounts PerfCounters::read() const {
+    return PerfCounts{};
+}
+
+#endif
+
+
+bool PerfCounters::isAvailable() const {
+    for (int fileDescriptor : fileDescriptors_) {
+        if (fileDescriptor >= 0) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <iostream>
+#include <optional>
+#include <cstdint>
+
+
+// hardware event counts over some interval, with events the machine couldn't count left empty
+struct PerfCounts {
+    std::optional<uint64_t> cycles;
+    std::optional<uint64_t> instructions;
+    std::optional<uint64_t> l1DataMisses;
+    std::optional<uint64_t> lastLevelCacheMisses;
+    std::optional<uint64_t> branchMisses;
+
+    // instructions retired per cycle, if both were counted
+    std::optional<double> instructionsPerCycle() const;
+
+    bool isEmpty() const;
+};
+
+// counts accumulated between two readings of the same counters
+PerfCounts operator-(const PerfCounts& lhs, const PerfCounts& rhs);
+
+std::ostream& operator<<(std::ostream& os, const PerfCounts& perfCounts);
+
+
+/*
+Hardware performance counters for this process, for telling whether tracing is bound by cache misses, branch
+mispredictions or compute, which wall time alone can't.
+
+On linux, each event is opened with `perf_event_open` as its own counter that's inherited by threads created
+afterwards, so counters opened before a thread pool is spun up also count everything its workers do. Readings are
+scaled up by how long each counter was actually scheduled, since the kernel multiplexes them when there are more
+events than hardware counters.
+
+Counting degrades gracefully, as counters are commonly unavailable (e.g. under `perf_event_paranoid` restrictions,
+in containers and virtual machines, or on other platforms). Any event that can't be opened is simply left empty in
+every reading, without error.
+*/
+class PerfCounters {
+public:
+    PerfCounters(const PerfCounters&)            = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    PerfCounters();
+    ~PerfCounters();
+
+    // whether at least one event could be opened
+    bool isAvailable() const;
+
+    // counts since the counters were opened
+    PerfCounts read() const;
+
+private:
+    static constexpr size_t NUM_EVENTS = 5;
+
+    int fileDescriptors_[NUM_EVENTS];
+};
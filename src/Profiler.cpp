@@ -0,0 +1,193 @@
+#include "Profiler.hpp"
+#include "StopWatch.hpp"
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+#include <stdexcept>
+#include <filesystem>
+
+
+namespace {
+
+    static_assert((Profiler::EVENTS_PER_THREAD & (Profiler::EVENTS_PER_THREAD - 1)) == 0,
+                  "events per thread must be a power of two");
+
+    // fields are relaxed atomics, as an export may read a slot while its owning thread overwrites it, with the cursor
+    // telling the export which of the slots it read can be trusted
+    struct EventSlot {
+        std::atomic<const char*> name{ nullptr };
+        std::atomic<double>      startTime{ 0.00 };
+        std::atomic<double>      stopTime{ 0.00 };
+
+        void store(const ProfileEvent& event) {
+            name     .store(event.name,      std::memory_order_relaxed);
+            startTime.store(event.startTime, std::memory_order_relaxed);
+            stopTime .store(event.stopTime,  std::memory_order_relaxed);
+        }
+
+        ProfileEvent load() const {
+            return ProfileEvent{ name     .load(std::memory_order_relaxed),
+                                 startTime.load(std::memory_order_relaxed),
+                                 stopTime .load(std::memory_order_relaxed) };
+        }
+    };
+
+    // single producer ring buffer, written only by its owning thread
+    struct alignas(64) ThreadEvents {
+        size_t                       threadIndex;
+        std::atomic<uint64_t>        numRecorded{ 0 };
+        std::unique_ptr<EventSlot[]> events;
+
+        explicit ThreadEvents(size_t threadIndex)
+            : threadIndex(threadIndex),
+              events     (std::make_unique<EventSlot[]>(Profiler::EVENTS_PER_THREAD)) {}
+    };
+
+    // buffers live as long as the process, so threads that have exited still show up in later exports
+    struct ProfilerState {
+        std::atomic<bool>                          isEnabled{ false };
+        double                                     epoch{ 0.00 };
+        std::mutex                                 mutex;
+        std::vector<std::unique_ptr<ThreadEvents>> threads;
+    };
+
+    ProfilerState& state() {
+        static ProfilerState profilerState;
+        return profilerState;
+    }
+
+    ThreadEvents& eventsForThisThread() {
+        thread_local ThreadEvents* threadEvents = nullptr;
+        if (threadEvents == nullptr) {
+            ProfilerState& profiler = state();
+            std::lock_guard<std::mutex> lock(profiler.mutex);
+            profiler.threads.push_back(std::make_unique<ThreadEvents>(profiler.threads.size()));
+            threadEvents = profiler.threads.back().get();
+        }
+        return *threadEvents;
+    }
+
+    // copy out the events still held by given buffer, oldest first, skipping any overwritten while copying
+    // a record still in progress may already be writing the slot one lap behind it, so that slot is skipped as well,
+    // with the fence keeping the copies ahead of the second load of the cursor
+    std::vector<ProfileEvent> snapshot(const ThreadEvents& threadEvents) {
+        constexpr uint64_t mask = Profiler::EVENTS_PER_THREAD - 1;
+        const uint64_t end   = threadEvents.numRecorded.load(std::memory_order_acquire);
+        const uint64_t begin = end > Profiler::EVENTS_PER_THREAD ? end - Profiler::EVENTS_PER_THREAD : 0;
+        std::vector<ProfileEvent> events;
+        events.reserve(end - begin);
+        for (uint64_t index = begin; index < end; index++) {
+            events.push_back(threadEvents.events[index & mask].load());
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const uint64_t endInFlight = threadEvents.numRecorded.load(std::memory_order_relaxed) + 1;  // counting a record in progress
+        const uint64_t firstIntact = endInFlight > Profiler::EVENTS_PER_THREAD ? endInFlight - Profiler::EVENTS_PER_THREAD : 0;
+        const uint64_t numOverwritten = std::min<uint64_t>(events.size(), firstIntact > begin ? firstIntact - begin : 0);
+        events.erase(events.begin(), events.begin() + numOverwritten);
+        return events;
+    }
+
+    // names come from string literals in our own source, but escape them anyway so the output is always valid json
+    void writeJsonString(std::ostream& os, const char* text) {
+        os << '"';
+        for (const char* c = text; *c != '\0'; c++) {
+            if (*c == '"' || *c == '\\') {
+                os << '\\' << *c;
+            } else if (static_cast<unsigned char>(*c) < 0x20) {
+                os << ' ';
+            } else {
+                os << *c;
+            }
+        }
+        os << '"';
+    }
+}
+
+
+void Profiler::setEnabled(bool isEnabled) {
+    ProfilerState& profiler = state();
+    {
+        std::lock_guard<std::mutex> lock(profiler.mutex);
+        if (isEnabled && profiler.epoch == 0.00) {
+            profiler.epoch = StopWatch::currentTime();
+        }
+    }
+    profiler.isEnabled.store(isEnabled, std::memory_order_relaxed);
+}
+
+bool Profiler::isEnabled() {
+    return state().isEnabled.load(std::memory_order_relaxed);
+}
+
+void Profiler::record(const ProfileEvent& event) {
+    ThreadEvents& threadEvents = eventsForThisThread();
+    const uint64_t index = threadEvents.numRecorded.load(std::memory_order_relaxed);
+    threadEvents.events[index & (EVENTS_PER_THREAD - 1)].store(event);
+    threadEvents.numRecorded.store(index + 1, std::memory_order_release);
+}
+
+size_t Profiler::numEvents() {
+    ProfilerState& profiler = state();
+    std::lock_guard<std::mutex> lock(profiler.mutex);
+    size_t count = 0;
+    for (const std::unique_ptr<ThreadEvents>& threadEvents : profiler.threads) {
+        count += std::min<uint64_t>(threadEvents->numRecorded.load(std::memory_order_acquire), EVENTS_PER_THREAD);
+    }
+    return count;
+}
+
+// complete ("X") events in microseconds, one track per thread, plus a metadata event naming each track
+void Profiler::writeChromeTrace(std::ostream& os) {
+    ProfilerState& profiler = state();
+    std::lock_guard<std::mutex> lock(profiler.mutex);
+
+    const std::ios::fmtflags flags = os.flags();
+    os << std::fixed << std::setprecision(3);
+    os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool isFirst = true;
+    for (const std::unique_ptr<ThreadEvents>& threadEvents : profiler.threads) {
+        os << (isFirst ? "\n" : ",\n");
+        isFirst = false;
+        os << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << threadEvents->threadIndex
+           << ",\"args\":{\"name\":\"thread " << threadEvents->threadIndex << "\"}}";
+
+        for (const ProfileEvent& event : snapshot(*threadEvents)) {
+            os << ",\n{\"name\":";
+            writeJsonString(os, event.name);
+            os << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << threadEvents->threadIndex
+               << ",\"ts\":"  << (event.startTime - profiler.epoch) * 1e6
+               << ",\"dur\":" << (event.stopTime - event.startTime) * 1e6 << "}";
+        }
+    }
+    os << "\n]}\n";
+    os.flags(flags);
+}
+
+void Profiler::writeChromeTrace(const std::string& filepath) {
+    if (std::filesystem::path(filepath).extension() != ".json") {
+        throw std::runtime_error("Cannot write file \'" + filepath + "\' - does not end with .json");
+    }
+    std::ofstream ofs(filepath, std::ios::out);
+    if (!ofs) {
+        throw std::runtime_error("Cannot write file \'" + filepath + "\' - error while opening for write");
+    }
+    writeChromeTrace(ofs);
+}
+
+
+// zones opened while profiling is disabled are never recorded, even if it's enabled before they close
+ProfileZone::ProfileZone(const char* name)
+    : name_     (Profiler::isEnabled() ? name : nullptr),
+      startTime_(name_ != nullptr ? StopWatch::currentTime() : 0.00) {}
+
+ProfileZone::~ProfileZone() {
+    if (name_ != nullptr) {
+        Profiler::record(ProfileEvent{ name_, startTime_, StopWatch::currentTime() });
+    }
+}
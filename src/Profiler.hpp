@@ -0,0 +1,58 @@
+#pragma once
+#include <string>
+#include <iostream>
+#include <cstdint>
+
+
+// a timed interval on one thread, named by a string literal (or any other string outliving the profiler)
+struct ProfileEvent {
+    const char* name;
+    double      startTime;
+    double      stopTime;
+};
+
+
+/*
+Process wide recorder of nested, named timing zones, for seeing serial phases and imbalance between threads.
+
+Each thread records into its own fixed size ring buffer, registered on the thread's first zone. Recording is lock
+free and allocation free (a relaxed load of the write cursor, relaxed stores of the event and a release store of the
+cursor), and once a buffer wraps around the oldest events are overwritten. Zones nest naturally, since each is
+recorded as a complete interval, and show up as flame graph like stacks when the export is opened in
+`chrome://tracing` or Perfetto.
+
+Profiling is disabled by default, in which case zones skip timing altogether, costing only a check of a flag.
+Exports can run concurrently with recording, at worst dropping events that were overwritten while being copied. Once
+a buffer has wrapped around, exports also leave out its oldest slot, as the next record may be overwriting it.
+*/
+class Profiler {
+public:
+    static constexpr size_t EVENTS_PER_THREAD = size_t(1) << 16;
+
+    static void setEnabled(bool isEnabled);
+    static bool isEnabled();
+
+    static void record(const ProfileEvent& event);
+
+    // number of events currently held across every thread's buffer
+    static size_t numEvents();
+
+    // events as chrome trace event json, with timestamps relative to when profiling was first enabled
+    static void writeChromeTrace(std::ostream& os);
+    static void writeChromeTrace(const std::string& filepath);
+};
+
+
+// times the enclosing scope, recording it as a zone on destruction when profiling is enabled
+class ProfileZone {
+public:
+    ProfileZone(const ProfileZone&)            = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+
+    explicit ProfileZone(const char* name);
+    ~ProfileZone();
+
+private:
+    const char* name_;
+    double      startTime_;
+};
@@ -0,0 +1,87 @@
+#pragma once
+#include "Math.hpp"
+#include "Color.hpp"
+#include <iostream>
+
+
+/*
+Linear rgb radiance, unbounded in either direction, for tracing and accumulating samples.
+
+Unlike `Color`, which clamps every component into [0, 1] on each construction, assignment and arithmetic operation,
+radiance is a plain triple of floats with branch free component-wise arithmetic that compilers readily vectorize,
+and can hold the sum of several bright contributions without saturating. It is clamped back into a displayable
+`Color` only once, when written out.
+*/
+struct Radiance {
+    float r;
+    float g;
+    float b;
+
+    Radiance() = default;
+    constexpr Radiance(float r, float g, float b) noexcept : r(r), g(g), b(b) {}
+    constexpr Radiance(const Color& color)        noexcept : r(color.r), g(color.g), b(color.b) {}
+
+    static constexpr Radiance zero() { return Radiance(0.00f, 0.00f, 0.00f); }
+
+    // displayable color, with each component clamped into [0, 1]
+    constexpr Color toColor() const { return Color(r, g, b); }
+
+    inline constexpr Radiance& operator+=(const Radiance& rhs) {
+        r += rhs.r; g += rhs.g; b += rhs.b;
+        return *this;
+    }
+
+    inline constexpr Radiance& operator-=(const Radiance& rhs) {
+        r -= rhs.r; g -= rhs.g; b -= rhs.b;
+        return *this;
+    }
+
+    inline constexpr Radiance& operator*=(const Radiance& rhs) {
+        r *= rhs.r; g *= rhs.g; b *= rhs.b;
+        return *this;
+    }
+
+    inline constexpr Radiance& operator*=(float rhs) {
+        r *= rhs; g *= rhs; b *= rhs;
+        return *this;
+    }
+
+    inline constexpr Radiance& operator/=(float rhs) {
+        r /= rhs; g /= rhs; b /= rhs;
+        return *this;
+    }
+};
+
+inline constexpr Radiance operator+(const Radiance& lhs, const Radiance& rhs) {
+    return Radiance(lhs.r + rhs.r, lhs.g + rhs.g, lhs.b + rhs.b);
+}
+
+inline constexpr Radiance operator-(const Radiance& lhs, const Radiance& rhs) {
+    return Radiance(lhs.r - rhs.r, lhs.g - rhs.g, lhs.b - rhs.b);
+}
+
+inline constexpr Radiance operator*(const Radiance& lhs, const Radiance& rhs) {
+    return Radiance(lhs.r * rhs.r, lhs.g * rhs.g, lhs.b * rhs.b);
+}
+
+inline constexpr Radiance operator*(float lhs, const Radiance& rhs) {
+    return Radiance(lhs * rhs.r, lhs * rhs.g, lhs * rhs.b);
+}
+
+inline constexpr Radiance operator*(const Radiance& lhs, float rhs) {
+    return Radiance(lhs.r * rhs, lhs.g * rhs, lhs.b * rhs);
+}
+
+inline constexpr Radiance operator/(const Radiance& lhs, float rhs) {
+    return Radiance(lhs.r / rhs, lhs.g / rhs, lhs.b / rhs);
+}
+
+// radiance with any negative components raised to zero
+inline constexpr Radiance nonNegative(const Radiance& radiance) {
+    return Radiance(Math::max(0.00f, radiance.r), Math::max(0.00f, radiance.g), Math::max(0.00f, radiance.b));
+}
+
+inline std::ostream& operator<<(std::ostream& os, const Radiance& radiance) {
+    os << radiance.r << "," << radiance.g << "," << radiance.b;
+    return os;
+}
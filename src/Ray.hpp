@@ -1,5 +1,7 @@
 #pragma once
 #include "Math.hpp"
+#include <limits>
+#include <cstdint>
 
 
 // assumes direction is normalized
@@ -23,15 +25,21 @@ inline std::ostream& operator<<(std::ostream& os, const Ray& ray) {
 
 class IObject;
 
+// hit record, identifying the hit either by object (when tracing a scene's objects directly),
+// or by primitive and material index (when tracing a compiled scene)
 struct Intersection {
     Vec3 point;
     Vec3 normal;
     float t;
     const IObject* object;
+    uint32_t primitive;
+    uint32_t material;
+
+    static constexpr uint32_t NO_INDEX = std::numeric_limits<uint32_t>::max();
 
     constexpr Intersection() : Intersection(Vec3(), Vec3(), -1.00f, nullptr) {}
     constexpr Intersection(const Vec3& point, const Vec3& normal, float t, IObject* object) :
-        point (point), normal(normal), t(t), object(object) {}
+        point (point), normal(normal), t(t), object(object), primitive(NO_INDEX), material(NO_INDEX) {}
 };
 inline std::ostream& operator<<(std::ostream& os, const Intersection& intersectInfo) {
     os << "Intersection("
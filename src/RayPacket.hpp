@@ -0,0 +1,167 @@
+#pragma once
+#include "Math.hpp"
+#include "Ray.hpp"
+#include "AABB.hpp"
+#include "Simd.hpp"
+#include <cstddef>
+#include <cstdint>
+
+
+/*
+Group of up to eight coherent rays (such as primary rays through neighboring pixels, or shadow rays from their hits
+toward the same light), traversed through a bounding volume hierarchy together so that each node is fetched and
+decided on once for the whole group rather than once per ray.
+
+Boxes are slab tested against every lane a pack at a time. When all rays head the same way along each axis, that is
+preceded by a conservative test of the group as a whole: bounding the origins and reciprocal directions by intervals
+bounds every ray's slab distances at once, so boxes missed by all rays are culled for the cost of a single test.
+Lanes are selected by masks with lane 0 in the lowest bit, as with `Simd` masks.
+*/
+struct RayPacket {
+    static constexpr size_t SIZE = 8;
+    static_assert(SIZE % Simd::WIDTH == 0, "packets must split evenly into packs");
+
+    Ray      rays[SIZE];
+    uint32_t lanes;  // lanes holding one of the given rays
+
+    // given array holds SIZE rays, of which only those in the given lanes are traced
+    RayPacket(const Ray* packetRays, uint32_t activeLanes);
+
+    // lanes (out of the given ones) overlapping the box within [0, tMax] of their own, along with nearest entry of them
+    uint32_t intersect(const AABB& box, const float* tMax, uint32_t candidateLanes, float& tEntry) const;
+
+private:
+    alignas(32) float originX_[SIZE];
+    alignas(32) float originY_[SIZE];
+    alignas(32) float originZ_[SIZE];
+    alignas(32) float invDirectionX_[SIZE];
+    alignas(32) float invDirectionY_[SIZE];
+    alignas(32) float invDirectionZ_[SIZE];
+
+    // per axis bounds over all lanes, mirrored along axes the rays head down so reciprocal directions are positive
+    bool  hasIntervals_;
+    float axisSign_[3];
+    float minOrigin_[3];
+    float maxOrigin_[3];
+    float minInvDirection_[3];
+    float maxInvDirection_[3];
+
+    bool intervalMisses(const AABB& box) const;
+};
+
+
+
+inline RayPacket::RayPacket(const Ray* packetRays, uint32_t activeLanes)
+    : lanes(activeLanes & Simd::firstLanes(SIZE, SIZE)),
+      hasIntervals_(lanes != 0) {
+    // unused lanes repeat a used one, so whole packs can be tested without tripping over garbage values
+    const Ray& fallback = packetRays[lanes != 0 ? Simd::lowestLane(lanes) : 0];
+    for (size_t lane = 0; lane < SIZE; lane++) {
+        rays[lane] = ((lanes >> lane) & 1u) ? packetRays[lane] : fallback;
+        originX_[lane]       = rays[lane].origin.x;
+        originY_[lane]       = rays[lane].origin.y;
+        originZ_[lane]       = rays[lane].origin.z;
+        invDirectionX_[lane] = rays[lane].direction.x;
+        invDirectionY_[lane] = rays[lane].direction.y;
+        invDirectionZ_[lane] = rays[lane].direction.z;
+    }
+    using FloatN = Simd::FloatN;
+    const FloatN one = FloatN::broadcast(1.00f);
+    for (size_t i = 0; i < SIZE; i += FloatN::width) {
+        (one / FloatN::load(invDirectionX_ + i)).store(invDirectionX_ + i);
+        (one / FloatN::load(invDirectionY_ + i)).store(invDirectionY_ + i);
+        (one / FloatN::load(invDirectionZ_ + i)).store(invDirectionZ_ + i);
+    }
+
+    // intervals only hold while no ray runs parallel to or opposite of the others along an axis
+    const float* origins[3]       = { originX_,       originY_,       originZ_       };
+    const float* invDirections[3] = { invDirectionX_, invDirectionY_, invDirectionZ_ };
+    for (size_t axis = 0; axis < 3 && hasIntervals_; axis++) {
+        axisSign_[axis] = fallback.direction[axis] > 0.00f ? 1.00f : -1.00f;
+        minOrigin_[axis]       =  Math::INF;
+        maxOrigin_[axis]       = -Math::INF;
+        minInvDirection_[axis] =  Math::INF;
+        maxInvDirection_[axis] = -Math::INF;
+        for (uint32_t remaining = lanes; remaining != 0; remaining &= remaining - 1) {
+            const int lane = Simd::lowestLane(remaining);
+            const float invDirection = axisSign_[axis] * invDirections[axis][lane];
+            if (!(invDirection > 0.00f && invDirection < Math::INF)) {
+                hasIntervals_ = false;
+                break;
+            }
+            const float origin = axisSign_[axis] * origins[axis][lane];
+            minOrigin_[axis]       = Math::min(minOrigin_[axis], origin);
+            maxOrigin_[axis]       = Math::max(maxOrigin_[axis], origin);
+            minInvDirection_[axis] = Math::min(minInvDirection_[axis], invDirection);
+            maxInvDirection_[axis] = Math::max(maxInvDirection_[axis], invDirection);
+        }
+    }
+}
+
+// same slab test as `AABB::intersect`, so each lane accepts exactly the boxes its ray would on its own
+inline uint32_t RayPacket::intersect(const AABB& box, const float* tMax, uint32_t candidateLanes, float& tEntry) const {
+    using FloatN = Simd::FloatN;
+    if (hasIntervals_) {
+        if (intervalMisses(box)) {
+            return 0;
+        }
+    }
+
+    const FloatN zero = FloatN::broadcast(0.00f);
+    const FloatN minX = FloatN::broadcast(box.min.x);
+    const FloatN minY = FloatN::broadcast(box.min.y);
+    const FloatN minZ = FloatN::broadcast(box.min.z);
+    const FloatN maxX = FloatN::broadcast(box.max.x);
+    const FloatN maxY = FloatN::broadcast(box.max.y);
+    const FloatN maxZ = FloatN::broadcast(box.max.z);
+    uint32_t hits = 0;
+    tEntry = Math::INF;
+    for (size_t i = 0; i < SIZE; i += FloatN::width) {
+        const uint32_t packLanes = (candidateLanes >> i) & Simd::firstLanes(FloatN::width, FloatN::width);
+        if (packLanes == 0) {
+            continue;
+        }
+        const FloatN originX       = FloatN::load(originX_ + i);
+        const FloatN originY       = FloatN::load(originY_ + i);
+        const FloatN originZ       = FloatN::load(originZ_ + i);
+        const FloatN invDirectionX = FloatN::load(invDirectionX_ + i);
+        const FloatN invDirectionY = FloatN::load(invDirectionY_ + i);
+        const FloatN invDirectionZ = FloatN::load(invDirectionZ_ + i);
+        const FloatN tx0 = (minX - originX) * invDirectionX;
+        const FloatN tx1 = (maxX - originX) * invDirectionX;
+        const FloatN ty0 = (minY - originY) * invDirectionY;
+        const FloatN ty1 = (maxY - originY) * invDirectionY;
+        const FloatN tz0 = (minZ - originZ) * invDirectionZ;
+        const FloatN tz1 = (maxZ - originZ) * invDirectionZ;
+
+        const FloatN tNear = max(max(min(tx0, tx1), min(ty0, ty1)), max(min(tz0, tz1), zero));
+        const FloatN tFar  = min(min(max(tx0, tx1), max(ty0, ty1)), min(max(tz0, tz1), FloatN::load(tMax + i)));
+        const auto overlaps = tNear <= tFar;
+        const uint32_t packHits = overlaps.bits() & packLanes;
+        if (packHits != 0) {
+            hits |= packHits << i;
+            tEntry = Math::min(tEntry, select(overlaps, tNear, FloatN::broadcast(Math::INF)).horizontalMin());
+        }
+    }
+    return hits;
+}
+
+// interval arithmetic over the (mirrored) slabs, where the earliest any ray can enter a slab is at its near plane
+// from the farthest origin at the slowest direction, and the latest any ray can exit is at its far plane from
+// the nearest origin at the fastest direction (or vice versa for planes behind the origins)
+//
+// lanes' tMax are left to the per lane test, as gathering their maximum for every box costs more than it culls
+inline bool RayPacket::intervalMisses(const AABB& box) const {
+    float tNear = 0.00f;
+    float tFar  = Math::INF;
+    for (size_t axis = 0; axis < 3; axis++) {
+        const bool  isMirrored = axisSign_[axis] < 0.00f;
+        const float nearPlane  = isMirrored ? -box.max[axis] : box.min[axis];
+        const float farPlane   = isMirrored ? -box.min[axis] : box.max[axis];
+        const float toNear = nearPlane - maxOrigin_[axis];
+        const float toFar  = farPlane  - minOrigin_[axis];
+        tNear = Math::max(tNear, toNear * (toNear >= 0.00f ? minInvDirection_[axis] : maxInvDirection_[axis]));
+        tFar  = Math::min(tFar,  toFar  * (toFar  >= 0.00f ? maxInvDirection_[axis] : minInvDirection_[axis]));
+    }
+    return tNear > tFar;
+}
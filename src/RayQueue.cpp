@@ -0,0 +1,86 @@
+#include "RayQueue.hpp"
+#include "Math.hpp"
+#include "Ray.hpp"
+#include "AABB.hpp"
+#include <array>
+#include <utility>
+#include <cstdint>
+#include <assert.h>
+
+
+namespace {
+
+    constexpr uint32_t CELL_BITS      = 4;
+    constexpr uint32_t CELLS_PER_AXIS = 1u << CELL_BITS;
+    constexpr uint32_t DIGIT_BITS     = 8;
+    constexpr uint32_t KEY_BITS       = 3 + 3 * CELL_BITS;  // octant, then interleaved cell coordinates
+    static_assert(KEY_BITS <= 2 * DIGIT_BITS, "keys are sorted in two passes");
+
+    // spreads the lower bits of the value out to every third bit
+    uint32_t expandBits(uint32_t value) {
+        value = (value | (value << 8)) & 0x0000F00Fu;
+        value = (value | (value << 4)) & 0x000C30C3u;
+        value = (value | (value << 2)) & 0x00249249u;
+        return value;
+    }
+
+    uint32_t cellIndex(float position, float min, float scale) {
+        const float cell = (position - min) * scale;
+        return static_cast<uint32_t>(Math::clamp(cell, 0.00f, static_cast<float>(CELLS_PER_AXIS - 1)));
+    }
+
+    // stable counting sort of the entries by one digit of the key held in their upper half
+    void sortByDigit(const uint64_t* entries, uint64_t* sorted, size_t count, uint32_t shift) {
+        std::array<uint32_t, 1u << DIGIT_BITS> offsets{};
+        for (size_t i = 0; i < count; i++) {
+            offsets[(entries[i] >> (32 + shift)) & (offsets.size() - 1)]++;
+        }
+        uint32_t total = 0;
+        for (uint32_t& offset : offsets) {
+            const uint32_t digitCount = offset;
+            offset = total;
+            total += digitCount;
+        }
+        for (size_t i = 0; i < count; i++) {
+            sorted[offsets[(entries[i] >> (32 + shift)) & (offsets.size() - 1)]++] = entries[i];
+        }
+    }
+}
+
+
+// origins are binned into a coarse grid spanning just the queued rays, so the cells scale with however spread out
+// they are, and keys are few enough bits that a two pass radix sort orders them in linear time
+void RayQueue::sortByCoherence(RayQueue& scratch) {
+    assert(scratch.capacity() >= size_);
+    if (size_ < 2) {
+        return;
+    }
+
+    AABB bounds{};
+    for (size_t i = 0; i < size_; i++) {
+        bounds.expand(Vec3(originX_[i], originY_[i], originZ_[i]));
+    }
+    const Vec3 extent = bounds.extent();
+    auto scaleOf = [](float length) { return length > 0.00f ? CELLS_PER_AXIS / length : 0.00f; };
+    const Vec3 scale{ scaleOf(extent.x), scaleOf(extent.y), scaleOf(extent.z) };
+
+    for (size_t i = 0; i < size_; i++) {
+        const uint32_t octant = (directionX_[i] < 0.00f ? 1u : 0u) |
+                                (directionY_[i] < 0.00f ? 2u : 0u) |
+                                (directionZ_[i] < 0.00f ? 4u : 0u);
+        const uint32_t morton = (expandBits(cellIndex(originX_[i], bounds.min.x, scale.x)) << 2) |
+                                (expandBits(cellIndex(originY_[i], bounds.min.y, scale.y)) << 1) |
+                                (expandBits(cellIndex(originZ_[i], bounds.min.z, scale.z)));
+        const uint64_t key = (octant << (3 * CELL_BITS)) | morton;
+        sortKeys_[i] = (key << 32) | static_cast<uint64_t>(i);
+    }
+    sortByDigit(sortKeys_.data(),         scratch.sortKeys_.data(), size_, 0);
+    sortByDigit(scratch.sortKeys_.data(), sortKeys_.data(),         size_, DIGIT_BITS);
+
+    scratch.clear();
+    for (size_t k = 0; k < size_; k++) {
+        const size_t i = static_cast<size_t>(sortKeys_[k] & 0xFFFFFFFFu);
+        scratch.push(ray(i), path_[i], tMax_[i], ignorePrimitive_[i]);
+    }
+    std::swap(*this, scratch);
+}
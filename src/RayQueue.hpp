@@ -0,0 +1,71 @@
+#pragma once
+#include "Math.hpp"
+#include "Ray.hpp"
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <assert.h>
+
+
+/*
+Rays waiting on the same stage of a wavefront, stored as separate component arrays so each stage streams through
+them in order.
+
+Storage is allocated once up front for a fixed capacity and reused by each batch pushed after clearing, so tracing
+allocates nothing once started. Each ray carries the index of the path it extends, along with the distance to stop
+at and a primitive to skip (as shadow rays need, and which are otherwise unbounded and unset).
+
+Scattered rays (such as reflections) can be sorted for coherence, grouping them first by the octant they head into
+and then by the morton order of their origins, so that neighbors in the queue tend to traverse the same nodes.
+*/
+class RayQueue {
+public:
+    RayQueue() = default;
+    explicit RayQueue(size_t capacity)
+        : originX_(capacity), originY_(capacity), originZ_(capacity),
+          directionX_(capacity), directionY_(capacity), directionZ_(capacity),
+          tMax_(capacity), path_(capacity), ignorePrimitive_(capacity), sortKeys_(capacity), size_(0) {}
+
+    size_t size()     const { return size_; }
+    size_t capacity() const { return path_.size(); }
+    bool   isEmpty()  const { return size_ == 0; }
+    void   clear()          { size_ = 0; }
+
+    void push(const Ray& ray, uint32_t path, float tMax = Math::INF, uint32_t ignorePrimitive = Intersection::NO_INDEX) {
+        assert(size_ < capacity());
+        originX_        [size_] = ray.origin.x;
+        originY_        [size_] = ray.origin.y;
+        originZ_        [size_] = ray.origin.z;
+        directionX_     [size_] = ray.direction.x;
+        directionY_     [size_] = ray.direction.y;
+        directionZ_     [size_] = ray.direction.z;
+        tMax_           [size_] = tMax;
+        path_           [size_] = path;
+        ignorePrimitive_[size_] = ignorePrimitive;
+        size_++;
+    }
+
+    Ray ray(size_t index) const {
+        return Ray(Vec3(originX_[index], originY_[index], originZ_[index]),
+                   Vec3(directionX_[index], directionY_[index], directionZ_[index]));
+    }
+    float    tMax(size_t index)            const { return tMax_[index];            }
+    uint32_t path(size_t index)            const { return path_[index];            }
+    uint32_t ignorePrimitive(size_t index) const { return ignorePrimitive_[index]; }
+
+    // reorder rays by coherence, using the given queue (of at least this capacity) as scratch space
+    void sortByCoherence(RayQueue& scratch);
+
+private:
+    std::vector<float>    originX_;
+    std::vector<float>    originY_;
+    std::vector<float>    originZ_;
+    std::vector<float>    directionX_;
+    std::vector<float>    directionY_;
+    std::vector<float>    directionZ_;
+    std::vector<float>    tMax_;
+    std::vector<uint32_t> path_;
+    std::vector<uint32_t> ignorePrimitive_;
+    std::vector<uint64_t> sortKeys_;  // coherence key in the upper half, and index of the ray in the lower half
+    size_t                size_{ 0 };
+};
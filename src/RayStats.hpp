@@ -0,0 +1,79 @@
+#pragma once
+#include <iostream>
+#include <cstdint>
+
+
+/*
+Counts of the rays a render fires and the scene queries they make, for telling whether time goes into geometry,
+lights or bounce depth.
+
+Counting is opt in (configure with `-DRAYTRACER_ENABLE_RAY_STATS=ON`), since even uncontended increments on the
+innermost paths aren't free. When disabled, `increment` is an empty function that compiles away entirely, and every
+counter stays at zero.
+
+Each worker thread counts into its own copy (padded to a cache line, so neighbors never contend), and the copies are
+summed once the render finishes.
+*/
+struct RayStats {
+#ifdef RAYTRACER_RAY_STATS
+    static constexpr bool IS_ENABLED = true;
+#else
+    static constexpr bool IS_ENABLED = false;
+#endif
+
+    uint64_t primaryRays        { 0 };
+    uint64_t reflectionRays     { 0 };
+    uint64_t shadowRays         { 0 };
+    uint64_t occludedShadowRays { 0 };
+    uint64_t intersectionTests  { 0 };  // closest hit queries against the whole scene
+    uint64_t intersectionHits   { 0 };
+
+    static constexpr void increment(uint64_t& counter) {
+        if constexpr (IS_ENABLED) {
+            counter++;
+        }
+    }
+
+    constexpr void countPrimaryRay()    { increment(primaryRays);    }
+    constexpr void countReflectionRay() { increment(reflectionRays); }
+
+    constexpr void countShadowRay(bool isOccluded) {
+        increment(shadowRays);
+        if (isOccluded) {
+            increment(occludedShadowRays);
+        }
+    }
+
+    constexpr void countIntersectionTest(bool isHit) {
+        increment(intersectionTests);
+        if (isHit) {
+            increment(intersectionHits);
+        }
+    }
+
+    constexpr uint64_t totalRays() const {
+        return primaryRays + reflectionRays + shadowRays;
+    }
+
+    constexpr RayStats& operator+=(const RayStats& rhs) {
+        primaryRays        += rhs.primaryRays;
+        reflectionRays     += rhs.reflectionRays;
+        shadowRays         += rhs.shadowRays;
+        occludedShadowRays += rhs.occludedShadowRays;
+        intersectionTests  += rhs.intersectionTests;
+        intersectionHits   += rhs.intersectionHits;
+        return *this;
+    }
+};
+
+inline std::ostream& operator<<(std::ostream& os, const RayStats& rayStats) {
+    os << "RayStats("
+         << "primary-rays:"         << rayStats.primaryRays        << ","
+         << "reflection-rays:"      << rayStats.reflectionRays     << ","
+         << "shadow-rays:"          << rayStats.shadowRays         << ","
+         << "occluded-shadow-rays:" << rayStats.occludedShadowRays << ","
+         << "intersection-tests:"   << rayStats.intersectionTests  << ","
+         << "intersection-hits:"    << rayStats.intersectionHits
+       << ")";
+    return os;
+}
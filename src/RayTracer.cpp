@@ -1,43 +1,178 @@
 #include "RayTracer.hpp"
 #include "Math.hpp"
 #include "Color.hpp"
+#include "Radiance.hpp"
 #include "Camera.hpp"
 #include "Lights.hpp"
 #include "Objects.hpp"
 #include "Scene.hpp"
+#include "CompiledScene.hpp"
+#include "CameraRayGenerator.hpp"
+#include "RayPacket.hpp"
+#include "Simd.hpp"
 #include "FrameBuffer.hpp"
-#include <omp.h>
+#include "ThreadPool.hpp"
+#include "RayStats.hpp"
+#include "CostMap.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+#include <chrono>
+#include <bit>
+#include <limits>
+
+
+namespace {
+
+    // hashes the hit into a uniform value in [0, 1), so roulette decides the same way for a path no matter how
+    // (or on which thread) its hits are traced
+    float rouletteSample(const Vec3& point, size_t depth) {
+        uint64_t hash = (static_cast<uint64_t>(std::bit_cast<uint32_t>(point.x)) << 32) ^
+                        (static_cast<uint64_t>(std::bit_cast<uint32_t>(point.y)) << 16) ^
+                        (static_cast<uint64_t>(std::bit_cast<uint32_t>(point.z))) ^ (static_cast<uint64_t>(depth) << 56);
+        hash ^= hash >> 30;
+        hash *= 0xBF58476D1CE4E5B9ull;
+        hash ^= hash >> 27;
+        hash *= 0x94D049BB133111EBull;
+        hash ^= hash >> 31;
+        return static_cast<float>(hash >> 40) * (1.00f / static_cast<float>(1u << 24));
+    }
+}
 
 
 RayTracer::RayTracer()
     : bias_             (DEFAULT_BIAS),
       maxNumReflections_(DEFAULT_MAX_NUM_REFLECTIONS),
       shadowColor_      (DEFAULT_SHADOW_COLOR),
-      backgroundColor_  (DEFAULT_BACKGROUND_COLOR) {}
+      backgroundColor_  (DEFAULT_BACKGROUND_COLOR),
+      integrator_       (DEFAULT_INTEGRATOR),
+      sortsReflections_ (DEFAULT_SORTS_REFLECTIONS),
+      minThroughput_    (DEFAULT_MIN_THROUGHPUT),
+      usesRussianRoulette_(DEFAULT_USES_RUSSIAN_ROULETTE) {}
+
+RayTracer::Wavefront::Wavefront(size_t numPaths, size_t maxNumVertices)
+    : rays              (numPaths),
+      nextRays          (numPaths),
+      shadowRays        (numPaths),
+      sortedRays        (numPaths),
+      hits              (numPaths),
+      isHit             (numPaths),
+      numShadowingLights(numPaths),
+      vertices          (numPaths * maxNumVertices),
+      numVertices       (numPaths),
+      endsInMiss        (numPaths),
+      throughputs       (numPaths),
+      lightOffsets      (numPaths + 1) {}
+
+
+// convenience overload for tracing a scene that is compiled just for this frame
+RayStats RayTracer::traceScene(const Camera& camera, const Scene& scene, FrameBuffer& frameBuffer) const {
+    return traceScene(camera, CompiledScene(scene), frameBuffer);
+}
+
+// convenience overload for tracing on a pool spun up just for this frame, with a thread per hardware thread
+RayStats RayTracer::traceScene(const Camera& camera, const CompiledScene& scene, FrameBuffer& frameBuffer) const {
+    ThreadPool threadPool{};
+    return traceScene(camera, scene, frameBuffer, threadPool);
+}
+
+RayStats RayTracer::traceScene(const Camera& camera, const CompiledScene& scene, FrameBuffer& frameBuffer, ThreadPool& threadPool) const {
+    return traceTiles(camera, scene, frameBuffer, threadPool, nullptr);
+}
 
+// render as usual, but also record what every pixel cost, at the expense of timing each one
+RayStats RayTracer::traceScene(const Camera& camera, const CompiledScene& scene, FrameBuffer& frameBuffer, ThreadPool& threadPool,
+                               CostMap& costMap) const {
+    if (costMap.width() != frameBuffer.width() || costMap.height() != frameBuffer.height()) {
+        throw std::invalid_argument("cost map must have the same dimensions as the frame buffer");
+    }
+    return traceTiles(camera, scene, frameBuffer, threadPool, &costMap);
+}
 
 // for each pixel in buffer shoot ray from camera position to its projected point on the image plane,
-// traceScene it through the scene and write computed color to buffer (dynamically scheduled in parallel using openMp)
-void RayTracer::traceScene(const Camera& camera, const Scene& scene, FrameBuffer& frameBuffer) const {
-    // use ints for indexing since size_t is not supported by openMp loop parallelization macros
-    const size_t width     = static_cast<int>(frameBuffer.width());
-    const size_t height    = static_cast<int>(frameBuffer.height());
-    const float invWidth   = 1.00f / width;
-    const float invHeight  = 1.00f / height;
-    const Vec3 eyePosition = camera.position();
-    const int numPixels    = static_cast<int>(frameBuffer.numPixels());
-#ifndef DEBUG
-    #pragma omp for schedule(dynamic)
-#else
-    std::cout << "Not using OpenMP...";
-#endif
-    for (int i = 0; i < numPixels; i++) {
-        const auto [row, col] = frameBuffer.getPixelRowCol(i);
-        const Vec3 viewportPosition{ (col + 0.50f) * invWidth, (row + 0.50f) * invHeight, 0.00f };
-        const Ray primaryRay = camera.viewportPointToRay(viewportPosition);
-        const Color pixelColor = traceRay(camera, scene, primaryRay, 0);
-        frameBuffer.setPixel(height - 1 - row, col, pixelColor);  // invert y (since viewport and row start opposite)
+// trace it through the scene and write computed radiance to buffer (clamped only if the buffer stores colors)
+//
+// pixels are split into square tiles that the pool's threads claim one at a time, which keeps per task overhead
+// negligible while still leaving plenty of tiles to balance out the expensive ones
+//
+// ray statistics are counted per worker and summed once all tiles are done (when disabled, every worker counts into
+// the same unused copy, with all increments compiled out)
+//
+// wavefront integration traces each tile as one wavefront, with every worker reusing its own preallocated queues,
+// though cost maps always integrate recursively since their costs are attributed to single pixels
+//
+// primary rays are generated a tile row at a time from steps between pixel centers computed once per frame, rather
+// than projecting each pixel's viewport position back into the world, and are then traced in packets along the row
+RayStats RayTracer::traceTiles(const Camera& camera, const CompiledScene& scene, FrameBuffer& frameBuffer, ThreadPool& threadPool,
+                               CostMap* costMap) const {
+    const size_t width       = frameBuffer.width();
+    const size_t height      = frameBuffer.height();
+    const size_t numTileCols = (width  + TILE_SIZE - 1) / TILE_SIZE;
+    const size_t numTileRows = (height + TILE_SIZE - 1) / TILE_SIZE;
+    static_assert(TILE_SIZE <= RayBatch::CAPACITY);
+    const CameraRayGenerator primaryRays{ camera, width, height };
+    std::vector<WorkerRayStats> workerStats(RayStats::IS_ENABLED ? threadPool.numThreads() : 1);
+    const bool isWavefront = integrator_ == Integrator::Wavefront && costMap == nullptr;
+    std::vector<Wavefront> wavefronts;
+    if (isWavefront) {
+        wavefronts.reserve(threadPool.numThreads());
+        for (size_t worker = 0; worker < threadPool.numThreads(); worker++) {
+            wavefronts.emplace_back(TILE_SIZE * TILE_SIZE, maxNumReflections_ + 1);
+        }
     }
+    threadPool.parallelFor(numTileRows * numTileCols, [&](size_t tile, size_t worker) {
+        ProfileZone zone{ "trace-tile" };
+        RayStats& stats = workerStats[RayStats::IS_ENABLED ? worker : 0].stats;
+        const size_t rowBegin = (tile / numTileCols) * TILE_SIZE;
+        const size_t colBegin = (tile % numTileCols) * TILE_SIZE;
+        const size_t rowEnd   = std::min(rowBegin + TILE_SIZE, height);
+        const size_t colEnd   = std::min(colBegin + TILE_SIZE, width);
+        if (isWavefront) {
+            traceWavefront(camera, scene, primaryRays, rowBegin, rowEnd, colBegin, colEnd, wavefronts[worker], frameBuffer, stats);
+            return;
+        }
+
+        RayBatch batch;
+        PathScratch scratch{ maxNumReflections_ + 1 };
+        for (size_t row = rowBegin; row < rowEnd; row++) {
+            primaryRays.generateRow(row, colBegin, colEnd - colBegin, batch);
+            if (costMap == nullptr) {
+                for (size_t col = colBegin; col < colEnd; col += RayPacket::SIZE) {
+                    const size_t count = std::min(RayPacket::SIZE, colEnd - col);
+                    Ray rays[RayPacket::SIZE];
+                    for (size_t lane = 0; lane < count; lane++) {
+                        rays[lane] = batch.ray(col - colBegin + lane);
+                    }
+                    Radiance radiances[RayPacket::SIZE];
+                    tracePrimaryPacket(camera, scene, RayPacket(rays, Simd::firstLanes(count, RayPacket::SIZE)), radiances,
+                                       scratch, stats);
+                    for (size_t lane = 0; lane < count; lane++) {
+                        frameBuffer.setPixel(height - 1 - row, col + lane, radiances[lane]);  // invert y (since viewport and row start opposite)
+                    }
+                }
+                continue;
+            }
+
+            // costs are attributed to single pixels, so each is traced by itself
+            for (size_t col = colBegin; col < colEnd; col++) {
+                const auto startTime = std::chrono::steady_clock::now();
+                CostCounters counters{ stats };
+                counters.countPrimaryRay();
+                const Radiance pixelRadiance = traceRay(camera, scene, batch.ray(col - colBegin), scratch, counters);
+                counters.cost.nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - startTime).count();
+                costMap->setCost(height - 1 - row, col, counters.cost);
+                frameBuffer.setPixel(height - 1 - row, col, pixelRadiance);
+            }
+        }
+    });
+
+    RayStats totalStats{};
+    for (const WorkerRayStats& worker : workerStats) {
+        totalStats += worker.stats;
+    }
+    return totalStats;
 }
 
 float RayTracer::bias() const {
@@ -56,6 +191,22 @@ Color RayTracer::backgroundColor() const {
     return backgroundColor_;
 }
 
+Integrator RayTracer::integrator() const {
+    return integrator_;
+}
+
+bool RayTracer::sortsReflections() const {
+    return sortsReflections_;
+}
+
+float RayTracer::minThroughput() const {
+    return minThroughput_;
+}
+
+bool RayTracer::usesRussianRoulette() const {
+    return usesRussianRoulette_;
+}
+
 
 void RayTracer::setBias(float shadowBias) {
     this->bias_ = shadowBias;
@@ -73,42 +224,399 @@ void RayTracer::setBackgroundColor(const Color& backgroundColor) {
     this->backgroundColor_ = backgroundColor;
 }
 
+void RayTracer::setIntegrator(Integrator integrator) {
+    this->integrator_ = integrator;
+}
 
+void RayTracer::setSortsReflections(bool sortsReflections) {
+    this->sortsReflections_ = sortsReflections;
+}
 
-Color RayTracer::traceRay(const Camera& camera, const Scene& scene, const Ray& ray, size_t depth=0) const {
-    Intersection intersection{};
-    if (!findNearestIntersection(camera, scene, ray, intersection)) {
-        return backgroundColor_;
+void RayTracer::setMinThroughput(float minThroughput) {
+    if (!(minThroughput >= 0.00f && minThroughput <= 1.00f)) {
+        throw std::invalid_argument("minimum throughput must be within [0, 1]");
     }
+    this->minThroughput_ = minThroughput;
+}
+
+void RayTracer::setUsesRussianRoulette(bool usesRussianRoulette) {
+    this->usesRussianRoulette_ = usesRussianRoulette;
+}
 
-    Color reflectedColor = {0.0f, 0.0f, 0.0f};
-    if (depth < maxNumReflections_ && intersection.object->material().reflectivity() > 0.00f) {
-        reflectedColor = traceRay(camera, scene, reflectRay(ray, intersection), depth + 1);
+std::string RayTracer::integratorName(Integrator integrator) {
+    switch (integrator) {
+        case Integrator::Recursive: return "recursive";
+        case Integrator::Wavefront: return "wavefront";
     }
-    
-    Color nonReflectedColor = intersection.object->material().ambientColor();
-    for (size_t index = 0; index < scene.getNumLights(); index++) {
-        const ILight& light = scene.getLight(index);
-        Color diffuse  = computeDiffuseColor(intersection, light);
-        Color specular = computeSpecularColor(intersection, light, camera);
-        Color lightIntensityAtPoint = light.computeIntensityAtPoint(intersection.point);
-        nonReflectedColor += lightIntensityAtPoint * (diffuse + specular);
+    return "unknown";
+}
+
+
+
+// paths of the tile's pixels are advanced a bounce at a time, each stage streaming over all rays of the bounce
+// before the next begins, until no path spawns another reflection
+//
+// reflections leave the surfaces they bounce off in every direction, so unless sorting is disabled they are
+// regrouped by direction and origin first, letting them be extended in packets much like the primary rays
+//
+// shading only records each hit's own contribution, since blending in reflections needs the color of the path's
+// later hits, so pixels are resolved once their paths are complete
+void RayTracer::traceWavefront(const Camera& camera, const CompiledScene& scene, const CameraRayGenerator& primaryRays,
+                               size_t rowBegin, size_t rowEnd, size_t colBegin, size_t colEnd, Wavefront& wavefront,
+                               FrameBuffer& frameBuffer, RayStats& stats) const {
+    const size_t tileWidth = colEnd - colBegin;
+    const size_t numPaths  = (rowEnd - rowBegin) * tileWidth;
+    wavefront.rays.clear();
+    RayBatch batch;
+    for (size_t row = rowBegin; row < rowEnd; row++) {
+        primaryRays.generateRow(row, colBegin, tileWidth, batch);
+        for (size_t i = 0; i < tileWidth; i++) {
+            stats.countPrimaryRay();
+            wavefront.rays.push(batch.ray(i), static_cast<uint32_t>((row - rowBegin) * tileWidth + i));
+        }
     }
+    std::fill_n(wavefront.numVertices.begin(), numPaths, 0u);
+    std::fill_n(wavefront.endsInMiss.begin(),  numPaths, uint8_t{ 0 });
+    std::fill_n(wavefront.throughputs.begin(), numPaths, 1.00f);
 
+    for (size_t depth = 0; !wavefront.rays.isEmpty(); depth++) {
+        if (depth > 0 && sortsReflections_) {
+            wavefront.rays.sortByCoherence(wavefront.sortedRays);
+        }
+        extendRays(scene, wavefront, depth == 0 || sortsReflections_, stats);
+        traceShadowRays(scene, wavefront, stats);
+        wavefront.nextRays.clear();
+        shadeHits(camera, scene, wavefront, depth, stats);
+        std::swap(wavefront.rays, wavefront.nextRays);
+    }
 
-    // blend intrinsic and reflected color using our light and intersected object
-    Color blendedColor = (intersection.object->material().intrinsity()   * nonReflectedColor) + 
-                         (intersection.object->material().reflectivity() * reflectedColor);
+    for (size_t path = 0; path < numPaths; path++) {
+        const size_t row = rowBegin + path / tileWidth;
+        const size_t col = colBegin + path % tileWidth;
+        frameBuffer.setPixel(frameBuffer.height() - 1 - row, col, resolvePath(&wavefront.vertices[path * (maxNumReflections_ + 1)],
+                                                                          wavefront.numVertices[path], wavefront.endsInMiss[path] != 0));  // invert y (since viewport and row start opposite)
+    }
+}
 
-    // shadows
-    for (size_t index = 0; index < scene.getNumLights(); index++) {
+// primary rays (and sorted reflections) run in packets of neighboring rays, whereas unsorted reflections are too
+// scattered for that to pay off
+void RayTracer::extendRays(const CompiledScene& scene, Wavefront& wavefront, bool isCoherent, RayStats& stats) const {
+    const RayQueue& rays = wavefront.rays;
+    if (!isCoherent) {
+        for (size_t i = 0; i < rays.size(); i++) {
+            wavefront.isHit[i] = scene.intersect(rays.ray(i), wavefront.hits[i]);
+            stats.countIntersectionTest(wavefront.isHit[i] != 0);
+        }
+        return;
+    }
+
+    for (size_t first = 0; first < rays.size(); first += RayPacket::SIZE) {
+        const size_t count = std::min(RayPacket::SIZE, rays.size() - first);
+        Ray packetRays[RayPacket::SIZE];
+        for (size_t lane = 0; lane < count; lane++) {
+            packetRays[lane] = rays.ray(first + lane);
+        }
+        const uint32_t hits = scene.intersect(RayPacket(packetRays, Simd::firstLanes(count, RayPacket::SIZE)), &wavefront.hits[first]);
+        for (size_t lane = 0; lane < count; lane++) {
+            wavefront.isHit[first + lane] = static_cast<uint8_t>((hits >> lane) & 1u);
+            stats.countIntersectionTest(((hits >> lane) & 1u) != 0);
+        }
+    }
+}
+
+// shadow rays are queued one light at a time, so neighboring rays in the queue share their endpoint and can be
+// tested in packets, and the queue never needs room for more than one ray per hit
+//
+// each hit is only tested against the lights reaching it, so the lights gathered for every hit (which shading
+// reuses) are counting sorted into runs of the hits each light reaches, with hits kept in order within each run
+void RayTracer::traceShadowRays(const CompiledScene& scene, Wavefront& wavefront, RayStats& stats) const {
+    const size_t numRays   = wavefront.rays.size();
+    const size_t numLights = scene.getNumLights();
+    std::fill_n(wavefront.numShadowingLights.begin(), numRays, 0u);
+    wavefront.lights.clear();
+    wavefront.lightRuns.assign(numLights + 1, 0u);
+    for (size_t i = 0; i < numRays; i++) {
+        wavefront.lightOffsets[i] = static_cast<uint32_t>(wavefront.lights.size());
+        if (wavefront.isHit[i]) {
+            const std::span<const uint32_t> lights = scene.gatherLights(wavefront.hits[i].point, wavefront.gatheredLights);
+            wavefront.lights.insert(wavefront.lights.end(), lights.begin(), lights.end());
+            for (const uint32_t index : lights) {
+                wavefront.lightRuns[index + 1]++;
+            }
+        }
+    }
+    wavefront.lightOffsets[numRays] = static_cast<uint32_t>(wavefront.lights.size());
+    for (size_t index = 0; index < numLights; index++) {
+        wavefront.lightRuns[index + 1] += wavefront.lightRuns[index];
+    }
+    // placing each hit advances its light's run start, leaving it at where the next light's run starts
+    wavefront.litHits.resize(wavefront.lights.size());
+    for (size_t i = 0; i < numRays; i++) {
+        for (size_t k = wavefront.lightOffsets[i]; k < wavefront.lightOffsets[i + 1]; k++) {
+            wavefront.litHits[wavefront.lightRuns[wavefront.lights[k]]++] = static_cast<uint32_t>(i);
+        }
+    }
+
+    RayQueue& shadowRays = wavefront.shadowRays;
+    for (size_t index = 0; index < numLights; index++) {
         const ILight& light = scene.getLight(index);
-        if (isInShadow(camera, intersection, light, scene)) {
+        shadowRays.clear();
+        const size_t runBegin = index > 0 ? wavefront.lightRuns[index - 1] : 0;
+        for (size_t k = runBegin; k < wavefront.lightRuns[index]; k++) {
+            const uint32_t i = wavefront.litHits[k];
+            float distanceToLight = 0.00f;
+            const Ray ray = shadowRay(wavefront.hits[i], light, distanceToLight);
+            shadowRays.push(ray, i, distanceToLight, wavefront.hits[i].primitive);
+        }
+
+        for (size_t first = 0; first < shadowRays.size(); first += RayPacket::SIZE) {
+            const size_t count = std::min(RayPacket::SIZE, shadowRays.size() - first);
+            Ray      packetRays[RayPacket::SIZE];
+            float    distancesToLight[RayPacket::SIZE]{};
+            uint32_t ignorePrimitives[RayPacket::SIZE]{};
+            for (size_t lane = 0; lane < count; lane++) {
+                packetRays[lane]       = shadowRays.ray(first + lane);
+                distancesToLight[lane] = shadowRays.tMax(first + lane);
+                ignorePrimitives[lane] = shadowRays.ignorePrimitive(first + lane);
+            }
+            const RayPacket packet{ packetRays, Simd::firstLanes(count, RayPacket::SIZE) };
+            const uint32_t occluded = scene.isOccluded(packet, distancesToLight, ignorePrimitives);
+            for (size_t lane = 0; lane < count; lane++) {
+                const bool isOccluded = ((occluded >> lane) & 1u) != 0;
+                wavefront.numShadowingLights[shadowRays.path(first + lane)] += isOccluded ? 1u : 0u;
+                stats.countShadowRay(isOccluded);
+            }
+        }
+    }
+}
+
+void RayTracer::shadeHits(const Camera& camera, const CompiledScene& scene, Wavefront& wavefront, size_t depth, RayStats& stats) const {
+    const RayQueue& rays = wavefront.rays;
+    const size_t maxNumVertices = maxNumReflections_ + 1;
+    for (size_t i = 0; i < rays.size(); i++) {
+        const uint32_t path = rays.path(i);
+        if (!wavefront.isHit[i]) {
+            wavefront.endsInMiss[path] = 1;
+            continue;
+        }
+
+        const Intersection& intersection = wavefront.hits[i];
+        const Material& material = scene.getMaterial(intersection.material);
+        float reflectivity = material.reflectivity();
+        const bool isReflected = continuesPath(intersection, depth, wavefront.throughputs[path], reflectivity);
+        wavefront.vertices[path * maxNumVertices + wavefront.numVertices[path]++] = PathVertex{
+            material.intrinsity() * computeNonReflectedColor(camera, scene, material, intersection, std::span<const uint32_t>(
+                wavefront.lights.data() + wavefront.lightOffsets[i], wavefront.lights.data() + wavefront.lightOffsets[i + 1])),
+            reflectivity,
+            wavefront.numShadowingLights[i],
+        };
+
+        if (isReflected) {
+            stats.countReflectionRay();
+            wavefront.nextRays.push(reflectRay(rays.ray(i), intersection), path);
+        }
+    }
+}
+
+// blends each hit with the color reflected into it, from the path's last hit back to its first, exactly as
+// recursive integration does on its way back up
+Radiance RayTracer::resolvePath(const PathVertex* vertices, size_t numVertices, bool endsInMiss) const {
+    Radiance color = endsInMiss ? Radiance(backgroundColor_) : Radiance::zero();
+    for (size_t depth = numVertices; depth-- > 0; ) {
+        Radiance blendedColor = vertices[depth].intrinsicColor + (vertices[depth].reflectivity * color);
+        for (uint32_t i = 0; i < vertices[depth].numShadowingLights; i++) {
             blendedColor -= shadowColor_;
         }
+        color = nonNegative(blendedColor);
+    }
+    return color;
+}
+
+// neighboring primary rays, and the shadow rays from their hits toward the same light, are coherent enough to share
+// traversal as packets, whereas reflections scatter too much for that to pay off and are traced ray by ray
+//
+// each lane's hit is only shadow tested against the lights reaching it, so packets of shadow rays are formed by
+// merging the lanes' (ascending) lists of lights, each time testing the lanes reached by the lowest light left
+template <typename Counters>
+void RayTracer::tracePrimaryPacket(const Camera& camera, const CompiledScene& scene, const RayPacket& packet, Radiance* radiances,
+                                   PathScratch& scratch, Counters& counters) const {
+    Intersection intersections[RayPacket::SIZE];
+    const uint32_t hits = scene.intersect(packet, intersections);
+    for (uint32_t lanes = packet.lanes; lanes != 0; lanes &= lanes - 1) {
+        counters.countPrimaryRay();
+        counters.countIntersectionTest(((hits >> Simd::lowestLane(lanes)) & 1u) != 0);
+    }
+
+    for (uint32_t lanes = hits; lanes != 0; lanes &= lanes - 1) {
+        const int lane = Simd::lowestLane(lanes);
+        scratch.packetLights[lane] = scene.gatherLights(intersections[lane].point, scratch.packetLightStorage[lane]);
+    }
+    // lanes usually share the same lights (such as when none fall off), in which case there's nothing to merge
+    const std::span<const uint32_t> firstLights = scratch.packetLights[hits != 0 ? Simd::lowestLane(hits) : 0];
+    bool isShared = true;
+    for (uint32_t lanes = hits; lanes != 0; lanes &= lanes - 1) {
+        const std::span<const uint32_t> lights = scratch.packetLights[Simd::lowestLane(lanes)];
+        isShared &= lights.data() == firstLights.data() && lights.size() == firstLights.size();
+    }
+
+    scratch.packetLitLanes.clear();
+    scratch.packetShadowedLanes.clear();
+    size_t nextLight[RayPacket::SIZE]{};
+    while (hits != 0) {
+        uint32_t index    = std::numeric_limits<uint32_t>::max();
+        uint32_t litLanes = 0;
+        if (isShared) {
+            if (scratch.packetLitLanes.size() == firstLights.size()) {
+                break;
+            }
+            index    = firstLights[scratch.packetLitLanes.size()];
+            litLanes = hits;
+        } else {
+            for (uint32_t lanes = hits; lanes != 0; lanes &= lanes - 1) {
+                const int lane = Simd::lowestLane(lanes);
+                if (nextLight[lane] < scratch.packetLights[lane].size()) {
+                    index = std::min(index, scratch.packetLights[lane][nextLight[lane]]);
+                }
+            }
+            if (index == std::numeric_limits<uint32_t>::max()) {
+                break;
+            }
+            for (uint32_t lanes = hits; lanes != 0; lanes &= lanes - 1) {
+                const int lane = Simd::lowestLane(lanes);
+                if (nextLight[lane] < scratch.packetLights[lane].size() && scratch.packetLights[lane][nextLight[lane]] == index) {
+                    litLanes |= 1u << lane;
+                    nextLight[lane]++;
+                }
+            }
+        }
+
+        const ILight& light = scene.getLight(index);
+        Ray      shadowRays[RayPacket::SIZE];
+        float    distancesToLight[RayPacket::SIZE]{};
+        uint32_t ignorePrimitives[RayPacket::SIZE]{};
+        for (uint32_t lanes = litLanes; lanes != 0; lanes &= lanes - 1) {
+            const int lane = Simd::lowestLane(lanes);
+            shadowRays[lane]       = shadowRay(intersections[lane], light, distancesToLight[lane]);
+            ignorePrimitives[lane] = intersections[lane].primitive;
+        }
+        const uint32_t occluded = scene.isOccluded(RayPacket(shadowRays, litLanes), distancesToLight, ignorePrimitives);
+        scratch.packetLitLanes.push_back(litLanes);
+        scratch.packetShadowedLanes.push_back(occluded & litLanes);
+        for (uint32_t lanes = litLanes; lanes != 0; lanes &= lanes - 1) {
+            counters.countShadowRay(((occluded >> Simd::lowestLane(lanes)) & 1u) != 0);
+        }
+    }
+
+    for (uint32_t lanes = packet.lanes; lanes != 0; lanes &= lanes - 1) {
+        const int lane = Simd::lowestLane(lanes);
+        radiances[lane] = ((hits >> lane) & 1u) != 0
+            ? tracePath(camera, scene, packet.rays[lane], intersections[lane], lane, scratch, counters)
+            : Radiance(backgroundColor_);
+    }
+}
+
+// counters are either plain `RayStats`, or `CostCounters` for also recording what the current pixel cost
+template <typename Counters>
+Radiance RayTracer::traceRay(const Camera& camera, const CompiledScene& scene, const Ray& ray, PathScratch& scratch,
+                             Counters& counters) const {
+    Intersection intersection{};
+    if (!findNearestIntersection(camera, scene, ray, intersection, counters)) {
+        return backgroundColor_;
+    }
+    return tracePath(camera, scene, ray, intersection, -1, scratch, counters);
+}
+
+// follows the path from its first hit one reflection at a time, recording each hit's own (shadowed) contribution,
+// and then blends them back to front once the path ends, so reflections cost a loop iteration rather than a call
+//
+// each hit is only lit by (and shadow tested against) the lights reaching it, which for the first hit of a packet's
+// lane have already been gathered and shadow tested along with the other lanes, and are otherwise gathered and
+// traced here (as they always are for later hits)
+template <typename Counters>
+Radiance RayTracer::tracePath(const Camera& camera, const CompiledScene& scene, const Ray& ray, const Intersection& intersection,
+                              int packetLane, PathScratch& scratch, Counters& counters) const {
+    Ray pathRay = ray;
+    Intersection hit = intersection;
+    float throughput = 1.00f;
+    size_t numVertices = 0;
+    bool endsInMiss = false;
+    for (size_t depth = 0; ; depth++) {
+        const Material& material = scene.getMaterial(hit.material);
+        const bool isPacketHit = depth == 0 && packetLane >= 0;
+        const std::span<const uint32_t> lights = isPacketHit
+            ? scratch.packetLights[packetLane]
+            : scene.gatherLights(hit.point, scratch.lights);
+        uint32_t numShadowingLights = 0;
+        if (isPacketHit) {
+            for (size_t step = 0; step < scratch.packetLitLanes.size(); step++) {
+                numShadowingLights += (scratch.packetShadowedLanes[step] >> packetLane) & 1u;
+            }
+        } else {
+            for (const uint32_t index : lights) {
+                numShadowingLights += isInShadow(camera, hit, scene.getLight(index), scene, counters) ? 1u : 0u;
+            }
+        }
+        float reflectivity = material.reflectivity();
+        const bool isReflected = continuesPath(hit, depth, throughput, reflectivity);
+        scratch.vertices[numVertices++] = PathVertex{
+            material.intrinsity() * computeNonReflectedColor(camera, scene, material, hit, lights),
+            reflectivity,
+            numShadowingLights,
+        };
+        if (!isReflected) {
+            break;
+        }
+
+        counters.countReflectionRay();
+        pathRay = reflectRay(pathRay, hit);
+        if (!findNearestIntersection(camera, scene, pathRay, hit, counters)) {
+            endsInMiss = true;
+            break;
+        }
     }
-    
-    return blendedColor;
+    return resolvePath(scratch.vertices.data(), numVertices, endsInMiss);
+}
+
+// a path is only extended while the weight of its next ray in the pixel (the product of all reflectivities along
+// the way) is at least the minimum throughput, below which it can hardly change the pixel
+//
+// under russian roulette, paths falling below the minimum instead survive with probability proportional to their
+// throughput, with the reflection scaled up by its inverse to make up for the paths cut short (on average)
+bool RayTracer::continuesPath(const Intersection& intersection, size_t depth, float& throughput, float& reflectivity) const {
+    if (depth >= maxNumReflections_ || !(reflectivity > 0.00f)) {
+        return false;
+    }
+    const float reflectedThroughput = throughput * reflectivity;
+    if (reflectedThroughput >= minThroughput_) {
+        throughput = reflectedThroughput;
+        return true;
+    }
+    if (!usesRussianRoulette_) {
+        return false;
+    }
+    const float survivalProbability = reflectedThroughput / minThroughput_;
+    if (rouletteSample(intersection.point, depth) >= survivalProbability) {
+        return false;
+    }
+    reflectivity /= survivalProbability;
+    throughput    = minThroughput_;
+    return true;
+}
+
+// shading is done in unclamped radiance, so bright contributions add up rather than saturating at each step
+//
+// only the given lights (those reaching the hit) are summed, since any others would add next to nothing
+Radiance RayTracer::computeNonReflectedColor(const Camera& camera, const CompiledScene& scene, const Material& material,
+                                             const Intersection& intersection, std::span<const uint32_t> lights) const {
+    Radiance nonReflectedColor = material.ambientColor();
+    for (const uint32_t index : lights) {
+        const ILight& light = scene.getLight(index);
+        Radiance diffuse  = computeDiffuseColor(material, intersection, light);
+        Radiance specular = computeSpecularColor(material, intersection, light, camera);
+        Radiance lightIntensityAtPoint = light.computeIntensityAtPoint(intersection.point);
+        nonReflectedColor += lightIntensityAtPoint * (diffuse + specular);
+    }
+    return nonReflectedColor;
 }
 
 // reflect our ray using a slight direction offset to avoid infinite reflections
@@ -119,47 +627,54 @@ Ray RayTracer::reflectRay(const Ray& ray, const Intersection& intersection) cons
 }
 
 bool RayTracer::findNearestIntersection(const Camera& camera, const Scene& scene, const Ray& ray, Intersection& result) const {
-    float tClosest = Math::INF;
-    for (size_t index = 0; index < scene.getNumObjects(); index++) {
-        Intersection intersection;
-        if (scene.getObject(index).intersect(ray, intersection) && intersection.t < tClosest) {
-            tClosest = intersection.t;
-            result = intersection;
-        }
-    }
-    return (result.object != nullptr);
+    return scene.intersect(ray, result);
 }
 
-// check if there exists another object blocking light from reaching our hit-point
-bool RayTracer::isInShadow(const Camera& camera, const Intersection& intersection, const ILight& light, const Scene& scene) const {
+bool RayTracer::findNearestIntersection(const Camera& camera, const CompiledScene& scene, const Ray& ray, Intersection& result) const {
+    RayStats unusedStats{};
+    return findNearestIntersection(camera, scene, ray, result, unusedStats);
+}
+
+template <typename Counters>
+bool RayTracer::findNearestIntersection(const Camera& camera, const CompiledScene& scene, const Ray& ray, Intersection& result,
+                                        Counters& counters) const {
+    const bool isHit = scene.intersect(ray, result);
+    counters.countIntersectionTest(isHit);
+    return isHit;
+}
+
+// ray from (slightly off of) our hit-point towards the light, along with the distance it spans to reach it
+Ray RayTracer::shadowRay(const Intersection& intersection, const ILight& light, float& distanceToLight) const {
     const Vec3 directionToLight = Math::direction(intersection.point, light.position());
     const float biasDirection = ( Math::dot(intersection.normal, directionToLight) > 0 ) ? 1.0f : -1.0f;
-    const Ray shadowRay{ intersection.point + (bias_ * biasDirection * intersection.normal), directionToLight };
-    const float distanceToLight = Math::distance(shadowRay.origin, light.position());
-    for (size_t index = 0; index < scene.getNumObjects(); index++) {
-        Intersection occlusion;
-        if (scene.getObject(index).intersect(shadowRay, occlusion) &&
-                occlusion.object != intersection.object &&
-                Math::distance(occlusion.point, light.position()) < distanceToLight) {
-            return true;
-        }
-    }
-    return false;
+    const Ray ray{ intersection.point + (bias_ * biasDirection * intersection.normal), directionToLight };
+    distanceToLight = Math::distance(ray.origin, light.position());
+    return ray;
+}
+
+// check if there exists another object blocking light from reaching our hit-point
+template <typename Counters>
+bool RayTracer::isInShadow(const Camera& camera, const Intersection& intersection, const ILight& light, const CompiledScene& scene,
+                           Counters& counters) const {
+    // any blocker along the segment up to the light suffices, so there's no need to find the nearest one
+    float distanceToLight = 0.00f;
+    const Ray ray = shadowRay(intersection, light, distanceToLight);
+    const bool isOccluded = scene.isOccluded(ray, distanceToLight, intersection.primitive);
+    counters.countShadowRay(isOccluded);
+    return isOccluded;
 }
 
-Color RayTracer::computeDiffuseColor(const Intersection& intersection, const ILight& light) const {
+Radiance RayTracer::computeDiffuseColor(const Material& material, const Intersection& intersection, const ILight& light) const {
     const Vec3 directionToLight      = Math::direction(intersection.point, light.position());
-    const Material surfaceMaterial   = intersection.object->material();
     const float strengthAtLightAngle = Math::max(0.00f, Math::dot(intersection.normal, directionToLight));
-    return strengthAtLightAngle * surfaceMaterial.diffuseColor();
+    return strengthAtLightAngle * Radiance(material.diffuseColor());
 }
 
-Color RayTracer::computeSpecularColor(const Intersection& intersection, const ILight& light, const Camera& camera) const {
+Radiance RayTracer::computeSpecularColor(const Material& material, const Intersection& intersection, const ILight& light, const Camera& camera) const {
     const Vec3 directionToCam      = Math::direction(intersection.point, camera.position());
     const Vec3 halfwayVec          = Math::normalize(directionToCam + light.position());
-    const Material surfaceMaterial = intersection.object->material();
     const float strengthAtCamAngle = Math::max(0.00f, Math::dot(intersection.normal, halfwayVec));
-    return Math::pow(strengthAtCamAngle, surfaceMaterial.shininess()) * surfaceMaterial.specularColor();
+    return Math::pow(strengthAtCamAngle, material.shininess()) * Radiance(material.specularColor());
 }
 
 
@@ -168,7 +683,11 @@ std::ostream& operator<<(std::ostream& os, const RayTracer& rayTracer) {
          << "shadow-color:("       << rayTracer.shadowColor()       << "),"
          << "background-color:("   << rayTracer.backgroundColor()   << "),"
          << "bias:"                << rayTracer.bias()              << ","
-         << "max-num-reflections:" << rayTracer.maxNumReflections()
+         << "max-num-reflections:" << rayTracer.maxNumReflections() << ","
+         << "integrator:"          << RayTracer::integratorName(rayTracer.integrator()) << ","
+         << "sorts-reflections:"   << rayTracer.sortsReflections()  << ","
+         << "min-throughput:"      << rayTracer.minThroughput()     << ","
+         << "russian-roulette:"    << rayTracer.usesRussianRoulette()
        << ")";
     return os;
 }
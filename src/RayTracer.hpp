@@ -2,48 +2,178 @@
 #include "Math.hpp"
 #include "Ray.hpp"
 #include "Color.hpp"
+#include "Radiance.hpp"
 #include "Camera.hpp"
 #include "Lights.hpp"
 #include "Objects.hpp"
 #include "Scene.hpp"
+#include "CompiledScene.hpp"
+#include "RayPacket.hpp"
+#include "RayQueue.hpp"
+#include "CameraRayGenerator.hpp"
 #include "FrameBuffer.hpp"
+#include "ThreadPool.hpp"
+#include "RayStats.hpp"
+#include "CostMap.hpp"
+#include <vector>
+#include <span>
+#include <cstdint>
+#include <string>
+
+
+// recursive integration follows each pixel's path depth first, while wavefront integration advances a whole tile of
+// paths together one stage at a time (extending rays to their closest hits, testing shadow rays, then shading)
+enum class Integrator {
+    Recursive,
+    Wavefront,
+};
 
 
 class RayTracer {
 public:
     RayTracer();
 
-    void traceScene(const Camera& camera, const Scene& scene, FrameBuffer& frameBuffer) const;
+    // each returns counts of the rays fired (all zero unless compiled with ray statistics enabled)
+    RayStats traceScene(const Camera& camera, const Scene& scene, FrameBuffer& frameBuffer) const;
+    RayStats traceScene(const Camera& camera, const CompiledScene& scene, FrameBuffer& frameBuffer) const;
+    RayStats traceScene(const Camera& camera, const CompiledScene& scene, FrameBuffer& frameBuffer, ThreadPool& threadPool) const;
+    RayStats traceScene(const Camera& camera, const CompiledScene& scene, FrameBuffer& frameBuffer, ThreadPool& threadPool,
+                        CostMap& costMap) const;
 
     float  bias()              const;
     size_t maxNumReflections() const;
     Color  shadowColor()       const;
     Color  backgroundColor()   const;
+    Integrator integrator()    const;
+    bool   sortsReflections()  const;
+    float  minThroughput()     const;
+    bool   usesRussianRoulette() const;
 
     void setBias(float bias);
     void setMaxNumReflections(size_t maxNumReflections);
     void setShadowColor(const Color& shadowColor);
     void setBackgroundColor(const Color& backgroundColor);
+    void setIntegrator(Integrator integrator);
+    void setSortsReflections(bool sortsReflections);
+    void setMinThroughput(float minThroughput);
+    void setUsesRussianRoulette(bool usesRussianRoulette);
+
+    static std::string integratorName(Integrator integrator);
 
     Ray reflectRay(const Ray& ray, const Intersection& intersection) const;
     bool findNearestIntersection(const Camera& camera, const Scene& scene, const Ray& ray, Intersection& result) const;
+    bool findNearestIntersection(const Camera& camera, const CompiledScene& scene, const Ray& ray, Intersection& result) const;
 
 private:
     float bias_;
     size_t maxNumReflections_;
     Color shadowColor_;
     Color backgroundColor_;
+    Integrator integrator_;
+    bool sortsReflections_;
+    float minThroughput_;
+    bool usesRussianRoulette_;
 
     static constexpr float  DEFAULT_BIAS = 1e-02f;
     static constexpr size_t DEFAULT_MAX_NUM_REFLECTIONS = 3;
     static constexpr Color  DEFAULT_SHADOW_COLOR     { 0.125f, 0.125f, 0.125f };
     static constexpr Color  DEFAULT_BACKGROUND_COLOR { 0.500f, 0.500f, 0.500f };
+    static constexpr size_t TILE_SIZE = 32;
+    static constexpr Integrator DEFAULT_INTEGRATOR = Integrator::Recursive;
+    static constexpr bool   DEFAULT_SORTS_REFLECTIONS = true;
+    static constexpr float  DEFAULT_MIN_THROUGHPUT = 1e-03f;
+    static constexpr bool   DEFAULT_USES_RUSSIAN_ROULETTE = false;
+
+    // padded to a cache line each, so workers counting into their own copy don't contend with each other
+    struct alignas(64) WorkerRayStats {
+        RayStats stats;
+    };
+
+    // counts into the render's statistics as usual, while unconditionally counting the current pixel's cost
+    struct CostCounters {
+        RayStats& stats;
+        PixelCost cost{};
+
+        void countPrimaryRay()    { stats.countPrimaryRay();    }
+        void countReflectionRay() { stats.countReflectionRay(); }
+        void countShadowRay(bool isOccluded)   { stats.countShadowRay(isOccluded);   cost.shadowRays++;        }
+        void countIntersectionTest(bool isHit) { stats.countIntersectionTest(isHit); cost.intersectionTests++; }
+    };
+
+    // shading of one hit along a path, from which its color is resolved once all of the path's later hits are known
+    struct PathVertex {
+        Radiance intrinsicColor;  // ambient, diffuse and specular light, weighted by the material's intrinsity
+        float    reflectivity;
+        uint32_t numShadowingLights;
+    };
+
+    // scratch space of one worker's recursive integration, reused by each path it traces
+    struct PathScratch {
+        std::vector<PathVertex> vertices;                        // a slot for every bounce a path can take
+        std::vector<uint32_t>     lights;                             // lights reaching the current hit, when gathered
+        std::vector<uint32_t>     packetLightStorage[RayPacket::SIZE];
+        std::span<const uint32_t> packetLights[RayPacket::SIZE];      // lights reaching each lane's primary hit
+        std::vector<uint32_t>     packetLitLanes;                     // per light shadow tested for the packet, the
+        std::vector<uint32_t>     packetShadowedLanes;                // lanes tested and which of them it's blocked from
+
+        explicit PathScratch(size_t maxNumVertices) : vertices(maxNumVertices) {}
+    };
+
+    // queues and per path records of one worker's wavefront, allocated once per frame and reused by each of its tiles
+    struct Wavefront {
+        RayQueue                  rays;          // rays of the current bounce
+        RayQueue                  nextRays;      // reflections spawned while shading the current bounce
+        RayQueue                  shadowRays;    // shadow rays towards one light at a time
+        RayQueue                  sortedRays;    // scratch space for sorting reflections
+        std::vector<Intersection> hits;          // closest hit of each of the current rays, where any
+        std::vector<uint8_t>      isHit;
+        std::vector<uint32_t>     numShadowingLights;
+        std::vector<PathVertex>   vertices;      // per path, a slot for every bounce it can take
+        std::vector<uint32_t>     numVertices;
+        std::vector<uint8_t>      endsInMiss;    // whether the path's last ray escaped the scene
+        std::vector<float>        throughputs;   // weight of each path's current ray in its pixel
+        std::vector<uint32_t>     lightOffsets;  // per current ray, where the lights reaching its hit start in `lights`
+        std::vector<uint32_t>     lights;        // lights reaching each of the current hits, one run after another
+        std::vector<uint32_t>     gatheredLights;
+        std::vector<uint32_t>     lightRuns;     // per light, where the hits it reaches start in `litHits`
+        std::vector<uint32_t>     litHits;       // current hits grouped by the lights reaching them
+
+        Wavefront(size_t numPaths, size_t maxNumVertices);
+    };
+
+    RayStats traceTiles(const Camera& camera, const CompiledScene& scene, FrameBuffer& frameBuffer, ThreadPool& threadPool,
+                        CostMap* costMap) const;
+
+    void traceWavefront(const Camera& camera, const CompiledScene& scene, const CameraRayGenerator& primaryRays,
+                        size_t rowBegin, size_t rowEnd, size_t colBegin, size_t colEnd, Wavefront& wavefront,
+                        FrameBuffer& frameBuffer, RayStats& stats) const;
+    void extendRays(const CompiledScene& scene, Wavefront& wavefront, bool isCoherent, RayStats& stats) const;
+    void traceShadowRays(const CompiledScene& scene, Wavefront& wavefront, RayStats& stats) const;
+    void shadeHits(const Camera& camera, const CompiledScene& scene, Wavefront& wavefront, size_t depth, RayStats& stats) const;
 
-    Color traceRay(const Camera& camera, const Scene& scene, const Ray& ray, size_t depth) const;
+    template <typename Counters>
+    void tracePrimaryPacket(const Camera& camera, const CompiledScene& scene, const RayPacket& packet, Radiance* radiances,
+                            PathScratch& scratch, Counters& counters) const;
+    template <typename Counters>
+    Radiance traceRay(const Camera& camera, const CompiledScene& scene, const Ray& ray, PathScratch& scratch,
+                      Counters& counters) const;
+    template <typename Counters>
+    Radiance tracePath(const Camera& camera, const CompiledScene& scene, const Ray& ray, const Intersection& intersection,
+                       int packetLane, PathScratch& scratch, Counters& counters) const;
+    bool continuesPath(const Intersection& intersection, size_t depth, float& throughput, float& reflectivity) const;
+    Radiance resolvePath(const PathVertex* vertices, size_t numVertices, bool endsInMiss) const;
 
-    bool isInShadow(const Camera& camera, const Intersection& intersection, const ILight& light, const Scene& scene) const;
+    template <typename Counters>
+    bool findNearestIntersection(const Camera& camera, const CompiledScene& scene, const Ray& ray, Intersection& result,
+                                 Counters& counters) const;
+    Ray shadowRay(const Intersection& intersection, const ILight& light, float& distanceToLight) const;
+    template <typename Counters>
+    bool isInShadow(const Camera& camera, const Intersection& intersection, const ILight& light, const CompiledScene& scene,
+                    Counters& counters) const;
 
-    Color computeDiffuseColor(const Intersection& intersection, const ILight& light) const;
-    Color computeSpecularColor(const Intersection& intersection, const ILight& light, const Camera& camera) const;
+    Radiance computeNonReflectedColor(const Camera& camera, const CompiledScene& scene, const Material& material,
+                                      const Intersection& intersection, std::span<const uint32_t> lights) const;
+    Radiance computeDiffuseColor(const Material& material, const Intersection& intersection, const ILight& light) const;
+    Radiance computeSpecularColor(const Material& material, const Intersection& intersection, const ILight& light, const Camera& camera) const;
 };
 std::ostream& operator<<(std::ostream& os, const RayTracer& tracer);
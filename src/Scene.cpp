@@ -1,6 +1,9 @@
 #include "Scene.hpp"
 #include "Lights.hpp"
 #include "Objects.hpp"
+#include "TriangleMesh.hpp"
+#include "Ray.hpp"
+#include "BVH.hpp"
 #include <vector>
 #include <assert.h>
 
@@ -10,11 +13,97 @@ void Scene::addLight(PointLight&& light) {
 }
 
 void Scene::addSceneObject(Sphere&& object) {
+    objectMaterials_.push_back(materials_.add(object.material()));
     objects_.push_back(std::make_unique<Sphere>(std::move(object)));
+    bvh_ = BVH();
 }
 
 void Scene::addSceneObject(Triangle&& object) {
+    objectMaterials_.push_back(materials_.add(object.material()));
     objects_.push_back(std::make_unique<Triangle>(std::move(object)));
+    bvh_ = BVH();
+}
+
+void Scene::addSceneObject(TriangleMesh&& object) {
+    objectMaterials_.push_back(materials_.add(object.material()));
+    objects_.push_back(std::make_unique<TriangleMesh>(std::move(object)));
+    bvh_ = BVH();
+}
+
+
+void Scene::buildAccelerationStructure() {
+    std::vector<AABB> objectBounds;
+    objectBounds.reserve(objects_.size());
+    for (const std::unique_ptr<IObject>& object : objects_) {
+        objectBounds.push_back(object->bounds());
+    }
+    bvh_ = BVH(objectBounds);
+}
+
+bool Scene::hasAccelerationStructure() const {
+    return !bvh_.isEmpty();
+}
+
+const BVH& Scene::accelerationStructure() const {
+    return bvh_;
+}
+
+// find the closest object hit by given ray, if any, only tracking distance and object until the closest is known
+bool Scene::intersect(const Ray& ray, Intersection& result) const {
+    float tClosest = Math::INF;
+    const IObject* closest = nullptr;
+    uint32_t closestPart = Intersection::NO_INDEX;
+    if (!hasAccelerationStructure()) {
+        for (const std::unique_ptr<IObject>& object : objects_) {
+            if (object->intersect(ray, tClosest, closestPart)) {
+                closest = object.get();
+            }
+        }
+    } else {
+        bvh_.traverseClosest(ray, Math::INF, [&](size_t first, size_t count, float& tMax) {
+            bool hit = false;
+            for (size_t slot = first; slot < first + count; slot++) {
+                const IObject* object = objects_[bvh_.getPrimitiveIndex(slot)].get();
+                if (object->intersect(ray, tMax, closestPart)) {
+                    tClosest = tMax;
+                    closest  = object;
+                    hit      = true;
+                }
+            }
+            return hit;
+        });
+    }
+
+    if (closest == nullptr) {
+        return false;
+    }
+    closest->finalizeIntersection(ray, tClosest, closestPart, result);
+    return true;
+}
+
+// check if any object other than the ignored one is hit by given ray before reaching tMax, stopping at the first such blocker
+bool Scene::isOccluded(const Ray& ray, float tMax, const IObject* ignore) const {
+    const auto isBlockedBy = [&](const IObject& object) {
+        return &object != ignore && object.occluded(ray, tMax);
+    };
+
+    if (!hasAccelerationStructure()) {
+        for (const std::unique_ptr<IObject>& object : objects_) {
+            if (isBlockedBy(*object)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    return bvh_.traverseAny(ray, tMax, [&](size_t first, size_t count, float) {
+        for (size_t slot = first; slot < first + count; slot++) {
+            if (isBlockedBy(*objects_[bvh_.getPrimitiveIndex(slot)])) {
+                return true;
+            }
+        }
+        return false;
+    });
 }
 
 
@@ -29,6 +118,15 @@ const IObject& Scene::getObject(size_t index) const {
     return *objects_[index];
 }
 
+const MaterialTable& Scene::getMaterialTable() const {
+    return materials_;
+}
+
+MaterialTable::Index Scene::getObjectMaterial(size_t index) const {
+    assert(index >= 0 && index < objectMaterials_.size());
+    return objectMaterials_[index];
+}
+
 
 size_t Scene::getNumLights() const {
     return lights_.size();
@@ -51,6 +149,7 @@ std::ostream& operator<<(std::ostream& os, const Scene& scene) {
     for (size_t i = 0; i < scene.getNumObjects(); i++) {
         os << "\n    " << i << " -- " << scene.getObject(i);
     }
-    os << "\n])";
+    os << "\n]\n";
+    os << "  acceleration-structure:" << scene.accelerationStructure() << ")";
     return os;
 }
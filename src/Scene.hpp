@@ -1,7 +1,12 @@
 #pragma once
 #include "Lights.hpp"
 #include "Objects.hpp"
+#include "TriangleMesh.hpp"
+#include "MaterialTable.hpp"
+#include "Ray.hpp"
+#include "BVH.hpp"
 #include <vector>
+#include <memory>
 
 
 /*
@@ -9,6 +14,13 @@ Simple container for accessing the lights and objects in the order they were add
 
 Currently only supports indexed access, no custom iterators (yet).
 Note that the scene takes full ownership over all of its data.
+
+Materials of added objects are also collected into a table of the distinct materials in the scene, which compiled
+scenes reference by index rather than copying per object.
+
+Ray queries go through a bounding volume hierarchy over the objects' bounds, which is built once via
+`buildAccelerationStructure` after all objects are added. Adding objects afterwards discards it, in which case
+queries fall back to testing every object.
 */
 class Scene {
 public:
@@ -17,9 +29,19 @@ public:
     void addLight(PointLight&& light);
     void addSceneObject(Sphere&& object);
     void addSceneObject(Triangle&& object);
+    void addSceneObject(TriangleMesh&& object);
+
+    void buildAccelerationStructure();
+    bool hasAccelerationStructure() const;
+    const BVH& accelerationStructure() const;
+
+    bool intersect(const Ray& ray, Intersection& result) const;
+    bool isOccluded(const Ray& ray, float tMax, const IObject* ignore = nullptr) const;
 
     const ILight& getLight(size_t index) const;
     const IObject& getObject(size_t index) const;
+    const MaterialTable& getMaterialTable() const;
+    MaterialTable::Index getObjectMaterial(size_t index) const;
 
     size_t getNumLights() const;
     size_t getNumObjects() const;
@@ -27,5 +49,8 @@ public:
 private:
     std::vector<std::unique_ptr<ILight>> lights_;
     std::vector<std::unique_ptr<IObject>> objects_;
+    std::vector<MaterialTable::Index> objectMaterials_;
+    MaterialTable materials_;
+    BVH bvh_;
 };
 std::ostream& operator<<(std::ostream& os, const Scene& scene);
@@ -0,0 +1,562 @@
+#include "SceneCache.hpp"
+#include "Math.hpp"
+#include "Material.hpp"
+#include "MaterialTable.hpp"
+#include "Lights.hpp"
+#include "Objects.hpp"
+#include "TriangleMesh.hpp"
+#include "Scene.hpp"
+#include "CompiledScene.hpp"
+#include "BVH.hpp"
+#include "MappedFile.hpp"
+#include "Hash.hpp"
+#include "Simd.hpp"
+#include <vector>
+#include <utility>
+#include <span>
+#include <string>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <filesystem>
+#include <stdexcept>
+#include <type_traits>
+
+
+namespace {
+
+    constexpr char     MAGIC[8]          = { 'R', 'T', 'S', 'C', 'E', 'N', 'E', '\0' };
+    constexpr uint32_t ENDIANNESS_MARKER = 0x01020304;
+    constexpr size_t   ALIGNMENT         = 64;
+
+    // the section table is written last, as the number of sections depends on the number of meshes
+    struct Header {
+        char     magic[8];
+        uint32_t version;
+        uint32_t endianness;
+        uint32_t vectorSize;  // vectors are padded in builds with a simd vec3, changing the layout of every section holding them
+        uint32_t nodeSize;
+        uint64_t fingerprint;
+        uint64_t tableOffset;
+        uint64_t numSections;
+    };
+
+    struct Section {
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    // lights and materials are stored as plain floats, since their classes aren't trivially copyable
+    struct LightRecord {
+        float position[3];
+        float intensity[3];
+        float attenuation[3];
+    };
+
+    struct MaterialRecord {
+        float ambient[3];
+        float diffuse[3];
+        float specular[3];
+        float intrinsity;
+        float reflectivity;
+        float refractivity;
+        float shininess;
+    };
+
+    struct HierarchyRecord {
+        uint64_t depth;
+        uint64_t maxLeafSize;
+    };
+
+    static_assert(std::is_trivially_copyable_v<BVH::Node>, "bvh nodes must be copyable as raw bytes");
+    static_assert(std::is_trivially_copyable_v<Vec3>,      "vertices must be copyable as raw bytes");
+
+
+    class SectionWriter {
+    public:
+        explicit SectionWriter(std::ofstream& ofs) : ofs_(ofs) {}
+
+        template <typename T>
+        void write(const T* data, size_t count) {
+            static_assert(std::is_trivially_copyable_v<T>);
+            const size_t offset = static_cast<size_t>(ofs_.tellp());
+            const size_t padding = (ALIGNMENT - offset % ALIGNMENT) % ALIGNMENT;
+            const char zeros[ALIGNMENT]{};
+            ofs_.write(zeros, padding);
+            sections_.push_back(Section{ offset + padding, count * sizeof(T) });
+            ofs_.write(reinterpret_cast<const char*>(data), count * sizeof(T));
+        }
+
+        template <typename T>
+        void write(const std::vector<T>& values) {
+            write(values.data(), values.size());
+        }
+
+        template <typename T>
+        void writeValue(const T& value) {
+            write(&value, 1);
+        }
+
+        const std::vector<Section>& sections() const {
+            return sections_;
+        }
+
+    private:
+        std::ofstream&       ofs_;
+        std::vector<Section> sections_;
+    };
+
+
+    // sections are consumed in the same order they were written, with each checked to lie within the file
+    class SectionReader {
+    public:
+        SectionReader(const MappedFile& file, const std::string& filepath)
+            : file_(file), filepath_(filepath) {
+            if (file.size() < sizeof(Header)) {
+                fail("too small to hold a header");
+            }
+            std::memcpy(&header_, file.data(), sizeof(Header));
+            if (std::memcmp(header_.magic, MAGIC, sizeof(MAGIC)) != 0) {
+                fail("not a scene cache");
+            }
+            if (header_.version != SceneCache::VERSION || header_.endianness != ENDIANNESS_MARKER ||
+                header_.vectorSize != sizeof(Vec3) || header_.nodeSize != sizeof(BVH::Node)) {
+                fail("written by an incompatible version or platform");
+            }
+            if (header_.tableOffset > file.size() ||
+                header_.numSections > (file.size() - header_.tableOffset) / sizeof(Section) ||
+                header_.tableOffset % alignof(Section) != 0) {
+                fail("section table is out of bounds");
+            }
+            sections_ = std::span<const Section>(reinterpret_cast<const Section*>(file.data() + header_.tableOffset),
+                                                 header_.numSections);
+        }
+
+        const Header& header() const {
+            return header_;
+        }
+
+        template <typename T>
+        std::span<const T> next() {
+            static_assert(std::is_trivially_copyable_v<T>);
+            if (nextSection_ >= sections_.size()) {
+                fail("missing sections");
+            }
+            const Section& section = sections_[nextSection_++];
+            if (section.offset > file_.size() || section.size > file_.size() - section.offset ||
+                section.size % sizeof(T) != 0 || section.offset % alignof(T) != 0) {
+                fail("section " + std::to_string(nextSection_ - 1) + " is out of bounds");
+            }
+            return std::span<const T>(reinterpret_cast<const T*>(file_.data() + section.offset), section.size / sizeof(T));
+        }
+
+        template <typename T>
+        std::vector<T> nextVector() {
+            const std::span<const T> values = next<T>();
+            return std::vector<T>(values.begin(), values.end());
+        }
+
+        template <typename T>
+        T nextValue() {
+            const std::span<const T> values = next<T>();
+            if (values.size() != 1) {
+                fail("section " + std::to_string(nextSection_ - 1) + " has an unexpected size");
+            }
+            return values[0];
+        }
+
+        [[noreturn]] void fail(const std::string& reason) const {
+            throw std::runtime_error("Cannot read scene cache \'" + filepath_ + "\' - " + reason);
+        }
+
+    private:
+        const MappedFile&        file_;
+        const std::string&       filepath_;
+        Header                   header_{};
+        std::span<const Section> sections_;
+        size_t                   nextSection_{ 0 };
+    };
+
+
+    // hashes vectors and colors component by component, so that any padding lane is left out
+    class Fingerprint {
+    public:
+        void add(const void* data, size_t numBytes) { hash_.add(data, numBytes); }
+
+        void add(float value)        { hash_.add(value); }
+        void add(uint64_t value)     { hash_.add(value); }
+        void add(const Vec3& value)  { add(value.x); add(value.y); add(value.z); }
+        void add(const Color& value) { add(value.r); add(value.g); add(value.b); }
+        void add(const Material& material) {
+            add(material.ambientColor());
+            add(material.diffuseColor());
+            add(material.specularColor());
+            add(material.intrinsity());
+            add(material.reflectivity());
+            add(material.refractivity());
+            add(material.shininess());
+        }
+
+        uint64_t value() const {
+            return hash_.value();
+        }
+
+    private:
+        Fnv1aHash hash_{};
+    };
+
+    LightRecord toRecord(const PointLight& light) {
+        return LightRecord{
+            { light.position().x,  light.position().y,  light.position().z  },
+            { light.intensity().r, light.intensity().g, light.intensity().b },
+            { light.attenuationConstant(), light.attenuationLinear(), light.attenuationQuadratic() },
+        };
+    }
+
+    PointLight fromRecord(const LightRecord& record) {
+        return PointLight(Vec3(record.position[0], record.position[1], record.position[2]),
+                          Color(record.intensity[0], record.intensity[1], record.intensity[2]),
+                          record.attenuation[0], record.attenuation[1], record.attenuation[2]);
+    }
+
+    // checked before constructing the light, which accepts any coefficients, since a non finite or negative one would
+    // otherwise reach the light hierarchy as a non finite radius of influence
+    bool isValid(const LightRecord& record) {
+        for (float value : { record.position[0],    record.position[1],    record.position[2],
+                             record.intensity[0],   record.intensity[1],   record.intensity[2] }) {
+            if (!std::isfinite(value)) {
+                return false;
+            }
+        }
+        for (float coefficient : record.attenuation) {
+            if (!std::isfinite(coefficient) || coefficient < 0.00f) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    MaterialRecord toRecord(const Material& material) {
+        const Color ambient  = material.ambientColor();
+        const Color diffuse  = material.diffuseColor();
+        const Color specular = material.specularColor();
+        return MaterialRecord{
+            { ambient.r,  ambient.g,  ambient.b  },
+            { diffuse.r,  diffuse.g,  diffuse.b  },
+            { specular.r, specular.g, specular.b },
+            material.intrinsity(), material.reflectivity(), material.refractivity(), material.shininess(),
+        };
+    }
+
+    // mirrors the checks of the material's constructor, so that a corrupt record fails as a cache error rather than
+    // as an invalid argument
+    bool isValid(const MaterialRecord& record) {
+        const float weights[] = { record.intrinsity, record.reflectivity, record.refractivity };
+        for (float weight : weights) {
+            if (!(weight >= 0.00f && weight <= 1.00f)) {
+                return false;
+            }
+        }
+        return Math::isApproximately(weights[0] + weights[1] + weights[2], 1.00f) && record.shininess > 0.00f;
+    }
+
+    Material fromRecord(const MaterialRecord& record) {
+        return Material(Color(record.ambient[0],  record.ambient[1],  record.ambient[2]),
+                        Color(record.diffuse[0],  record.diffuse[1],  record.diffuse[2]),
+                        Color(record.specular[0], record.specular[1], record.specular[2]),
+                        record.intrinsity, record.reflectivity, record.refractivity, record.shininess);
+    }
+}
+
+
+// write to a temporary file first, so that an interrupted write never leaves a partial cache in place
+void SceneCache::write(const std::string& filepath, const CompiledScene& scene, uint64_t sceneFingerprint) {
+    const std::string temporaryFilepath = filepath + ".tmp";
+    std::ofstream ofs(temporaryFilepath, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!ofs) {
+        throw std::runtime_error("Cannot write file \'" + temporaryFilepath + "\' - error while opening for write");
+    }
+    Header header{};
+    ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    SectionWriter writer{ ofs };
+    const auto writeHierarchy = [&](const BVH& bvh) {
+        writer.writeValue(HierarchyRecord{ bvh.depth_, bvh.maxLeafSize_ });
+        writer.write(bvh.nodes_);
+        writer.write(bvh.primitiveIndices_);
+    };
+
+    std::vector<LightRecord> lights;
+    for (const PointLight& light : scene.lights_) {
+        lights.push_back(toRecord(light));
+    }
+    std::vector<MaterialRecord> materials;
+    for (MaterialTable::Index index = 0; index < scene.materials_.size(); index++) {
+        materials.push_back(toRecord(scene.materials_.get(index)));
+    }
+    writer.write(lights);
+    writer.write(materials);
+
+    writer.write(scene.spheres_.centerX);
+    writer.write(scene.spheres_.centerY);
+    writer.write(scene.spheres_.centerZ);
+    writer.write(scene.spheres_.radius);
+    writer.write(scene.spheres_.material);
+
+    writer.write(scene.triangles_.vert0X);
+    writer.write(scene.triangles_.vert0Y);
+    writer.write(scene.triangles_.vert0Z);
+    writer.write(scene.triangles_.edge1X);
+    writer.write(scene.triangles_.edge1Y);
+    writer.write(scene.triangles_.edge1Z);
+    writer.write(scene.triangles_.edge2X);
+    writer.write(scene.triangles_.edge2Y);
+    writer.write(scene.triangles_.edge2Z);
+    writer.write(scene.triangles_.normalX);
+    writer.write(scene.triangles_.normalY);
+    writer.write(scene.triangles_.normalZ);
+    writer.write(scene.triangles_.material);
+
+    writer.write(scene.meshes_.firstPrimitive);
+    writer.write(scene.meshes_.material);
+    for (const TriangleMesh& mesh : scene.meshes_.mesh) {
+        writer.write(mesh.buffers_->vertices);
+        writer.write(mesh.buffers_->indices);
+        writeHierarchy(mesh.buffers_->bvh);
+    }
+
+    writer.writeValue(static_cast<uint64_t>(scene.numPrimitives_));
+    writeHierarchy(scene.sphereBvh_);
+    writeHierarchy(scene.triangleBvh_);
+    writeHierarchy(scene.meshBvh_);
+
+    // section table goes last, then the header is filled in now that its location is known
+    const size_t tableOffset = static_cast<size_t>(ofs.tellp());
+    const size_t padding = (alignof(Section) - tableOffset % alignof(Section)) % alignof(Section);
+    const char zeros[alignof(Section)]{};
+    ofs.write(zeros, padding);
+    ofs.write(reinterpret_cast<const char*>(writer.sections().data()), writer.sections().size() * sizeof(Section));
+
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version     = VERSION;
+    header.endianness  = ENDIANNESS_MARKER;
+    header.vectorSize  = sizeof(Vec3);
+    header.nodeSize    = sizeof(BVH::Node);
+    header.fingerprint = sceneFingerprint;
+    header.tableOffset = tableOffset + padding;
+    header.numSections = writer.sections().size();
+    ofs.seekp(0);
+    ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    ofs.close();
+    if (!ofs) {
+        throw std::runtime_error("Cannot write file \'" + temporaryFilepath + "\' - error while writing");
+    }
+    std::filesystem::rename(temporaryFilepath, filepath);
+}
+
+// beyond each section lying within the file, every index the renderer follows is checked to be in range, so that a
+// corrupt cache fails here rather than reading out of bounds while tracing
+CompiledScene SceneCache::read(const std::string& filepath) {
+    const MappedFile file{ filepath };
+    SectionReader reader{ file, filepath };
+    CompiledScene scene{};
+    const auto readHierarchy = [&](BVH& bvh, size_t numPrimitives, const std::string& name) {
+        const HierarchyRecord record = reader.nextValue<HierarchyRecord>();
+        bvh.depth_            = static_cast<size_t>(record.depth);
+        bvh.maxLeafSize_      = static_cast<size_t>(record.maxLeafSize);
+        bvh.nodes_            = reader.nextVector<BVH::Node>();
+        bvh.primitiveIndices_ = reader.nextVector<uint32_t>();
+        if (bvh.depth_ > BVH::MAX_DEPTH || bvh.primitiveIndices_.size() != numPrimitives ||
+            (bvh.nodes_.empty() != (numPrimitives == 0))) {
+            reader.fail(name + " hierarchy does not match its primitives");
+        }
+        for (uint32_t index : bvh.primitiveIndices_) {
+            if (index >= numPrimitives) {
+                reader.fail(name + " hierarchy primitive is out of range");
+            }
+        }
+
+        // children always follow their parent, so walking from the root visits each node once unless nodes are shared
+        std::vector<std::pair<uint32_t, size_t>> pending;
+        if (!bvh.nodes_.empty()) {
+            pending.push_back({ 0, 1 });
+        }
+        size_t numVisited = 0;
+        while (!pending.empty()) {
+            const auto [index, depth] = pending.back();
+            pending.pop_back();
+            const BVH::Node& node = bvh.nodes_[index];
+            if (++numVisited > bvh.nodes_.size() || depth > BVH::MAX_DEPTH) {
+                reader.fail(name + " hierarchy is not a tree");
+            }
+            if (node.isLeaf()) {
+                if (static_cast<uint64_t>(node.offset) + node.count > numPrimitives) {
+                    reader.fail(name + " hierarchy leaf is out of range");
+                }
+            } else {
+                if (index + 1 >= bvh.nodes_.size() || node.offset <= index + 1 || node.offset >= bvh.nodes_.size()) {
+                    reader.fail(name + " hierarchy child is out of range");
+                }
+                pending.push_back({ node.offset, depth + 1 });
+                pending.push_back({ index + 1,   depth + 1 });
+            }
+        }
+        if (numVisited != bvh.nodes_.size()) {
+            reader.fail(name + " hierarchy has unreachable nodes");
+        }
+    };
+    const auto checkMaterials = [&](const std::vector<uint32_t>& materials, const std::string& name) {
+        for (uint32_t material : materials) {
+            if (material >= scene.materials_.size()) {
+                reader.fail(name + " material is out of range");
+            }
+        }
+    };
+
+    for (const LightRecord& record : reader.next<LightRecord>()) {
+        if (!isValid(record)) {
+            reader.fail("light has invalid position, intensity or attenuation");
+        }
+        scene.lights_.push_back(fromRecord(record));
+    }
+    scene.buildLightHierarchy();
+    for (const MaterialRecord& record : reader.next<MaterialRecord>()) {
+        if (!isValid(record)) {
+            reader.fail("material has invalid weights or shininess");
+        }
+        if (scene.materials_.add(fromRecord(record)) != scene.materials_.size() - 1) {
+            reader.fail("duplicate material");
+        }
+    }
+
+    scene.spheres_.centerX  = reader.nextVector<float>();
+    scene.spheres_.centerY  = reader.nextVector<float>();
+    scene.spheres_.centerZ  = reader.nextVector<float>();
+    scene.spheres_.radius   = reader.nextVector<float>();
+    scene.spheres_.material = reader.nextVector<uint32_t>();
+    // geometry is padded past the last sphere, for packs loaded at the end of the last leaf
+    const size_t numSpheres = scene.spheres_.material.size();
+    for (const std::vector<float>* values : { &scene.spheres_.centerX, &scene.spheres_.centerY,
+                                              &scene.spheres_.centerZ, &scene.spheres_.radius }) {
+        if (values->size() != numSpheres + Simd::PADDING) {
+            reader.fail("sphere arrays differ in length");
+        }
+    }
+    checkMaterials(scene.spheres_.material, "sphere");
+
+    scene.triangles_.vert0X   = reader.nextVector<float>();
+    scene.triangles_.vert0Y   = reader.nextVector<float>();
+    scene.triangles_.vert0Z   = reader.nextVector<float>();
+    scene.triangles_.edge1X   = reader.nextVector<float>();
+    scene.triangles_.edge1Y   = reader.nextVector<float>();
+    scene.triangles_.edge1Z   = reader.nextVector<float>();
+    scene.triangles_.edge2X   = reader.nextVector<float>();
+    scene.triangles_.edge2Y   = reader.nextVector<float>();
+    scene.triangles_.edge2Z   = reader.nextVector<float>();
+    scene.triangles_.normalX  = reader.nextVector<float>();
+    scene.triangles_.normalY  = reader.nextVector<float>();
+    scene.triangles_.normalZ  = reader.nextVector<float>();
+    scene.triangles_.material = reader.nextVector<uint32_t>();
+    const size_t numTriangles = scene.triangles_.material.size();
+    for (const std::vector<float>* values : { &scene.triangles_.vert0X,  &scene.triangles_.vert0Y,  &scene.triangles_.vert0Z,
+                                              &scene.triangles_.edge1X,  &scene.triangles_.edge1Y,  &scene.triangles_.edge1Z,
+                                              &scene.triangles_.edge2X,  &scene.triangles_.edge2Y,  &scene.triangles_.edge2Z,
+                                              &scene.triangles_.normalX, &scene.triangles_.normalY, &scene.triangles_.normalZ }) {
+        if (values->size() != numTriangles) {
+            reader.fail("triangle arrays differ in length");
+        }
+    }
+    checkMaterials(scene.triangles_.material, "triangle");
+
+    scene.meshes_.firstPrimitive = reader.nextVector<uint32_t>();
+    scene.meshes_.material       = reader.nextVector<uint32_t>();
+    if (scene.meshes_.firstPrimitive.size() != scene.meshes_.material.size()) {
+        reader.fail("mesh arrays differ in length");
+    }
+    checkMaterials(scene.meshes_.material, "mesh");
+    uint64_t numPrimitives = numSpheres + numTriangles;
+    for (size_t i = 0; i < scene.meshes_.material.size(); i++) {
+        auto buffers = std::make_shared<TriangleMesh::Buffers>();
+        buffers->vertices = reader.nextVector<Vec3>();
+        buffers->indices  = reader.nextVector<uint32_t>();
+        if (buffers->indices.size() % 3 != 0) {
+            reader.fail("mesh indices do not form triangles");
+        }
+        for (uint32_t index : buffers->indices) {
+            if (index >= buffers->vertices.size()) {
+                reader.fail("mesh vertex index is out of range");
+            }
+        }
+        readHierarchy(buffers->bvh, buffers->indices.size() / 3, "mesh");
+        if (scene.meshes_.firstPrimitive[i] != numPrimitives) {
+            reader.fail("mesh primitives are out of order");
+        }
+        numPrimitives += buffers->indices.size() / 3;
+        scene.meshes_.mesh.push_back(TriangleMesh(std::move(buffers), scene.materials_.get(scene.meshes_.material[i])));
+    }
+
+    const uint64_t storedNumPrimitives = reader.nextValue<uint64_t>();
+    if (storedNumPrimitives != numPrimitives || numPrimitives >= Intersection::NO_INDEX) {
+        reader.fail("primitive count does not match the stored primitives");
+    }
+    scene.numPrimitives_ = static_cast<size_t>(numPrimitives);
+    readHierarchy(scene.sphereBvh_,   numSpheres,                "sphere");
+    readHierarchy(scene.triangleBvh_, numTriangles,              "triangle");
+    readHierarchy(scene.meshBvh_,     scene.meshes_.mesh.size(), "mesh");
+    return scene;
+}
+
+bool SceneCache::isUpToDate(const std::string& filepath, uint64_t sceneFingerprint) {
+    if (!std::filesystem::exists(filepath)) {
+        return false;
+    }
+    try {
+        const MappedFile file{ filepath };
+        const SectionReader reader{ file, filepath };
+        return reader.header().fingerprint == sceneFingerprint;
+    } catch (const std::runtime_error&) {
+        return false;
+    }
+}
+
+
+uint64_t SceneCache::fingerprint(const Scene& scene) {
+    Fingerprint fingerprint{};
+    fingerprint.add(static_cast<uint64_t>(VERSION));
+    fingerprint.add(static_cast<uint64_t>(scene.getNumLights()));
+    for (size_t index = 0; index < scene.getNumLights(); index++) {
+        const ILight& light = scene.getLight(index);
+        fingerprint.add(light.position());
+        fingerprint.add(light.intensity());
+        if (const PointLight* pointLight = dynamic_cast<const PointLight*>(&light)) {
+            fingerprint.add(pointLight->attenuationConstant());
+            fingerprint.add(pointLight->attenuationLinear());
+            fingerprint.add(pointLight->attenuationQuadratic());
+        }
+    }
+
+    fingerprint.add(static_cast<uint64_t>(scene.getNumObjects()));
+    for (size_t index = 0; index < scene.getNumObjects(); index++) {
+        const IObject& object = scene.getObject(index);
+        fingerprint.add(object.material());
+        if (const Sphere* sphere = dynamic_cast<const Sphere*>(&object)) {
+            fingerprint.add(uint64_t{ 1 });
+            fingerprint.add(sphere->center());
+            fingerprint.add(sphere->radius());
+        } else if (const Triangle* triangle = dynamic_cast<const Triangle*>(&object)) {
+            fingerprint.add(uint64_t{ 2 });
+            fingerprint.add(triangle->vert0());
+            fingerprint.add(triangle->vert1());
+            fingerprint.add(triangle->vert2());
+        } else if (const TriangleMesh* mesh = dynamic_cast<const TriangleMesh*>(&object)) {
+            fingerprint.add(uint64_t{ 3 });
+            fingerprint.add(static_cast<uint64_t>(mesh->numVertices()));
+            fingerprint.add(static_cast<uint64_t>(mesh->numTriangles()));
+            for (const Vec3& vertex : mesh->buffers_->vertices) {
+                fingerprint.add(vertex);
+            }
+            fingerprint.add(mesh->buffers_->indices.data(), mesh->buffers_->indices.size() * sizeof(uint32_t));
+        }
+    }
+    return fingerprint.value();
+}
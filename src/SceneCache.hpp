@@ -0,0 +1,32 @@
+#pragma once
+#include "Scene.hpp"
+#include "CompiledScene.hpp"
+#include <string>
+#include <cstdint>
+
+
+/*
+Versioned binary snapshot of a compiled scene, including its prebuilt bounding volume hierarchies, for skipping
+scene compilation on repeat renders.
+
+The file is a fixed header followed by a flat sequence of raw arrays (each 64 byte aligned, and located via a table
+of file relative offsets at the end), holding exactly the arrays a `CompiledScene` traces over. Reading maps the
+file into memory and bulk copies each array into place, with no parsing or hierarchy construction.
+
+Caches store a fingerprint of the scene they were compiled from, so stale caches can be detected and replaced, as
+well as the format version, byte order and vector layout, with caches written by any other build rejected rather than
+misread.
+*/
+class SceneCache {
+public:
+    static constexpr uint32_t VERSION = 3;
+
+    static void          write(const std::string& filepath, const CompiledScene& scene, uint64_t sceneFingerprint);
+    static CompiledScene read(const std::string& filepath);
+
+    // whether a readable cache exists at given path, written by this version for a scene with given fingerprint
+    static bool isUpToDate(const std::string& filepath, uint64_t sceneFingerprint);
+
+    // hash of everything in a scene that affects its compiled form
+    static uint64_t fingerprint(const Scene& scene);
+};
@@ -0,0 +1,198 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <bit>
+#include <cmath>
+
+#if defined(__AVX2__)
+    #include <immintrin.h>
+    #define RAYTRACER_SIMD_AVX2
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define RAYTRACER_SIMD_SSE
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    #include <arm_neon.h>
+    #define RAYTRACER_SIMD_NEON
+#endif
+
+
+/*
+Minimal packs of floats for writing a kernel once and running it over N lanes at a time.
+
+`Simd::FloatN` is the widest pack the target was compiled for (8 lanes with AVX2, 4 with SSE or NEON), while
+`Simd::Float1` is a plain scalar fallback exposing the same interface. Comparisons produce masks whose `bits()`
+packs one bit per lane (lane 0 in the lowest bit), so lane selection can be done with plain integer ops.
+
+Arrays read by a pack must be readable up to the next multiple of its width, for which `Simd::PADDING` extra
+trailing elements are always sufficient.
+*/
+namespace Simd {
+
+    inline constexpr size_t PADDING = 8;
+
+    // mask with the lowest `count` lanes set, saturating at the given width
+    inline constexpr uint32_t firstLanes(size_t count, size_t width) {
+        return count >= width ? (1u << width) - 1u : (1u << count) - 1u;
+    }
+
+    // index of lowest set lane in a non-empty mask
+    inline int lowestLane(uint32_t bits) {
+        return std::countr_zero(bits);
+    }
+
+
+
+    struct Mask1 {
+        bool v;
+        inline uint32_t bits() const { return v ? 1u : 0u; }
+    };
+    inline Mask1 operator&(Mask1 a, Mask1 b) { return { a.v && b.v }; }
+    inline Mask1 operator|(Mask1 a, Mask1 b) { return { a.v || b.v }; }
+
+    struct Float1 {
+        float v;
+        static constexpr size_t width = 1;
+
+        static inline Float1 load(const float* p)   { return { *p }; }
+        static inline Float1 broadcast(float value) { return { value }; }
+        inline void  store(float* p)   const { *p = v; }
+        inline float horizontalMin()   const { return v; }
+    };
+    inline Float1 operator+(Float1 a, Float1 b) { return { a.v + b.v }; }
+    inline Float1 operator-(Float1 a, Float1 b) { return { a.v - b.v }; }
+    inline Float1 operator*(Float1 a, Float1 b) { return { a.v * b.v }; }
+    inline Float1 operator/(Float1 a, Float1 b) { return { a.v / b.v }; }
+    inline Float1 operator-(Float1 a)           { return { -a.v }; }
+    inline Mask1  operator< (Float1 a, Float1 b) { return { a.v <  b.v }; }
+    inline Mask1  operator<=(Float1 a, Float1 b) { return { a.v <= b.v }; }
+    inline Mask1  operator> (Float1 a, Float1 b) { return { a.v >  b.v }; }
+    inline Mask1  operator>=(Float1 a, Float1 b) { return { a.v >= b.v }; }
+    inline Mask1  operator==(Float1 a, Float1 b) { return { a.v == b.v }; }
+    inline Float1 min(Float1 a, Float1 b)  { return { a.v <= b.v ? a.v : b.v }; }
+    inline Float1 max(Float1 a, Float1 b)  { return { a.v >= b.v ? a.v : b.v }; }
+    inline Float1 sqrt(Float1 a)           { return { std::sqrt(a.v) }; }
+    inline Float1 select(Mask1 m, Float1 a, Float1 b) { return { m.v ? a.v : b.v }; }
+
+
+
+#if defined(RAYTRACER_SIMD_SSE)
+    struct Mask4 {
+        __m128 v;
+        inline uint32_t bits() const { return static_cast<uint32_t>(_mm_movemask_ps(v)); }
+    };
+    inline Mask4 operator&(Mask4 a, Mask4 b) { return { _mm_and_ps(a.v, b.v) }; }
+    inline Mask4 operator|(Mask4 a, Mask4 b) { return { _mm_or_ps(a.v, b.v) }; }
+
+    struct Float4 {
+        __m128 v;
+        static constexpr size_t width = 4;
+
+        static inline Float4 load(const float* p)   { return { _mm_loadu_ps(p) }; }
+        static inline Float4 broadcast(float value) { return { _mm_set1_ps(value) }; }
+        inline void store(float* p) const { _mm_storeu_ps(p, v); }
+        inline float horizontalMin() const {
+            const __m128 pairs = _mm_min_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+            return _mm_cvtss_f32(_mm_min_ps(pairs, _mm_shuffle_ps(pairs, pairs, _MM_SHUFFLE(1, 0, 3, 2))));
+        }
+    };
+    inline Float4 operator+(Float4 a, Float4 b) { return { _mm_add_ps(a.v, b.v) }; }
+    inline Float4 operator-(Float4 a, Float4 b) { return { _mm_sub_ps(a.v, b.v) }; }
+    inline Float4 operator*(Float4 a, Float4 b) { return { _mm_mul_ps(a.v, b.v) }; }
+    inline Float4 operator/(Float4 a, Float4 b) { return { _mm_div_ps(a.v, b.v) }; }
+    inline Float4 operator-(Float4 a)           { return { _mm_xor_ps(a.v, _mm_set1_ps(-0.00f)) }; }
+    inline Mask4  operator< (Float4 a, Float4 b) { return { _mm_cmplt_ps(a.v, b.v) }; }
+    inline Mask4  operator<=(Float4 a, Float4 b) { return { _mm_cmple_ps(a.v, b.v) }; }
+    inline Mask4  operator> (Float4 a, Float4 b) { return { _mm_cmpgt_ps(a.v, b.v) }; }
+    inline Mask4  operator>=(Float4 a, Float4 b) { return { _mm_cmpge_ps(a.v, b.v) }; }
+    inline Mask4  operator==(Float4 a, Float4 b) { return { _mm_cmpeq_ps(a.v, b.v) }; }
+    inline Float4 min(Float4 a, Float4 b)  { return { _mm_min_ps(a.v, b.v) }; }
+    inline Float4 max(Float4 a, Float4 b)  { return { _mm_max_ps(a.v, b.v) }; }
+    inline Float4 sqrt(Float4 a)           { return { _mm_sqrt_ps(a.v) }; }
+    inline Float4 select(Mask4 m, Float4 a, Float4 b) {
+        return { _mm_or_ps(_mm_and_ps(m.v, a.v), _mm_andnot_ps(m.v, b.v)) };
+    }
+#elif defined(RAYTRACER_SIMD_NEON)
+    struct Mask4 {
+        uint32x4_t v;
+        inline uint32_t bits() const {
+            static const uint32_t weights[4] = { 1, 2, 4, 8 };
+            return vaddvq_u32(vandq_u32(v, vld1q_u32(weights)));
+        }
+    };
+    inline Mask4 operator&(Mask4 a, Mask4 b) { return { vandq_u32(a.v, b.v) }; }
+    inline Mask4 operator|(Mask4 a, Mask4 b) { return { vorrq_u32(a.v, b.v) }; }
+
+    struct Float4 {
+        float32x4_t v;
+        static constexpr size_t width = 4;
+
+        static inline Float4 load(const float* p)   { return { vld1q_f32(p) }; }
+        static inline Float4 broadcast(float value) { return { vdupq_n_f32(value) }; }
+        inline void  store(float* p)   const { vst1q_f32(p, v); }
+        inline float horizontalMin()   const { return vminvq_f32(v); }
+    };
+    inline Float4 operator+(Float4 a, Float4 b) { return { vaddq_f32(a.v, b.v) }; }
+    inline Float4 operator-(Float4 a, Float4 b) { return { vsubq_f32(a.v, b.v) }; }
+    inline Float4 operator*(Float4 a, Float4 b) { return { vmulq_f32(a.v, b.v) }; }
+    inline Float4 operator/(Float4 a, Float4 b) { return { vdivq_f32(a.v, b.v) }; }
+    inline Float4 operator-(Float4 a)           { return { vnegq_f32(a.v) }; }
+    inline Mask4  operator< (Float4 a, Float4 b) { return { vcltq_f32(a.v, b.v) }; }
+    inline Mask4  operator<=(Float4 a, Float4 b) { return { vcleq_f32(a.v, b.v) }; }
+    inline Mask4  operator> (Float4 a, Float4 b) { return { vcgtq_f32(a.v, b.v) }; }
+    inline Mask4  operator>=(Float4 a, Float4 b) { return { vcgeq_f32(a.v, b.v) }; }
+    inline Mask4  operator==(Float4 a, Float4 b) { return { vceqq_f32(a.v, b.v) }; }
+    inline Float4 min(Float4 a, Float4 b)  { return { vminq_f32(a.v, b.v) }; }
+    inline Float4 max(Float4 a, Float4 b)  { return { vmaxq_f32(a.v, b.v) }; }
+    inline Float4 sqrt(Float4 a)           { return { vsqrtq_f32(a.v) }; }
+    inline Float4 select(Mask4 m, Float4 a, Float4 b) { return { vbslq_f32(m.v, a.v, b.v) }; }
+#endif
+
+
+
+#if defined(RAYTRACER_SIMD_AVX2)
+    struct Mask8 {
+        __m256 v;
+        inline uint32_t bits() const { return static_cast<uint32_t>(_mm256_movemask_ps(v)); }
+    };
+    inline Mask8 operator&(Mask8 a, Mask8 b) { return { _mm256_and_ps(a.v, b.v) }; }
+    inline Mask8 operator|(Mask8 a, Mask8 b) { return { _mm256_or_ps(a.v, b.v) }; }
+
+    struct Float8 {
+        __m256 v;
+        static constexpr size_t width = 8;
+
+        static inline Float8 load(const float* p)   { return { _mm256_loadu_ps(p) }; }
+        static inline Float8 broadcast(float value) { return { _mm256_set1_ps(value) }; }
+        inline void store(float* p) const { _mm256_storeu_ps(p, v); }
+        inline float horizontalMin() const {
+            const __m128 halves = _mm_min_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+            const __m128 pairs  = _mm_min_ps(halves, _mm_shuffle_ps(halves, halves, _MM_SHUFFLE(2, 3, 0, 1)));
+            return _mm_cvtss_f32(_mm_min_ps(pairs, _mm_shuffle_ps(pairs, pairs, _MM_SHUFFLE(1, 0, 3, 2))));
+        }
+    };
+    inline Float8 operator+(Float8 a, Float8 b) { return { _mm256_add_ps(a.v, b.v) }; }
+    inline Float8 operator-(Float8 a, Float8 b) { return { _mm256_sub_ps(a.v, b.v) }; }
+    inline Float8 operator*(Float8 a, Float8 b) { return { _mm256_mul_ps(a.v, b.v) }; }
+    inline Float8 operator/(Float8 a, Float8 b) { return { _mm256_div_ps(a.v, b.v) }; }
+    inline Float8 operator-(Float8 a)           { return { _mm256_xor_ps(a.v, _mm256_set1_ps(-0.00f)) }; }
+    inline Mask8  operator< (Float8 a, Float8 b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ) }; }
+    inline Mask8  operator<=(Float8 a, Float8 b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ) }; }
+    inline Mask8  operator> (Float8 a, Float8 b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ) }; }
+    inline Mask8  operator>=(Float8 a, Float8 b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ) }; }
+    inline Mask8  operator==(Float8 a, Float8 b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_EQ_OQ) }; }
+    inline Float8 min(Float8 a, Float8 b)  { return { _mm256_min_ps(a.v, b.v) }; }
+    inline Float8 max(Float8 a, Float8 b)  { return { _mm256_max_ps(a.v, b.v) }; }
+    inline Float8 sqrt(Float8 a)           { return { _mm256_sqrt_ps(a.v) }; }
+    inline Float8 select(Mask8 m, Float8 a, Float8 b) { return { _mm256_blendv_ps(b.v, a.v, m.v) }; }
+
+    using FloatN = Float8;
+#elif defined(RAYTRACER_SIMD_SSE) || defined(RAYTRACER_SIMD_NEON)
+    using FloatN = Float4;
+#else
+    using FloatN = Float1;
+#endif
+
+    inline constexpr size_t WIDTH = FloatN::width;
+    static_assert(WIDTH <= PADDING, "padding must cover at least one full pack");
+}
@@ -17,9 +17,10 @@ public:
     bool   isFinished()  const;
     double elapsedTime() const;
 
+    // seconds since an arbitrary fixed point, consistent across threads
+    static double currentTime();
+
 private:
     std::optional<double> startTime_;
     std::optional<double> stopTime_;
-
-    static double currentTime();
 };
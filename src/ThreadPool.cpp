@@ -0,0 +1,120 @@
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <utility>
+
+
+ThreadPool::ThreadPool(size_t numThreads)
+    : numThreads_(numThreads == 0 ? hardwareConcurrency() : numThreads),
+      workers_   (),
+      ranges_    (std::make_unique<TaskRange[]>(numThreads_)) {
+    workers_.reserve(numThreads_ - 1);
+    for (size_t workerIndex = 1; workerIndex < numThreads_; workerIndex++) {
+        workers_.emplace_back(&ThreadPool::workerLoop, this, workerIndex);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    jobStarted_.notify_all();
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+}
+
+size_t ThreadPool::numThreads() const {
+    return numThreads_;
+}
+
+size_t ThreadPool::hardwareConcurrency() {
+    return std::max<size_t>(1, std::thread::hardware_concurrency());
+}
+
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t, size_t)>& task) {
+    if (count == 0) {
+        return;
+    }
+    if (numThreads_ == 1 || count == 1) {
+        for (size_t index = 0; index < count; index++) {
+            task(index, 0);
+        }
+        return;
+    }
+
+    // ranges are only written while every worker is parked, and published to them by the lock below
+    for (size_t workerIndex = 0; workerIndex < numThreads_; workerIndex++) {
+        ranges_[workerIndex].next.store((count * workerIndex) / numThreads_, std::memory_order_relaxed);
+        ranges_[workerIndex].end = (count * (workerIndex + 1)) / numThreads_;
+    }
+    cancelled_.store(false, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        task_           = &task;
+        numBusyWorkers_ = workers_.size();
+        jobGeneration_++;
+    }
+    jobStarted_.notify_all();
+
+    runTasks(0);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    jobFinished_.wait(lock, [this] { return numBusyWorkers_ == 0; });
+    task_ = nullptr;
+    if (firstError_) {
+        std::rethrow_exception(std::exchange(firstError_, nullptr));
+    }
+}
+
+void ThreadPool::workerLoop(size_t workerIndex) {
+    size_t lastGeneration = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            jobStarted_.wait(lock, [&] { return stopping_ || jobGeneration_ != lastGeneration; });
+            if (stopping_) {
+                return;
+            }
+            lastGeneration = jobGeneration_;
+        }
+
+        runTasks(workerIndex);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (--numBusyWorkers_ == 0) {
+            jobFinished_.notify_one();
+        }
+    }
+}
+
+// drain own range first, then steal from every other worker's range, starting with the next one over
+// a throwing task cancels the job, keeping only the first exception for parallelFor to rethrow on the calling thread
+void ThreadPool::runTasks(size_t workerIndex) {
+    const std::function<void(size_t, size_t)>& task = *task_;
+    try {
+        for (size_t offset = 0; offset < numThreads_; offset++) {
+            TaskRange& range = ranges_[(workerIndex + offset) % numThreads_];
+            for (size_t index = range.next.fetch_add(1, std::memory_order_relaxed);
+                 index < range.end && !cancelled_.load(std::memory_order_relaxed);
+                 index = range.next.fetch_add(1, std::memory_order_relaxed)) {
+                task(index, workerIndex);
+            }
+        }
+    } catch (...) {
+        cancelled_.store(true, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!firstError_) {
+            firstError_ = std::current_exception();
+        }
+    }
+}
+
+
+std::ostream& operator<<(std::ostream& os, const ThreadPool& threadPool) {
+    os << "ThreadPool("
+         << "thread-count:" << threadPool.numThreads()
+       << ")";
+    return os;
+}
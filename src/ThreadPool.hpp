@@ -0,0 +1,68 @@
+#pragma once
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <exception>
+#include <iostream>
+
+
+/*
+Persistent pool of worker threads for running a fixed number of independent tasks (e.g. image tiles) in parallel.
+
+Threads are started once and then parked between jobs, so a pool can be reused across frames without paying for
+thread creation each time. The calling thread participates as worker zero, so a pool of size one runs everything
+inline without spawning anything.
+
+Each job's task indices are split into one contiguous range per worker, claimed front to back through an atomic
+cursor. Once a worker drains its own range, it steals from the others' ranges using that same cursor, so load stays
+balanced when some tasks (e.g. tiles full of reflective geometry) cost far more than others, without any locking
+on the hot path. Neighboring indices mostly stay on one thread, which keeps tiles that share geometry cache friendly.
+*/
+class ThreadPool {
+public:
+    ThreadPool(const ThreadPool&)            = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // zero threads means one per hardware thread
+    explicit ThreadPool(size_t numThreads = 0);
+    ~ThreadPool();
+
+    size_t numThreads() const;
+
+    // run task(index, workerIndex) for every index in [0, count), blocking until all have finished
+    // not reentrant, so tasks must not themselves call into the same pool
+    // if any task throws, no further indices are handed out, and the first exception is rethrown here once every
+    // worker has stopped
+    void parallelFor(size_t count, const std::function<void(size_t, size_t)>& task);
+
+    static size_t hardwareConcurrency();
+
+private:
+    // padded to a cache line each, so workers claiming from their own range don't contend with each other
+    struct alignas(64) TaskRange {
+        std::atomic<size_t> next{ 0 };
+        size_t              end { 0 };
+    };
+
+    size_t                       numThreads_;
+    std::vector<std::thread>     workers_;
+    std::unique_ptr<TaskRange[]> ranges_;
+
+    std::mutex              mutex_;
+    std::condition_variable jobStarted_;
+    std::condition_variable jobFinished_;
+    size_t                  jobGeneration_{ 0 };
+    size_t                  numBusyWorkers_{ 0 };
+    bool                    stopping_{ false };
+    const std::function<void(size_t, size_t)>* task_{ nullptr };
+    std::atomic<bool>       cancelled_{ false };
+    std::exception_ptr      firstError_;  // guarded by mutex_
+
+    void workerLoop(size_t workerIndex);
+    void runTasks(size_t workerIndex);
+};
+std::ostream& operator<<(std::ostream& os, const ThreadPool& threadPool);
@@ -0,0 +1,222 @@
+#include "TriangleMesh.hpp"
+#include "Math.hpp"
+#include "Ray.hpp"
+#include "AABB.hpp"
+#include "BVH.hpp"
+#include <vector>
+#include <sstream>
+#include <utility>
+#include <stdexcept>
+#include <assert.h>
+
+
+namespace {
+
+    // ray transformed such that its direction becomes +z, by permuting the dominant axis into z, then shearing
+    // the other two axes by the (constant) ratios Sx and Sy, and scaling distance along z by Sz
+    struct ShearedRay {
+        size_t kx;
+        size_t ky;
+        size_t kz;
+        float  Sx;
+        float  Sy;
+        float  Sz;
+
+        explicit ShearedRay(const Ray& ray) {
+            const Vec3& d = ray.direction;
+            kz = (std::abs(d.x) > std::abs(d.y))
+                ? (std::abs(d.x) > std::abs(d.z) ? 0 : 2)
+                : (std::abs(d.y) > std::abs(d.z) ? 1 : 2);
+            kx = (kz + 1) % 3;
+            ky = (kx + 1) % 3;
+            // swap to preserve the winding of the triangle
+            if (d[kz] < 0.00f) {
+                std::swap(kx, ky);
+            }
+            Sx = d[kx] / d[kz];
+            Sy = d[ky] / d[kz];
+            Sz = 1.00f / d[kz];
+        }
+    };
+
+    // watertight ray-triangle test (Woop, Benthin, Wald 2013), accepting hits at distances in [0, tMax)
+    //
+    // after shearing, edge functions U, V, W are 2D cross products of the vertices as seen from the ray; the ray
+    // passes through the triangle iff they all share a sign, with their sum being the determinant used for
+    // (un-normalized) barycentric interpolation of the vertices' depths
+    bool intersectSheared(const ShearedRay& s, const Ray& ray, const Vec3& v0, const Vec3& v1, const Vec3& v2,
+                          float tMax, float& t) {
+        const Vec3 A = v0 - ray.origin;
+        const Vec3 B = v1 - ray.origin;
+        const Vec3 C = v2 - ray.origin;
+        const float Ax = A[s.kx] - s.Sx * A[s.kz];
+        const float Ay = A[s.ky] - s.Sy * A[s.kz];
+        const float Bx = B[s.kx] - s.Sx * B[s.kz];
+        const float By = B[s.ky] - s.Sy * B[s.kz];
+        const float Cx = C[s.kx] - s.Sx * C[s.kz];
+        const float Cy = C[s.ky] - s.Sy * C[s.kz];
+
+        float U = Cx * By - Cy * Bx;
+        float V = Ax * Cy - Ay * Cx;
+        float W = Bx * Ay - By * Ax;
+        // a zero edge function means the ray grazes that edge, so recompute in double for a consistent sign
+        if (U == 0.00f || V == 0.00f || W == 0.00f) {
+            U = static_cast<float>(static_cast<double>(Cx) * By - static_cast<double>(Cy) * Bx);
+            V = static_cast<float>(static_cast<double>(Ax) * Cy - static_cast<double>(Ay) * Cx);
+            W = static_cast<float>(static_cast<double>(Bx) * Ay - static_cast<double>(By) * Ax);
+        }
+        if ((U < 0.00f || V < 0.00f || W < 0.00f) && (U > 0.00f || V > 0.00f || W > 0.00f)) {
+            return false;
+        }
+        const float determinant = U + V + W;
+        if (determinant == 0.00f) {
+            return false;
+        }
+
+        // range check the scaled distance before dividing, with comparisons flipped for back facing triangles
+        const float T = U * (s.Sz * A[s.kz]) + V * (s.Sz * B[s.kz]) + W * (s.Sz * C[s.kz]);
+        if (determinant > 0.00f ? (T < 0.00f || T >= tMax * determinant)
+                                : (T > 0.00f || T <= tMax * determinant)) {
+            return false;
+        }
+        t = T / determinant;
+        return true;
+    }
+}
+
+
+TriangleMesh::TriangleMesh(std::vector<Vec3>&& vertices, std::vector<uint32_t>&& indices, const Material& material)
+    : TriangleMesh(buildBuffers(std::move(vertices), std::move(indices)), material) {}
+
+TriangleMesh::TriangleMesh(std::shared_ptr<const Buffers> buffers, const Material& material)
+    : buffers_(std::move(buffers)) {
+    this->position_ = bounds().isEmpty() ? Vec3::zero() : bounds().center();
+    this->material_ = material;
+}
+
+void TriangleMesh::finalizeIntersection(const Ray& ray, float t, uint32_t triangle, Intersection& result) const {
+    result.t         = t;
+    result.point     = ray.origin + ray.direction * t;
+    result.normal    = planeNormal(triangle);
+    result.object    = this;
+    result.primitive = triangle;
+}
+
+bool TriangleMesh::occluded(const Ray& ray, float tMax) const {
+    return occluded(ray, tMax, Intersection::NO_INDEX);
+}
+
+AABB TriangleMesh::bounds() const {
+    return buffers_->bvh.bounds();
+}
+
+std::string TriangleMesh::description() const {
+    std::stringstream ss;
+    ss << "TriangleMesh("
+         << "position:("      << position()     << "),"
+         << "material:"       << material()     << ","
+         << "vertex-count:"   << numVertices()  << ","
+         << "triangle-count:" << numTriangles()
+       << ")";
+    return ss.str();
+}
+
+
+bool TriangleMesh::intersect(const Ray& ray, float& tClosest, uint32_t& triangle) const {
+    const ShearedRay sheared{ ray };
+    const std::vector<Vec3>& vertices = buffers_->vertices;
+    const uint32_t* indices = buffers_->indices.data();
+    return buffers_->bvh.traverseClosest(ray, tClosest, [&](size_t first, size_t count, float& tMax) {
+        bool hit = false;
+        for (size_t i = first; i < first + count; i++) {
+            float t;
+            if (intersectSheared(sheared, ray, vertices[indices[3 * i]], vertices[indices[3 * i + 1]],
+                                 vertices[indices[3 * i + 2]], tMax, t)) {
+                tMax     = t;
+                tClosest = t;
+                triangle = static_cast<uint32_t>(i);
+                hit      = true;
+            }
+        }
+        return hit;
+    });
+}
+
+bool TriangleMesh::occluded(const Ray& ray, float tMax, uint32_t ignoreTriangle) const {
+    const ShearedRay sheared{ ray };
+    const std::vector<Vec3>& vertices = buffers_->vertices;
+    const uint32_t* indices = buffers_->indices.data();
+    return buffers_->bvh.traverseAny(ray, tMax, [&](size_t first, size_t count, float) {
+        for (size_t i = first; i < first + count; i++) {
+            float t;
+            if (i != ignoreTriangle &&
+                intersectSheared(sheared, ray, vertices[indices[3 * i]], vertices[indices[3 * i + 1]],
+                                 vertices[indices[3 * i + 2]], tMax, t)) {
+                return true;
+            }
+        }
+        return false;
+    });
+}
+
+
+size_t TriangleMesh::numVertices() const {
+    return buffers_->vertices.size();
+}
+
+size_t TriangleMesh::numTriangles() const {
+    return buffers_->indices.size() / 3;
+}
+
+Vec3 TriangleMesh::vertex(size_t triangle, size_t corner) const {
+    assert(triangle < numTriangles() && corner < 3);
+    return buffers_->vertices[buffers_->indices[3 * triangle + corner]];
+}
+
+// same orientation as `Triangle::planeNormal`, given the same winding
+Vec3 TriangleMesh::planeNormal(size_t triangle) const {
+    const Vec3 v0 = vertex(triangle, 0);
+    return Math::normalize(Math::cross(vertex(triangle, 1) - v0, vertex(triangle, 2) - v0));
+}
+
+const BVH& TriangleMesh::accelerationStructure() const {
+    return buffers_->bvh;
+}
+
+
+// validate indices, then build the bvh over every triangle and reorder the index triples to match its leaves
+std::shared_ptr<const TriangleMesh::Buffers> TriangleMesh::buildBuffers(std::vector<Vec3>&& vertices,
+                                                                        std::vector<uint32_t>&& indices) {
+    if (indices.size() % 3 != 0) {
+        throw std::invalid_argument("triangle mesh index count must be a multiple of three");
+    }
+    if (indices.empty()) {
+        throw std::invalid_argument("triangle mesh must have at least one triangle");
+    }
+    for (uint32_t index : indices) {
+        if (index >= vertices.size()) {
+            throw std::invalid_argument("triangle mesh index " + std::to_string(index) + " is out of range");
+        }
+    }
+
+    const size_t numTriangles = indices.size() / 3;
+    std::vector<AABB> triangleBounds;
+    triangleBounds.reserve(numTriangles);
+    for (size_t i = 0; i < numTriangles; i++) {
+        triangleBounds.push_back(AABB().expand(vertices[indices[3 * i]])
+                                       .expand(vertices[indices[3 * i + 1]])
+                                       .expand(vertices[indices[3 * i + 2]]));
+    }
+
+    auto buffers = std::make_shared<Buffers>();
+    buffers->bvh = BVH(triangleBounds);
+    buffers->indices.resize(indices.size());
+    for (size_t slot = 0; slot < numTriangles; slot++) {
+        const size_t triangle = buffers->bvh.getPrimitiveIndex(slot);
+        buffers->indices[3 * slot]     = indices[3 * triangle];
+        buffers->indices[3 * slot + 1] = indices[3 * triangle + 1];
+        buffers->indices[3 * slot + 2] = indices[3 * triangle + 2];
+    }
+    buffers->vertices = std::move(vertices);
+    return buffers;
+}
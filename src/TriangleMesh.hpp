@@ -0,0 +1,58 @@
+#pragma once
+#include "Math.hpp"
+#include "Material.hpp"
+#include "Ray.hpp"
+#include "AABB.hpp"
+#include "BVH.hpp"
+#include "Objects.hpp"
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+
+/*
+Indexed triangle mesh with a single material, for assets too large to store each face as its own `Triangle`.
+
+Vertices are stored once and referenced by three indices per triangle, with the triangles reordered on construction
+to match the leaves of the mesh's own bounding volume hierarchy (so triangle indices refer to that order, not the
+input order). The buffers are immutable and shared between copies, making copies of even huge meshes cheap.
+
+Intersection uses the watertight test of Woop et al. (2013), which shears vertices into a space where the ray runs
+along +z, then evaluates each edge function exactly once in a way that is identical for the two triangles sharing
+it. Unlike moller-trumbore, a ray can never slip between adjacent triangles or hit both.
+*/
+class TriangleMesh final : public virtual IObject {
+public:
+    TriangleMesh(std::vector<Vec3>&& vertices, std::vector<uint32_t>&& indices, const Material& material);
+
+    using IObject::intersect;
+    // closest triangle hit before tClosest, on a hit shrinking tClosest to its distance and setting triangle
+    virtual bool intersect(const Ray& ray, float& tClosest, uint32_t& triangle) const override;
+    virtual void finalizeIntersection(const Ray& ray, float t, uint32_t triangle, Intersection& result) const override;
+    virtual bool occluded(const Ray& ray, float tMax) const override;
+    virtual AABB bounds() const override;
+    virtual std::string description() const override;
+
+    // whether any triangle other than the ignored one is hit before tMax
+    bool occluded(const Ray& ray, float tMax, uint32_t ignoreTriangle) const;
+
+    size_t numVertices()  const;
+    size_t numTriangles() const;
+    Vec3 vertex(size_t triangle, size_t corner) const;
+    Vec3 planeNormal(size_t triangle) const;
+    const BVH& accelerationStructure() const;
+
+private:
+    friend class SceneCache;
+
+    struct Buffers {
+        std::vector<Vec3>     vertices;
+        std::vector<uint32_t> indices;
+        BVH                   bvh;
+    };
+    std::shared_ptr<const Buffers> buffers_;
+
+    TriangleMesh(std::shared_ptr<const Buffers> buffers, const Material& material);
+
+    static std::shared_ptr<const Buffers> buildBuffers(std::vector<Vec3>&& vertices, std::vector<uint32_t>&& indices);
+};
@@ -0,0 +1,113 @@
+#include "Material.hpp"
+#include "Objects.hpp"
+#include "Ray.hpp"
+#include "Scene.hpp"
+#include "BVH.hpp"
+#include "TestRays.hpp"
+
+#include "gtest/gtest.h"
+
+#include <random>
+
+namespace {
+
+    Scene createSphereGrid(int numPerSide, float spacing, float radius)
+    {
+        Scene scene{};
+        for (int x = 0; x < numPerSide; x++) {
+            for (int y = 0; y < numPerSide; y++) {
+                for (int z = 0; z < numPerSide; z++) {
+                    scene.addSceneObject(Sphere(Vec3(x * spacing, y * spacing, z * spacing), radius, Material()));
+                }
+            }
+        }
+        return scene;
+    }
+}
+
+TEST(BoundingBox, SphereAndTriangle)
+{
+    Sphere sphere{Vec3(1, 2, 3), 2.00f, Material()};
+    AABB sphereBounds = sphere.bounds();
+    EXPECT_TRUE(Math::isApproximately(sphereBounds.min, Vec3(-1, 0, 1)));
+    EXPECT_TRUE(Math::isApproximately(sphereBounds.max, Vec3( 3, 4, 5)));
+
+    Triangle triangle{Vec3(0, 0, 0), Vec3(4, 0, 1), Vec3(4, 3, 0), Material()};
+    AABB triangleBounds = triangle.bounds();
+    EXPECT_TRUE(Math::isApproximately(triangleBounds.min, Vec3(0, 0, 0)));
+    EXPECT_TRUE(Math::isApproximately(triangleBounds.max, Vec3(4, 3, 1)));
+}
+
+TEST(BoundingBox, RaySlabs)
+{
+    AABB box{Vec3(-1, -1, -1), Vec3(1, 1, 1)};
+    Ray hitting{{-5.0, 0.0, 0.0}, {1.0, 0.0, 0.0}};
+    Ray missing{{-5.0, 2.0, 0.0}, {1.0, 0.0, 0.0}};
+    Ray inside {{ 0.0, 0.0, 0.0}, {0.0, 0.0, 1.0}};
+    const Vec3 invX{1.0f, Math::INF, Math::INF};
+    const Vec3 invZ{Math::INF, Math::INF, 1.0f};
+
+    float tEntry;
+    EXPECT_TRUE(box.intersect(hitting, invX, Math::INF, tEntry));
+    EXPECT_NEAR(tEntry, 4.0f, 0.001f);
+    EXPECT_FALSE(box.intersect(hitting, invX, 3.0f, tEntry));
+    EXPECT_FALSE(box.intersect(missing, invX, Math::INF, tEntry));
+    EXPECT_TRUE(box.intersect(inside, invZ, Math::INF, tEntry));
+    EXPECT_NEAR(tEntry, 0.0f, 0.001f);
+}
+
+TEST(BVH, Empty)
+{
+    BVH bvh{std::vector<AABB>{}};
+    Ray ray{{0.0, 0.0, 0.0}, {0.0, 0.0, 1.0}};
+
+    EXPECT_TRUE(bvh.isEmpty());
+    EXPECT_FALSE(bvh.traverseClosest(ray, Math::INF, [](size_t, size_t, float&) { return true; }));
+    EXPECT_FALSE(bvh.traverseAny(ray, Math::INF, [](size_t, size_t, float) { return true; }));
+}
+
+TEST(BVH, ContainsEveryPrimitiveOnce)
+{
+    Scene scene = createSphereGrid(6, 3.0f, 1.0f);
+    scene.buildAccelerationStructure();
+    const BVH& bvh = scene.accelerationStructure();
+
+    ASSERT_EQ(bvh.numPrimitives(), scene.getNumObjects());
+    std::vector<int> seen(scene.getNumObjects(), 0);
+    for (size_t i = 0; i < bvh.numPrimitives(); i++) {
+        seen[bvh.getPrimitiveIndex(i)]++;
+    }
+    for (int count : seen) {
+        EXPECT_EQ(count, 1);
+    }
+    EXPECT_LE(bvh.depth(), BVH::MAX_DEPTH);
+    EXPECT_LT(bvh.numNodes(), 2 * scene.getNumObjects());
+}
+
+TEST(BVH, MatchesBruteForceIntersection)
+{
+    Scene bruteForce = createSphereGrid(5, 4.0f, 1.5f);
+    Scene accelerated = createSphereGrid(5, 4.0f, 1.5f);
+    bruteForce.addSceneObject(Triangle(Vec3(-50, -2, -50), Vec3(50, -2, -50), Vec3(50, -2, 50), Material()));
+    accelerated.addSceneObject(Triangle(Vec3(-50, -2, -50), Vec3(50, -2, -50), Vec3(50, -2, 50), Material()));
+    accelerated.buildAccelerationStructure();
+    ASSERT_FALSE(bruteForce.hasAccelerationStructure());
+    ASSERT_TRUE(accelerated.hasAccelerationStructure());
+
+    std::mt19937 gen{ 1234 };
+    for (int i = 0; i < 2000; i++) {
+        const Ray ray = TestRays::randomRay(gen, -20.0f, 40.0f);
+
+        Intersection expected;
+        Intersection actual;
+        const bool expectedHit = bruteForce.intersect(ray, expected);
+        const bool actualHit   = accelerated.intersect(ray, actual);
+        ASSERT_EQ(expectedHit, actualHit);
+        if (expectedHit) {
+            EXPECT_NEAR(expected.t, actual.t, 0.001f);
+        }
+
+        const float tMax = 10.0f;
+        EXPECT_EQ(bruteForce.isOccluded(ray, tMax), accelerated.isOccluded(ray, tMax));
+    }
+}
@@ -0,0 +1,68 @@
+#include "Math.hpp"
+#include "Ray.hpp"
+#include "Camera.hpp"
+#include "CameraRayGenerator.hpp"
+
+#include "gtest/gtest.h"
+
+#include <stdexcept>
+
+
+namespace {
+
+    Camera createTestCamera() {
+        Camera camera;
+        camera.setAspectRatio(37.00f / 23.00f);
+        camera.lookAtFrom(Vec3(0.00f, 0.00f, 0.00f), Vec3(0.00f, 50.00f, 150.00f));
+        return camera;
+    }
+
+    // viewport rays go through world space points, so round off by about the camera's distance from the origin
+    void expectSameRay(const Ray& expected, const Ray& actual) {
+        EXPECT_NEAR(expected.origin.x,    actual.origin.x,    1e-4f);
+        EXPECT_NEAR(expected.origin.y,    actual.origin.y,    1e-4f);
+        EXPECT_NEAR(expected.origin.z,    actual.origin.z,    1e-4f);
+        EXPECT_NEAR(expected.direction.x, actual.direction.x, 1e-4f);
+        EXPECT_NEAR(expected.direction.y, actual.direction.y, 1e-4f);
+        EXPECT_NEAR(expected.direction.z, actual.direction.z, 1e-4f);
+    }
+}
+
+
+TEST(CameraRayGenerator, MatchesViewportRays)
+{
+    const size_t width  = 37;
+    const size_t height = 23;
+    const Camera camera = createTestCamera();
+    const CameraRayGenerator generator{ camera, width, height };
+    for (size_t row = 0; row < height; row++) {
+        for (size_t col = 0; col < width; col++) {
+            const Vec3 viewportPosition{ (col + 0.50f) / width, (row + 0.50f) / height, 0.00f };
+            expectSameRay(camera.viewportPointToRay(viewportPosition), generator.ray(row, col));
+        }
+    }
+}
+
+TEST(CameraRayGenerator, BatchesMatchSingleRays)
+{
+    // spans of odd lengths and offsets, so rows end partway through a pack
+    const size_t width  = 37;
+    const size_t height = 23;
+    const CameraRayGenerator generator{ createTestCamera(), width, height };
+    RayBatch batch;
+    for (size_t row = 0; row < height; row += 5) {
+        for (size_t colBegin : { size_t(0), size_t(3), size_t(30) }) {
+            const size_t count = width - colBegin;
+            generator.generateRow(row, colBegin, count, batch);
+            ASSERT_EQ(batch.count, count);
+            for (size_t i = 0; i < count; i++) {
+                expectSameRay(generator.ray(row, colBegin + i), batch.ray(i));
+            }
+        }
+    }
+}
+
+TEST(CameraRayGenerator, RejectsEmptyImage)
+{
+    EXPECT_THROW(CameraRayGenerator(createTestCamera(), 0, 10), std::invalid_argument);
+}
@@ -0,0 +1,68 @@
+#include "CommandLine.hpp"
+#include "App.hpp"
+#include "FrameBuffer.hpp"
+#include "DemoScenes.hpp"
+
+#include "gtest/gtest.h"
+
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+
+TEST(CommandLine, DefaultsWithoutArguments)
+{
+    const AppOptions options = CommandLine::parse({});
+    EXPECT_EQ(options.sceneName, "random-ground");
+    EXPECT_EQ(options.sceneNumSpheres, DemoScenes::DEFAULT_NUM_SPHERES);
+    EXPECT_EQ(options.imageOutputSize.x, CommonResolutions::HD_8K.x);
+    EXPECT_EQ(options.rayTracingReflectionLimit, 4u);
+    EXPECT_EQ(options.benchmarkFrameCount, 0u);
+    EXPECT_TRUE(options.logInfo);
+}
+
+TEST(CommandLine, FillsOptions)
+{
+    const AppOptions options = CommandLine::parse({
+        "--scene", "random-floating", "--spheres=1000", "--seed", "7", "--resolution", "640x360",
+        "--threads", "8", "--depth=2", "--integrator", "wavefront", "--min-throughput=0.01", "--russian-roulette",
+        "--output", "out.ppm", "--bench", "5", "--quiet" });
+    EXPECT_EQ(options.sceneName, "random-floating");
+    EXPECT_EQ(options.sceneNumSpheres, 1000u);
+    EXPECT_EQ(options.sceneSeed, 7u);
+    EXPECT_EQ(options.imageOutputSize.x, 640.0f);
+    EXPECT_EQ(options.imageOutputSize.y, 360.0f);
+    EXPECT_EQ(options.rayTracingThreadCount, 8u);
+    EXPECT_EQ(options.rayTracingReflectionLimit, 2u);
+    EXPECT_EQ(options.rayTracingIntegrator, Integrator::Wavefront);
+    EXPECT_EQ(options.rayTracingMinThroughput, 0.01f);
+    EXPECT_TRUE(options.rayTracingRussianRoulette);
+    EXPECT_EQ(options.imageOutputFile, "out.ppm");
+    EXPECT_EQ(options.benchmarkFrameCount, 5u);
+    EXPECT_FALSE(options.logInfo);
+
+    EXPECT_EQ(CommandLine::parse({ "--resolution", "720p" }).imageOutputSize.y, CommonResolutions::HD_720p.y);
+}
+
+TEST(CommandLine, RejectsInvalidArguments)
+{
+    const std::vector<std::vector<std::string>> invalidArgs = {
+        { "--frobnicate" },
+        { "--threads" },
+        { "--threads", "-1" },
+        { "--depth", "two" },
+        { "--resolution", "640by360" },
+        { "--resolution", "0x360" },
+        { "--scene", "teapot" },
+        { "--integrator", "breadth-first" },
+        { "--min-throughput", "1.5" },
+        { "--russian-roulette=yes" },
+        { "--gamma", "0" },
+        { "--quiet=yes" },
+    };
+    for (const std::vector<std::string>& args : invalidArgs) {
+        EXPECT_THROW(CommandLine::parse(args), std::invalid_argument) << args.front();
+    }
+    EXPECT_TRUE(CommandLine::isHelpRequested({ "--bench", "3", "--help" }));
+    EXPECT_FALSE(CommandLine::isHelpRequested({ "--bench", "3" }));
+}
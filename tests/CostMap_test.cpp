@@ -0,0 +1,69 @@
+#include "Color.hpp"
+#include "Camera.hpp"
+#include "Objects.hpp"
+#include "Lights.hpp"
+#include "Scene.hpp"
+#include "CompiledScene.hpp"
+#include "FrameBuffer.hpp"
+#include "CostMap.hpp"
+#include "RayTracer.hpp"
+#include "ThreadPool.hpp"
+
+#include "gtest/gtest.h"
+
+#include <stdexcept>
+
+
+TEST(CostMap, HeatmapBrightensWithCost)
+{
+    CostMap costMap{ 101, 1 };
+    for (uint32_t col = 0; col <= 100; col++) {
+        costMap.setCost(0, col, PixelCost{ col, 0, 0 });
+    }
+    EXPECT_EQ(costMap.total(CostMetric::IntersectionTests), 5050u);
+
+    // brightness increases with cost up to the 99th percentile, beyond which outliers saturate
+    const FrameBuffer heatmap = costMap.toHeatmap(CostMetric::IntersectionTests);
+    auto brightness = [&](size_t col) {
+        const Color color = heatmap.getPixel(0, col);
+        return color.r + color.g + color.b;
+    };
+    EXPECT_FLOAT_EQ(brightness(0), 0.00f);
+    EXPECT_LT(brightness(0),  brightness(50));
+    EXPECT_LT(brightness(50), brightness(99));
+    EXPECT_FLOAT_EQ(brightness(99), brightness(100));
+}
+
+TEST(CostMap, RecordedWhileTracing)
+{
+    Scene scene{};
+    Camera camera{};
+    camera.lookAtFrom(Vec3(0.0f, 0.0f, 10.0f), Vec3(0.0f, 0.0f, 0.0f));
+    scene.addSceneObject(Sphere(Vec3(0.0f, 0.0f, 10.0f), 3.00f, Material()));
+    scene.addLight(PointLight(Vec3(0.0f, 10.0f, 0.0f), Color(1.0f, 1.0f, 1.0f)));
+    const CompiledScene compiled{ scene };
+    RayTracer ray_tracer;
+    ThreadPool threadPool{2};
+
+    FrameBuffer frameBuffer{16, 12};
+    CostMap costMap{16, 12};
+    ray_tracer.traceScene(camera, compiled, frameBuffer, threadPool, costMap);
+
+    // every pixel tests its primary ray, and those hitting the sphere also cast one shadow ray
+    for (size_t i = 0; i < costMap.numPixels(); i++) {
+        EXPECT_EQ(costMap.getCost(i).intersectionTests, 1u);
+        EXPECT_LE(costMap.getCost(i).shadowRays, 1u);
+    }
+    EXPECT_GT(costMap.total(CostMetric::ShadowRays), 0u);
+    EXPECT_LT(costMap.total(CostMetric::ShadowRays), costMap.numPixels());
+
+    // recording costs doesn't change the image
+    FrameBuffer expected{16, 12};
+    ray_tracer.traceScene(camera, compiled, expected, threadPool);
+    for (size_t i = 0; i < expected.numPixels(); i++) {
+        EXPECT_EQ(expected.getRadiance(i).r, frameBuffer.getRadiance(i).r);
+    }
+
+    CostMap mismatched{8, 8};
+    EXPECT_THROW(ray_tracer.traceScene(camera, compiled, frameBuffer, threadPool, mismatched), std::invalid_argument);
+}
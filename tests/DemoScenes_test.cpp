@@ -0,0 +1,54 @@
+#include "Math.hpp"
+#include "Objects.hpp"
+#include "Scene.hpp"
+#include "DemoScenes.hpp"
+
+#include "gtest/gtest.h"
+
+#include <vector>
+
+namespace {
+
+    std::vector<const Sphere*> getSpheres(const Scene& scene)
+    {
+        std::vector<const Sphere*> spheres;
+        for (size_t i = 0; i < scene.getNumObjects(); i++) {
+            if (const Sphere* sphere = dynamic_cast<const Sphere*>(&scene.getObject(i))) {
+                spheres.push_back(sphere);
+            }
+        }
+        return spheres;
+    }
+}
+
+TEST(DemoScenes, SameSeedGeneratesSameScene)
+{
+    const Scene firstScene  = DemoScenes::createRandomFloatingScene(200, 7);
+    const Scene secondScene = DemoScenes::createRandomFloatingScene(200, 7);
+    const Scene otherScene  = DemoScenes::createRandomFloatingScene(200, 8);
+    const std::vector<const Sphere*> first  = getSpheres(firstScene);
+    const std::vector<const Sphere*> second = getSpheres(secondScene);
+    const std::vector<const Sphere*> other  = getSpheres(otherScene);
+    ASSERT_EQ(first.size(), 200);
+    ASSERT_EQ(second.size(), 200);
+    for (size_t i = 0; i < first.size(); i++) {
+        EXPECT_EQ(first[i]->center().x, second[i]->center().x);
+        EXPECT_EQ(first[i]->center().z, second[i]->center().z);
+        EXPECT_EQ(first[i]->radius(),   second[i]->radius());
+    }
+    EXPECT_NE(first[0]->center().x, other[0]->center().x);
+}
+
+TEST(DemoScenes, SpheresDoNotOverlap)
+{
+    for (const Scene& scene : { DemoScenes::createRandomGroundScene(400), DemoScenes::createRandomFloatingScene(400) }) {
+        const std::vector<const Sphere*> spheres = getSpheres(scene);
+        ASSERT_EQ(spheres.size(), 400);
+        for (size_t i = 0; i < spheres.size(); i++) {
+            for (size_t j = i + 1; j < spheres.size(); j++) {
+                const float distance = Math::distance(spheres[i]->center(), spheres[j]->center());
+                ASSERT_GE(distance, spheres[i]->radius() + spheres[j]->radius()) << i << " and " << j;
+            }
+        }
+    }
+}
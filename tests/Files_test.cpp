@@ -0,0 +1,99 @@
+#include "Material.hpp"
+#include "TriangleMesh.hpp"
+#include "ThreadPool.hpp"
+#include "Files.hpp"
+
+#include "gtest/gtest.h"
+
+#include <fstream>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+    std::string writeTempFile(const std::string& name, const std::string& contents)
+    {
+        const std::string filepath = (std::filesystem::temp_directory_path() / name).string();
+        std::ofstream ofs(filepath, std::ios::out | std::ios::binary);
+        ofs << contents;
+        return filepath;
+    }
+}
+
+TEST(ReadObj, FaceFormats)
+{
+    const std::string filepath = writeTempFile("RayTracer_FaceFormats.obj",
+        "# unit square, then a triangle referencing its vertices relatively\r\n"
+        "mtllib unused.mtl\r\n"
+        "o square\r\n"
+        "v 0.0 0.0 0.0\r\n"
+        "v 1.0 0.0 0.0\r\n"
+        "  v 1.0 1.0 0.0\r\n"
+        "v 0 1 +0 1.0\r\n"
+        "vt 0.5 0.5\r\n"
+        "vn 0 0 1\r\n"
+        "f 1/1/1 2/1/1 3/1/1 4/1/1\r\n"
+        "v 2 2 -1.5e0\r\n"
+        "f -1//1 -2//1 -3//1\r\n"
+        "f 3 4 5");
+
+    ThreadPool threadPool{2};
+    TriangleMesh mesh = Files::readObj(filepath, Material(), threadPool);
+    EXPECT_EQ(mesh.numVertices(), 5u);
+    EXPECT_EQ(mesh.numTriangles(), 4u);
+    EXPECT_TRUE(Math::isApproximately(mesh.bounds().min, Vec3(0.0f, 0.0f, -1.5f)));
+    EXPECT_TRUE(Math::isApproximately(mesh.bounds().max, Vec3(2.0f, 2.0f,  0.0f)));
+
+    Intersection intersection;
+    EXPECT_TRUE(mesh.intersect(Ray(Vec3(0.25f, 0.75f, 1.0f), Vec3(0, 0, -1)), intersection));
+    EXPECT_NEAR(intersection.t, 1.0f, 0.001f);
+    std::filesystem::remove(filepath);
+}
+
+TEST(ReadObj, ManyChunks)
+{
+    // large enough to be split into several chunks, with faces referencing vertices in earlier chunks
+    const int numPerSide = 300;
+    std::string contents;
+    for (int z = 0; z <= numPerSide; z++) {
+        for (int x = 0; x <= numPerSide; x++) {
+            contents += "v " + std::to_string(x) + " 0 " + std::to_string(z) + "\n";
+        }
+    }
+    for (int z = 0; z < numPerSide; z++) {
+        for (int x = 0; x < numPerSide; x++) {
+            const int corner = z * (numPerSide + 1) + x + 1;
+            const int above  = corner + numPerSide + 1;
+            contents += "f " + std::to_string(corner) + " " + std::to_string(corner + 1) + " " +
+                        std::to_string(above + 1) + " " + std::to_string(above) + "\n";
+        }
+    }
+    ASSERT_GT(contents.size(), 4u * 256u * 1024u);
+    const std::string filepath = writeTempFile("RayTracer_ManyChunks.obj", contents);
+
+    ThreadPool threadPool{3};
+    TriangleMesh mesh = Files::readObj(filepath, Material(), threadPool);
+    EXPECT_EQ(mesh.numVertices(), static_cast<size_t>((numPerSide + 1) * (numPerSide + 1)));
+    EXPECT_EQ(mesh.numTriangles(), static_cast<size_t>(2 * numPerSide * numPerSide));
+    for (float x = 0.5f; x < numPerSide; x += 7.0f) {
+        Intersection intersection;
+        EXPECT_TRUE(mesh.intersect(Ray(Vec3(x, 1.0f, numPerSide - x * 0.5f), Vec3(0, -1, 0)), intersection));
+        EXPECT_NEAR(intersection.t, 1.0f, 0.001f);
+    }
+    std::filesystem::remove(filepath);
+}
+
+TEST(ReadObj, Malformed)
+{
+    const std::string missingVertex = writeTempFile("RayTracer_MissingVertex.obj", "v 0 0 0\nv 1 0 0\nf 1 2 3\n");
+    const std::string badNumber     = writeTempFile("RayTracer_BadNumber.obj", "v 0 zero 0\n");
+    const std::string noFaces       = writeTempFile("RayTracer_NoFaces.obj", "v 0 0 0\nv 1 0 0\nv 0 1 0\n");
+    EXPECT_THROW(Files::readObj(missingVertex, Material()), std::runtime_error);
+    EXPECT_THROW(Files::readObj(badNumber, Material()), std::runtime_error);
+    EXPECT_THROW(Files::readObj(noFaces, Material()), std::runtime_error);
+    EXPECT_THROW(Files::readObj("./does-not-exist.obj", Material()), std::runtime_error);
+    std::filesystem::remove(missingVertex);
+    std::filesystem::remove(badNumber);
+    std::filesystem::remove(noFaces);
+}
@@ -0,0 +1,42 @@
+#include "Color.hpp"
+#include "Radiance.hpp"
+#include "FrameBuffer.hpp"
+
+#include "gtest/gtest.h"
+
+
+TEST(Radiance, ArithmeticIsUnclamped)
+{
+    Radiance radiance = Radiance(Palette::white) + Radiance(0.50f, 0.25f, 2.00f);
+    radiance -= Radiance(2.00f, 0.00f, 0.00f);
+    EXPECT_FLOAT_EQ(radiance.r, -0.50f);
+    EXPECT_FLOAT_EQ(radiance.g,  1.25f);
+    EXPECT_FLOAT_EQ(radiance.b,  3.00f);
+
+    const Color color = radiance.toColor();
+    EXPECT_FLOAT_EQ(color.r, 0.00f);
+    EXPECT_FLOAT_EQ(color.g, 1.00f);
+    EXPECT_FLOAT_EQ(color.b, 1.00f);
+}
+
+TEST(FrameBuffer, LowDynamicRangeClampsOnWrite)
+{
+    FrameBuffer frameBuffer{ 2, 2 };
+    frameBuffer.setPixel(1, 1, Radiance(1.50f, 0.50f, -1.00f));
+    frameBuffer.accumulatePixel(1, 1, Radiance(-0.75f, 0.00f, 0.00f));
+    EXPECT_FLOAT_EQ(frameBuffer.getRadiance(1, 1).r, 0.25f);
+    EXPECT_FLOAT_EQ(frameBuffer.getRadiance(1, 1).b, 0.00f);
+}
+
+TEST(FrameBuffer, HighDynamicRangeAccumulatesUnclamped)
+{
+    FrameBuffer frameBuffer{ 2, 2, FrameBuffer::PixelFormat::HDR };
+    for (int sample = 0; sample < 4; sample++) {
+        frameBuffer.accumulatePixel(0, 1, 0.25f * Radiance(3.00f, 0.50f, 0.00f));
+    }
+    EXPECT_FLOAT_EQ(frameBuffer.getRadiance(0, 1).r, 3.00f);
+    EXPECT_FLOAT_EQ(frameBuffer.getRadiance(0, 1).g, 0.50f);
+    EXPECT_FLOAT_EQ(frameBuffer.getPixel(0, 1).r,    1.00f);
+    EXPECT_FLOAT_EQ(frameBuffer.getPixel(0, 1).g,    0.50f);
+    EXPECT_FLOAT_EQ(frameBuffer.getRadiance(0, 0).r, 0.00f);
+}
@@ -0,0 +1,106 @@
+#include "Material.hpp"
+#include "Objects.hpp"
+#include "Ray.hpp"
+#include "Simd.hpp"
+#include "Kernels.hpp"
+#include "TestRays.hpp"
+
+#include "gtest/gtest.h"
+
+#include <random>
+#include <vector>
+
+namespace {
+
+    struct SphereArrays {
+        std::vector<Sphere> spheres;
+        std::vector<float>  centerX;
+        std::vector<float>  centerY;
+        std::vector<float>  centerZ;
+        std::vector<float>  radius;
+    };
+
+    // count deliberately not a multiple of any pack width, so the masked tail gets covered
+    SphereArrays createRandomSpheres(std::mt19937& gen, size_t count)
+    {
+        std::uniform_real_distribution<float> p_dis(-10.0f, 10.0f);
+        std::uniform_real_distribution<float> r_dis(0.25f, 2.0f);
+        SphereArrays arrays;
+        for (size_t i = 0; i < count; i++) {
+            const Sphere sphere{Vec3(p_dis(gen), p_dis(gen), p_dis(gen)), r_dis(gen), Material()};
+            arrays.spheres.push_back(sphere);
+            arrays.centerX.push_back(sphere.center().x);
+            arrays.centerY.push_back(sphere.center().y);
+            arrays.centerZ.push_back(sphere.center().z);
+            arrays.radius .push_back(sphere.radius());
+        }
+        for (size_t i = 0; i < Simd::PADDING; i++) {
+            arrays.centerX.push_back(0.0f);
+            arrays.centerY.push_back(0.0f);
+            arrays.centerZ.push_back(0.0f);
+            arrays.radius .push_back(0.0f);
+        }
+        return arrays;
+    }
+
+    template <typename FloatN>
+    void expectKernelMatchesSphereIntersect()
+    {
+        std::mt19937 gen{ 4321 };
+        const SphereArrays arrays = createRandomSpheres(gen, 37);
+        for (int i = 0; i < 2000; i++) {
+            const Ray ray = TestRays::randomRay(gen, -15.0f, 15.0f);
+
+            float expectedT = Math::INF;
+            for (const Sphere& sphere : arrays.spheres) {
+                Intersection hit;
+                if (sphere.intersect(ray, hit) && hit.t < expectedT) {
+                    expectedT = hit.t;
+                }
+            }
+
+            float actualT = Math::INF;
+            size_t closest = 0;
+            const bool actualHit = Kernels::intersectSpheres<FloatN>(arrays.centerX.data(), arrays.centerY.data(),
+                arrays.centerZ.data(), arrays.radius.data(), arrays.spheres.size(), ray, actualT, closest);
+            ASSERT_EQ(expectedT != Math::INF, actualHit);
+            if (actualHit) {
+                EXPECT_NEAR(expectedT, actualT, 0.001f);
+                Intersection hit;
+                EXPECT_TRUE(arrays.spheres[closest].intersect(ray, hit));
+                EXPECT_NEAR(hit.t, actualT, 0.001f);
+            }
+
+            const float tMax = 8.0f;
+            bool expectedOccluded = false;
+            for (const Sphere& sphere : arrays.spheres) {
+                expectedOccluded = expectedOccluded || sphere.occluded(ray, tMax);
+            }
+            EXPECT_EQ(expectedOccluded, Kernels::occludedBySpheres<FloatN>(arrays.centerX.data(), arrays.centerY.data(),
+                arrays.centerZ.data(), arrays.radius.data(), arrays.spheres.size(), ray, tMax, arrays.spheres.size()));
+        }
+    }
+}
+
+TEST(Kernels, ScalarMatchesSphereIntersect)
+{
+    expectKernelMatchesSphereIntersect<Simd::Float1>();
+}
+
+TEST(Kernels, WideMatchesSphereIntersect)
+{
+    expectKernelMatchesSphereIntersect<Simd::FloatN>();
+}
+
+TEST(Kernels, OcclusionSkipsIgnoredSphere)
+{
+    const float centerX[1 + Simd::PADDING] = { 0.0f };
+    const float centerY[1 + Simd::PADDING] = { 0.0f };
+    const float centerZ[1 + Simd::PADDING] = { 5.0f };
+    const float radius [1 + Simd::PADDING] = { 1.0f };
+    Ray ray{{0.0, 0.0, 0.0}, {0.0, 0.0, 1.0}};
+
+    EXPECT_TRUE (Kernels::occludedBySpheres<Simd::FloatN>(centerX, centerY, centerZ, radius, 1, ray, 10.0f, 1));
+    EXPECT_FALSE(Kernels::occludedBySpheres<Simd::FloatN>(centerX, centerY, centerZ, radius, 1, ray, 10.0f, 0));
+    EXPECT_FALSE(Kernels::occludedBySpheres<Simd::FloatN>(centerX, centerY, centerZ, radius, 1, ray,  3.0f, 1));
+}
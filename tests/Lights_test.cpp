@@ -0,0 +1,69 @@
+#include "Math.hpp"
+#include "Color.hpp"
+#include "Lights.hpp"
+#include "Scene.hpp"
+#include "CompiledScene.hpp"
+
+#include "gtest/gtest.h"
+
+#include <random>
+#include <vector>
+#include <span>
+#include <algorithm>
+
+
+TEST(PointLight, AttenuationGetters)
+{
+    const PointLight light{ Vec3(0.0f, 0.0f, 0.0f), Color(1.0f, 1.0f, 1.0f), 1.0f, 0.5f, 0.25f };
+    EXPECT_EQ(light.attenuationConstant(),  1.00f);
+    EXPECT_EQ(light.attenuationLinear(),    0.50f);
+    EXPECT_EQ(light.attenuationQuadratic(), 0.25f);
+}
+
+TEST(PointLight, InfluenceRadiusBoundsIntensity)
+{
+    const PointLight light{ Vec3(1.0f, 2.0f, 3.0f), Color(0.5f, 1.0f, 0.25f), 1.0f, 0.1f, 0.01f };
+    const float radius = light.influenceRadius(1e-02f);
+    ASSERT_GT(radius, 0.0f);
+    ASSERT_LT(radius, Math::INF);
+
+    const Color inside  = light.computeIntensityAtPoint(Vec3(1.0f, 2.0f, 3.0f + 0.99f * radius));
+    const Color outside = light.computeIntensityAtPoint(Vec3(1.0f, 2.0f, 3.0f + 1.01f * radius));
+    EXPECT_GT(inside.g, 1e-02f);
+    EXPECT_LT(outside.g, 1e-02f);
+}
+
+TEST(PointLight, InfluenceRadiusWithoutFalloff)
+{
+    const PointLight constant{ Vec3(0.0f, 0.0f, 0.0f), Color(1.0f, 1.0f, 1.0f) };
+    EXPECT_EQ(constant.influenceRadius(1e-03f), Math::INF);
+
+    const PointLight dim{ Vec3(0.0f, 0.0f, 0.0f), Color(1e-04f, 1e-04f, 1e-04f), 1.0f, 1.0f, 1.0f };
+    EXPECT_EQ(dim.influenceRadius(1e-03f), 0.0f);
+}
+
+TEST(CompiledScene, GatherLightsMatchesBruteForce)
+{
+    std::mt19937 rng{ 7 };
+    std::uniform_real_distribution<float> position{ -100.0f, 100.0f };
+    Scene scene{};
+    scene.addLight(PointLight(Vec3(0.0f, 200.0f, 0.0f), Color(1.0f, 1.0f, 1.0f)));
+    for (size_t i = 0; i < 200; i++) {
+        scene.addLight(PointLight(Vec3(position(rng), position(rng), position(rng)), Color(1.0f, 1.0f, 1.0f), 1.0f, 0.0f, 1.0f));
+    }
+    const CompiledScene compiled{ scene };
+
+    std::vector<uint32_t> storage{};
+    for (size_t sample = 0; sample < 100; sample++) {
+        const Vec3 point{ position(rng), position(rng), position(rng) };
+        std::vector<uint32_t> expected{};
+        for (uint32_t index = 0; index < compiled.getNumLights(); index++) {
+            const float radius = compiled.getLightInfluenceRadius(index);
+            if (radius > 0.0f && Math::magnitudeSquared(point - compiled.getLight(index).position()) <= Math::square(radius)) {
+                expected.push_back(index);
+            }
+        }
+        const std::span<const uint32_t> gathered = compiled.gatherLights(point, storage);
+        ASSERT_TRUE(std::equal(gathered.begin(), gathered.end(), expected.begin(), expected.end())) << "sample " << sample;
+    }
+}
@@ -0,0 +1,41 @@
+#include "Material.hpp"
+#include "MaterialTable.hpp"
+#include "Objects.hpp"
+#include "Scene.hpp"
+#include "CompiledScene.hpp"
+
+#include "gtest/gtest.h"
+
+
+TEST(MaterialTable, EqualMaterialsShareIndex)
+{
+    Material shiny{};
+    shiny.setShininess(25);
+
+    MaterialTable table{};
+    const MaterialTable::Index plain = table.add(Material());
+    const MaterialTable::Index other = table.add(shiny);
+    EXPECT_NE(plain, other);
+    EXPECT_EQ(plain, table.add(Material()));
+    EXPECT_EQ(other, table.add(shiny));
+    EXPECT_EQ(table.size(), 2);
+    EXPECT_EQ(table.get(other).shininess(), shiny.shininess());
+}
+
+TEST(MaterialTable, CompiledSceneStoresDistinctMaterials)
+{
+    Material shiny{};
+    shiny.setShininess(25);
+
+    Scene scene{};
+    for (int i = 0; i < 10; i++) {
+        scene.addSceneObject(Sphere(Vec3(i * 3.0f, 0.0f, -5.0f), 1.0f, i % 2 == 0 ? shiny : Material()));
+    }
+    scene.addSceneObject(Triangle(Vec3(-5, -1, -5), Vec3(5, -1, -5), Vec3(5, -1, 5), shiny));
+    CompiledScene compiled{ scene };
+
+    ASSERT_EQ(compiled.getNumMaterials(), 2);
+    EXPECT_EQ(scene.getObjectMaterial(0), scene.getObjectMaterial(10));
+    EXPECT_NE(scene.getObjectMaterial(0), scene.getObjectMaterial(1));
+    EXPECT_EQ(compiled.getMaterial(scene.getObjectMaterial(0)).shininess(), shiny.shininess());
+}
@@ -0,0 +1,40 @@
+#include "Math.hpp"
+
+#include "gtest/gtest.h"
+
+#include <random>
+
+
+// vector operations stay usable in constant expressions regardless of backend
+static_assert(Math::cross(Vec3::right(), Vec3::up()).z == 1.00f);
+static_assert(Math::dot(Vec3(1.0f, 2.0f, 3.0f), Vec3(4.0f, 5.0f, 6.0f)) == 32.00f);
+static_assert((Vec3::one() * 2.00f - Vec3::up()).y == 1.00f);
+
+TEST(Vec3, OperationsMatchComponentwiseMath)
+{
+    std::mt19937 rng{ 5 };
+    std::uniform_real_distribution<float> coordinate{ -10.0f, 10.0f };
+    for (int i = 0; i < 100; i++) {
+        const Vec3 a{ coordinate(rng), coordinate(rng), coordinate(rng) };
+        const Vec3 b{ coordinate(rng), coordinate(rng), coordinate(rng) };
+        const float s = coordinate(rng);
+
+        const Vec3 sum = a + b;
+        const Vec3 scaled = s * a - b / 2.0f;
+        EXPECT_EQ(sum.x, a.x + b.x);
+        EXPECT_EQ(sum.z, a.z + b.z);
+        EXPECT_EQ(scaled.y, s * a.y - b.y / 2.0f);
+        EXPECT_EQ(Math::dot(a, b), a.x * b.x + a.y * b.y + a.z * b.z);
+        EXPECT_EQ(Math::min(a, b).x, Math::min(a.x, b.x));
+        EXPECT_EQ(Math::max(a, b).y, Math::max(a.y, b.y));
+
+        const Vec3 c = Math::cross(a, b);
+        EXPECT_NEAR(c.x, a.y * b.z - a.z * b.y, 1e-4f);
+        EXPECT_NEAR(c.y, a.z * b.x - a.x * b.z, 1e-4f);
+        EXPECT_NEAR(c.z, a.x * b.y - a.y * b.x, 1e-4f);
+
+        const Vec3 n = Math::normalize(b);
+        EXPECT_TRUE(Math::isNormalized(n, 1e-5f)) << n;
+        EXPECT_TRUE(Math::isApproximately(Math::reflect(Math::reflect(a, n), n), a, 1e-4f));
+    }
+}
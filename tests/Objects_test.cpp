@@ -159,3 +159,64 @@ TEST(Intersection, SphereRayPointingAway)
     EXPECT_FALSE(intersectionOccured);
 }
 
+
+TEST(Occluded, SphereWithinSegment)
+{
+    Sphere obj{Vec3(0, 0, 0), 10.00f, Material()};
+    Ray ray{{-20.0, 0.0, 0.0}, {1.0, 0.0, 0.0}};
+
+    EXPECT_TRUE(obj.occluded(ray, 15.0f));
+    EXPECT_FALSE(obj.occluded(ray, 5.0f));
+}
+
+TEST(Occluded, SphereInner)
+{
+    Sphere obj{Vec3(0, 0, 0), 10.00f, Material()};
+    Ray ray{{0.0, 0.0, 0.0}, {1.0, 0.0, 0.0}};
+
+    EXPECT_TRUE(obj.occluded(ray, 11.0f));
+    EXPECT_FALSE(obj.occluded(ray, 9.0f));
+}
+
+TEST(Occluded, SphereRayPointingAway)
+{
+    Sphere obj{Vec3(0, 0, 0), 10.00f, Material()};
+    Ray ray{{20.0, 0.0, 0.0}, {1.0, 0.0, 0.0}};
+
+    EXPECT_FALSE(obj.occluded(ray, Math::INF));
+}
+
+TEST(Occluded, TriangleWithinSegment)
+{
+    float L = 10.0f;
+    Vec3 v1{0.0f, 0.0f, 0.0f};
+    Vec3 v2{L,    0.0f, 0.0f};
+    Vec3 v3{L,    L,    0.0f};
+    Triangle obj{v1, v2, v3, Material()};
+
+    Ray ray{{L/2.0f, L/4.0f, -10.0f}, {0.0f, 0.0f, 1.0f}};
+
+    EXPECT_TRUE(obj.occluded(ray, 11.0f));
+    EXPECT_FALSE(obj.occluded(ray, 9.0f));
+}
+
+TEST(Intersection, SphereDeferredHitRecord)
+{
+    Sphere obj{Vec3(0, 0, 0), 10.00f, Material()};
+    Ray ray{{-20.0, 0.0, 0.0}, {1.0, 0.0, 0.0}};
+
+    float tClosest = 5.0f;
+    uint32_t part = Intersection::NO_INDEX;
+    EXPECT_FALSE(obj.intersect(ray, tClosest, part));
+    EXPECT_EQ(tClosest, 5.0f);
+
+    tClosest = Math::INF;
+    ASSERT_TRUE(obj.intersect(ray, tClosest, part));
+    EXPECT_NEAR(tClosest, 10.0f, 0.001f);
+
+    Intersection intersection;
+    obj.finalizeIntersection(ray, tClosest, part, intersection);
+    EXPECT_EQ(intersection.object, &obj);
+    EXPECT_NEAR(intersection.point.x,  -10.0f, 0.001f);
+    EXPECT_NEAR(intersection.normal.x, -1.0f,  0.001f);
+}
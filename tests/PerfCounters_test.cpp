@@ -0,0 +1,41 @@
+#include "PerfCounters.hpp"
+
+#include "gtest/gtest.h"
+
+#include <sstream>
+#include <cstdint>
+
+
+TEST(PerfCounters, DegradesGracefully)
+{
+    const PerfCounters perfCounters{};
+    const PerfCounts start = perfCounters.read();
+    volatile uint64_t sum = 0;
+    for (uint64_t i = 0; i < 1000000; i++) {
+        sum = sum + i;
+    }
+    const PerfCounts counts = perfCounters.read() - start;
+
+    // counters are often unavailable (e.g. in containers), in which case every reading is simply empty
+    if (!perfCounters.isAvailable()) {
+        EXPECT_TRUE(counts.isEmpty());
+        EXPECT_FALSE(counts.instructionsPerCycle().has_value());
+    } else if (counts.instructions) {
+        EXPECT_GT(*counts.instructions, 1000000u);
+    }
+}
+
+TEST(PerfCounts, DifferenceKeepsMissingEventsEmpty)
+{
+    const PerfCounts before{ 100, 50, std::nullopt, 4, 1 };
+    const PerfCounts after { 400, 650, std::nullopt, 6, 2 };
+    const PerfCounts counts = after - before;
+    EXPECT_EQ(counts.cycles, 300u);
+    EXPECT_EQ(counts.instructions, 600u);
+    EXPECT_FALSE(counts.l1DataMisses.has_value());
+    EXPECT_DOUBLE_EQ(counts.instructionsPerCycle().value(), 2.0);
+
+    std::ostringstream os;
+    os << counts;
+    EXPECT_EQ(os.str(), "PerfCounts(cycles:300,instructions:600,ipc:2,l1d-misses:n/a,llc-misses:2,branch-misses:1)");
+}
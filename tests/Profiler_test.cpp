@@ -0,0 +1,118 @@
+#include "Profiler.hpp"
+#include "ThreadPool.hpp"
+
+#include "gtest/gtest.h"
+
+#include <string>
+#include <sstream>
+#include <thread>
+#include <atomic>
+#include <utility>
+
+
+TEST(Profiler, RecordsOnlyWhileEnabled)
+{
+    Profiler::setEnabled(false);
+    const size_t numEventsBefore = Profiler::numEvents();
+    {
+        ProfileZone zone{ "disabled-zone" };
+    }
+    EXPECT_EQ(Profiler::numEvents(), numEventsBefore);
+
+    Profiler::setEnabled(true);
+    {
+        ProfileZone outer{ "outer-zone" };
+        ProfileZone inner{ "inner-zone" };
+    }
+    Profiler::setEnabled(false);
+    EXPECT_EQ(Profiler::numEvents(), numEventsBefore + 2);
+
+    std::ostringstream os;
+    Profiler::writeChromeTrace(os);
+    const std::string json = os.str();
+    EXPECT_EQ(json.find("disabled-zone"), std::string::npos);
+    EXPECT_NE(json.find("{\"name\":\"outer-zone\",\"ph\":\"X\""), std::string::npos);
+    EXPECT_NE(json.find("{\"name\":\"inner-zone\",\"ph\":\"X\""), std::string::npos);
+    EXPECT_NE(json.find("\"thread_name\""), std::string::npos);
+}
+
+TEST(Profiler, RecordsPerThread)
+{
+    ThreadPool threadPool{ 4 };
+    Profiler::setEnabled(true);
+    const size_t numEventsBefore = Profiler::numEvents();
+    threadPool.parallelFor(64, [](size_t, size_t) {
+        ProfileZone zone{ "pool-task" };
+    });
+    Profiler::setEnabled(false);
+    EXPECT_EQ(Profiler::numEvents(), numEventsBefore + 64);
+
+    std::ostringstream os;
+    Profiler::writeChromeTrace(os);
+    const std::string json = os.str();
+    EXPECT_EQ(json.front(), '{');
+    EXPECT_EQ(json.substr(json.size() - 3), "]}\n");
+}
+
+TEST(Profiler, RingBufferKeepsNewestEvents)
+{
+    Profiler::setEnabled(true);
+    // recorded on a single fresh thread, so its buffer holds nothing but these zones
+    std::thread thread([] {
+        for (size_t i = 0; i < Profiler::EVENTS_PER_THREAD + 10; i++) {
+            ProfileZone zone{ "wrapping-zone" };
+        }
+    });
+    thread.join();
+    Profiler::setEnabled(false);
+
+    std::ostringstream os;
+    Profiler::writeChromeTrace(os);
+    const std::string json = os.str();
+    size_t numWrapping = 0;
+    for (size_t at = json.find("wrapping-zone"); at != std::string::npos; at = json.find("wrapping-zone", at + 1)) {
+        numWrapping++;
+    }
+    // once wrapped, the oldest slot is left out, since it may be mid overwrite by a record that's still in progress
+    EXPECT_EQ(numWrapping, Profiler::EVENTS_PER_THREAD - 1);
+}
+
+TEST(Profiler, ExportsWhileRecording)
+{
+    // each lap around the ring buffer alternates between two kinds of event, such that a slot torn between the event
+    // being overwritten and the one overwriting it shows up as a name paired with the wrong duration
+    Profiler::setEnabled(true);
+    std::atomic<bool> isRecording{ true };
+    std::thread recorder([&] {
+        for (size_t i = 0; i < 8 * Profiler::EVENTS_PER_THREAD; i++) {
+            const bool isEvenLap = (i / Profiler::EVENTS_PER_THREAD) % 2 == 0;
+            const double startTime = static_cast<double>(i);
+            const double duration  = isEvenLap ? 1.00 : 2.00;
+            Profiler::record(ProfileEvent{ isEvenLap ? "even-lap" : "odd-lap", startTime, startTime + duration });
+        }
+        isRecording = false;
+    });
+
+    size_t numExports = 0;
+    size_t numTorn    = 0;
+    do {
+        std::ostringstream os;
+        Profiler::writeChromeTrace(os);
+        const std::string json = os.str();
+        for (const auto& [name, duration] : { std::pair{ "\"even-lap\"", "\"dur\":1000000.000}" },
+                                              std::pair{ "\"odd-lap\"",  "\"dur\":2000000.000}" } }) {
+            for (size_t at = json.find(name); at != std::string::npos; at = json.find(name, at + 1)) {
+                const size_t durationAt = json.find("\"dur\":", at);
+                if (json.compare(durationAt, std::string(duration).size(), duration) != 0) {
+                    numTorn++;
+                }
+            }
+        }
+        numExports++;
+    } while (isRecording);
+    recorder.join();
+    Profiler::setEnabled(false);
+
+    EXPECT_GT(numExports, 0u);
+    EXPECT_EQ(numTorn, 0u);
+}
@@ -0,0 +1,130 @@
+#include "Math.hpp"
+#include "Material.hpp"
+#include "Objects.hpp"
+#include "Ray.hpp"
+#include "AABB.hpp"
+#include "Scene.hpp"
+#include "CompiledScene.hpp"
+#include "RayPacket.hpp"
+#include "TestRays.hpp"
+
+#include "gtest/gtest.h"
+
+#include <random>
+
+namespace {
+
+    // rays fanning out from around a common origin, as neighboring primary rays do
+    void coherentRays(std::mt19937& gen, Ray* rays)
+    {
+        std::uniform_real_distribution<float> p_dis(-30.0f, 30.0f);
+        std::uniform_real_distribution<float> jitter(-0.05f, 0.05f);
+        const Vec3 origin{ p_dis(gen), 40.0f, p_dis(gen) };
+        const Vec3 target{ p_dis(gen) * 0.5f, 0.0f, p_dis(gen) * 0.5f };
+        const Vec3 direction = Math::direction(origin, target);
+        for (size_t lane = 0; lane < RayPacket::SIZE; lane++) {
+            const Vec3 offset{ jitter(gen), jitter(gen), jitter(gen) };
+            rays[lane] = Ray(origin + offset, Math::normalize(direction + offset));
+        }
+    }
+
+    // rays heading every which way, for which the packet can't be bounded as a whole
+    void incoherentRays(std::mt19937& gen, Ray* rays)
+    {
+        for (size_t lane = 0; lane < RayPacket::SIZE; lane++) {
+            rays[lane] = TestRays::randomRay(gen, -30.0f, 30.0f);
+        }
+    }
+
+    CompiledScene createTestScene()
+    {
+        Scene scene{};
+        for (int x = -3; x <= 3; x++) {
+            for (int z = -3; z <= 3; z++) {
+                scene.addSceneObject(Sphere(Vec3(x * 8.0f, 2.0f + (x + z) % 3, z * 8.0f), 2.5f, Material()));
+            }
+        }
+        scene.addSceneObject(Triangle(Vec3(-50, 0, -50), Vec3(50, 0, -50), Vec3(50, 0, 50), Material()));
+        scene.addSceneObject(Triangle(Vec3(-50, 0, -50), Vec3(50, 0, 50), Vec3(-50, 0, 50), Material()));
+        return CompiledScene(scene);
+    }
+}
+
+TEST(RayPacket, BoxTestMatchesSingleRays)
+{
+    std::mt19937 gen{ 99 };
+    std::uniform_real_distribution<float> b_dis(-20.0f, 20.0f);
+    std::uniform_real_distribution<float> s_dis(0.5f, 10.0f);
+    for (int i = 0; i < 500; i++) {
+        Ray rays[RayPacket::SIZE];
+        if (i % 2 == 0) {
+            coherentRays(gen, rays);
+        } else {
+            incoherentRays(gen, rays);
+        }
+        const uint32_t lanes = (i % 3 == 0) ? 0b01101101u : 0xFFu;
+        const RayPacket packet{ rays, lanes };
+        float tMax[RayPacket::SIZE];
+        for (size_t lane = 0; lane < RayPacket::SIZE; lane++) {
+            tMax[lane] = (lane % 2 == 0) ? Math::INF : 60.0f;
+        }
+
+        for (int j = 0; j < 20; j++) {
+            const Vec3 min{ b_dis(gen), b_dis(gen) * 0.25f, b_dis(gen) };
+            const AABB box{ min, min + Vec3(s_dis(gen), s_dis(gen), s_dis(gen)) };
+            uint32_t expected = 0;
+            for (size_t lane = 0; lane < RayPacket::SIZE; lane++) {
+                float tEntry = 0.00f;
+                const Ray& ray = rays[lane];
+                const Vec3 invDirection{ 1.00f / ray.direction.x, 1.00f / ray.direction.y, 1.00f / ray.direction.z };
+                if (((lanes >> lane) & 1u) && box.intersect(ray, invDirection, tMax[lane], tEntry)) {
+                    expected |= 1u << lane;
+                }
+            }
+            float tEntry = 0.00f;
+            EXPECT_EQ(packet.intersect(box, tMax, lanes, tEntry), expected);
+        }
+    }
+}
+
+TEST(RayPacket, SceneQueriesMatchSingleRays)
+{
+    const CompiledScene scene = createTestScene();
+    std::mt19937 gen{ 4321 };
+    for (int i = 0; i < 400; i++) {
+        Ray rays[RayPacket::SIZE];
+        if (i % 2 == 0) {
+            coherentRays(gen, rays);
+        } else {
+            incoherentRays(gen, rays);
+        }
+        const uint32_t lanes = (i % 5 == 0) ? 0b10110110u : 0xFFu;
+        const RayPacket packet{ rays, lanes };
+
+        Intersection results[RayPacket::SIZE];
+        const uint32_t hits = scene.intersect(packet, results);
+        float    tMax[RayPacket::SIZE];
+        uint32_t ignore[RayPacket::SIZE];
+        for (size_t lane = 0; lane < RayPacket::SIZE; lane++) {
+            tMax[lane]   = 25.0f + lane;
+            ignore[lane] = (lane % 3 == 0) ? 0u : Intersection::NO_INDEX;
+        }
+        const uint32_t blocked = scene.isOccluded(packet, tMax, ignore);
+
+        for (size_t lane = 0; lane < RayPacket::SIZE; lane++) {
+            if (((lanes >> lane) & 1u) == 0) {
+                EXPECT_EQ((hits >> lane) & 1u, 0u);
+                EXPECT_EQ((blocked >> lane) & 1u, 0u);
+                continue;
+            }
+            Intersection expected;
+            const bool expectedHit = scene.intersect(rays[lane], expected);
+            ASSERT_EQ(expectedHit, ((hits >> lane) & 1u) != 0);
+            if (expectedHit) {
+                EXPECT_EQ(expected.t, results[lane].t);
+                EXPECT_EQ(expected.primitive, results[lane].primitive);
+            }
+            EXPECT_EQ(scene.isOccluded(rays[lane], tMax[lane], ignore[lane]), ((blocked >> lane) & 1u) != 0);
+        }
+    }
+}
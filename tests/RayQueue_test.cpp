@@ -0,0 +1,68 @@
+#include "Math.hpp"
+#include "Ray.hpp"
+#include "RayQueue.hpp"
+
+#include "gtest/gtest.h"
+
+#include <random>
+#include <vector>
+#include <cstdint>
+
+namespace {
+
+    uint32_t octantOf(const Vec3& direction)
+    {
+        return (direction.x < 0.0f ? 1u : 0u) | (direction.y < 0.0f ? 2u : 0u) | (direction.z < 0.0f ? 4u : 0u);
+    }
+}
+
+
+TEST(RayQueue, SortByCoherenceKeepsEachRaysData)
+{
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<float> p_dis(-50.0f, 50.0f);
+    std::uniform_real_distribution<float> d_dis(-1.0f, 1.0f);
+    const size_t numRays = 500;
+    RayQueue queue{numRays};
+    RayQueue scratch{numRays};
+    std::vector<Ray> rays;
+    for (size_t i = 0; i < numRays; i++) {
+        rays.emplace_back(Vec3(p_dis(gen), p_dis(gen), p_dis(gen)), Math::normalize(Vec3(d_dis(gen), d_dis(gen), d_dis(gen))));
+        queue.push(rays.back(), static_cast<uint32_t>(i), static_cast<float>(i), static_cast<uint32_t>(2 * i));
+    }
+
+    queue.sortByCoherence(scratch);
+
+    ASSERT_EQ(queue.size(), numRays);
+    std::vector<bool> isSeen(numRays, false);
+    for (size_t i = 0; i < numRays; i++) {
+        const uint32_t path = queue.path(i);
+        ASSERT_LT(path, numRays);
+        EXPECT_FALSE(isSeen[path]);
+        isSeen[path] = true;
+        EXPECT_TRUE(Math::isApproximately(queue.ray(i).origin,    rays[path].origin));
+        EXPECT_TRUE(Math::isApproximately(queue.ray(i).direction, rays[path].direction));
+        EXPECT_EQ(queue.tMax(i),            static_cast<float>(path));
+        EXPECT_EQ(queue.ignorePrimitive(i), 2 * path);
+    }
+}
+
+TEST(RayQueue, SortByCoherenceGroupsRaysByOctant)
+{
+    std::mt19937 gen(11);
+    std::uniform_real_distribution<float> p_dis(-50.0f, 50.0f);
+    std::uniform_real_distribution<float> d_dis(-1.0f, 1.0f);
+    const size_t numRays = 300;
+    RayQueue queue{numRays};
+    RayQueue scratch{numRays};
+    for (size_t i = 0; i < numRays; i++) {
+        const Ray ray{ Vec3(p_dis(gen), p_dis(gen), p_dis(gen)), Math::normalize(Vec3(d_dis(gen), d_dis(gen), d_dis(gen))) };
+        queue.push(ray, static_cast<uint32_t>(i));
+    }
+
+    queue.sortByCoherence(scratch);
+
+    for (size_t i = 1; i < numRays; i++) {
+        EXPECT_LE(octantOf(queue.ray(i - 1).direction), octantOf(queue.ray(i).direction)) << "ray " << i;
+    }
+}
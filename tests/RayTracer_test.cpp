@@ -4,10 +4,13 @@
 #include "Ray.hpp"
 #include "Scene.hpp"
 #include "RayTracer.hpp"
+#include "DemoScenes.hpp"
 
 #include "gtest/gtest.h"
 
 #include <iostream>
+#include <stdexcept>
+#include <random>
 
 TEST(Reflect, SameDirectionNormal)
 {
@@ -73,3 +76,183 @@ TEST(NearestIntersection, Inside)
     EXPECT_NEAR(intersection.point.y, 0.0f, 0.1f);
     EXPECT_NEAR(intersection.point.z, 5.0f, 0.1f);
 }
+
+TEST(NearestIntersection, CompiledMatchesScene)
+{
+    Scene scene{};
+    Camera camera{};
+
+    scene.addSceneObject(Sphere(Vec3(0.0f, 0.0f, 10.0f), 5.00f, Material()));
+    scene.addSceneObject(Sphere(Vec3(3.0f, 0.0f, 4.0f), 1.00f, Material()));
+    scene.addSceneObject(Triangle(Vec3(-10.0f, -10.0f, 8.0f), Vec3(10.0f, -10.0f, 8.0f), Vec3(0.0f, 10.0f, 8.0f), Material()));
+    CompiledScene compiled{scene};
+    RayTracer ray_tracer;
+
+    EXPECT_EQ(compiled.getNumSpheres(), 2u);
+    EXPECT_EQ(compiled.getNumTriangles(), 1u);
+    for (float x = -6.0f; x <= 6.0f; x += 0.5f) {
+        Ray ray{Vec3(x, 0.5f, 0.0f), Vec3(0.0f, 0.0f, 1.0f)};
+        Intersection expected;
+        Intersection actual;
+        bool expectedHit = ray_tracer.findNearestIntersection(camera, scene, ray, expected);
+        bool actualHit = ray_tracer.findNearestIntersection(camera, compiled, ray, actual);
+
+        ASSERT_EQ(expectedHit, actualHit);
+        if (expectedHit) {
+            EXPECT_NEAR(expected.t, actual.t, 0.001f);
+            EXPECT_NEAR(expected.normal.x, actual.normal.x, 0.001f);
+            EXPECT_NEAR(expected.normal.y, actual.normal.y, 0.001f);
+            EXPECT_NEAR(expected.normal.z, actual.normal.z, 0.001f);
+        }
+    }
+}
+
+TEST(RayStats, CountsEveryRay)
+{
+    Scene scene{};
+    Camera camera{};
+    camera.lookAtFrom(Vec3(0.0f, 0.0f, 10.0f), Vec3(0.0f, 0.0f, 0.0f));
+
+    scene.addSceneObject(Sphere(Vec3(0.0f, 0.0f, 10.0f), 3.00f, Material()));
+    scene.addLight(PointLight(Vec3(0.0f, 10.0f, 0.0f), Color(1.0f, 1.0f, 1.0f)));
+    FrameBuffer frameBuffer{16, 12};
+    RayTracer ray_tracer;
+    ThreadPool threadPool{2};
+
+    const RayStats stats = ray_tracer.traceScene(camera, CompiledScene(scene), frameBuffer, threadPool);
+
+    if constexpr (RayStats::IS_ENABLED) {
+        EXPECT_EQ(stats.primaryRays, 16u * 12u);
+        EXPECT_GT(stats.intersectionHits, 0u);
+        EXPECT_LT(stats.intersectionHits, stats.intersectionTests);
+        EXPECT_EQ(stats.intersectionTests, stats.primaryRays + stats.reflectionRays);
+        EXPECT_EQ(stats.shadowRays, stats.intersectionHits);
+    } else {
+        EXPECT_EQ(stats.totalRays(), 0u);
+        EXPECT_EQ(stats.intersectionTests, 0u);
+    }
+}
+
+TEST(Wavefront, MatchesRecursive)
+{
+    // not a multiple of the tile size, so edge tiles hold partial wavefronts
+    const CompiledScene scene{ DemoScenes::createRandomGroundScene(60, 3) };
+    Camera camera{};
+    camera.setAspectRatio(80.0f / 45.0f);
+    camera.lookAtFrom(Vec3(0.0f, 0.0f, 0.0f), Vec3(0.0f, 50.0f, 150.0f));
+    ThreadPool threadPool{2};
+
+    RayTracer ray_tracer;
+    ray_tracer.setMaxNumReflections(4);
+    FrameBuffer recursive{80, 45};
+    const RayStats recursiveStats = ray_tracer.traceScene(camera, scene, recursive, threadPool);
+    ray_tracer.setIntegrator(Integrator::Wavefront);
+
+    // reflections are traced in a different order when sorted, but each still finds the same hit
+    for (bool sortsReflections : { false, true }) {
+        ray_tracer.setSortsReflections(sortsReflections);
+        FrameBuffer wavefront{80, 45};
+        const RayStats wavefrontStats = ray_tracer.traceScene(camera, scene, wavefront, threadPool);
+
+        for (size_t i = 0; i < recursive.numPixels(); i++) {
+            ASSERT_EQ(recursive.getPixel(i).r, wavefront.getPixel(i).r) << "pixel " << i << ", sorted " << sortsReflections;
+            ASSERT_EQ(recursive.getPixel(i).g, wavefront.getPixel(i).g) << "pixel " << i << ", sorted " << sortsReflections;
+            ASSERT_EQ(recursive.getPixel(i).b, wavefront.getPixel(i).b) << "pixel " << i << ", sorted " << sortsReflections;
+        }
+        EXPECT_EQ(recursiveStats.totalRays(),         wavefrontStats.totalRays());
+        EXPECT_EQ(recursiveStats.intersectionTests,   wavefrontStats.intersectionTests);
+        EXPECT_EQ(recursiveStats.occludedShadowRays,  wavefrontStats.occludedShadowRays);
+    }
+}
+
+TEST(Throughput, CutsOffFaintReflections)
+{
+    // every sphere reflects half of what reaches it, so even the first reflection weighs less than a throughput of one
+    const CompiledScene scene{ DemoScenes::createSimpleScene() };
+    Camera camera{};
+    camera.setAspectRatio(64.0f / 36.0f);
+    camera.lookAtFrom(Vec3(0.0f, 50.0f, 0.0f), Vec3(0.0f, 50.0f, 150.0f));
+    ThreadPool threadPool{2};
+
+    RayTracer ray_tracer;
+    ray_tracer.setMaxNumReflections(0);
+    FrameBuffer unreflected{64, 36};
+    ray_tracer.traceScene(camera, scene, unreflected, threadPool);
+    ray_tracer.setMaxNumReflections(4);
+    ray_tracer.setMinThroughput(1.0f);
+    FrameBuffer cutOff{64, 36};
+    ray_tracer.traceScene(camera, scene, cutOff, threadPool);
+    ray_tracer.setMinThroughput(0.0f);
+    FrameBuffer reflected{64, 36};
+    ray_tracer.traceScene(camera, scene, reflected, threadPool);
+
+    bool isAnyReflected = false;
+    for (size_t i = 0; i < unreflected.numPixels(); i++) {
+        ASSERT_EQ(unreflected.getPixel(i).r, cutOff.getPixel(i).r) << "pixel " << i;
+        ASSERT_EQ(unreflected.getPixel(i).g, cutOff.getPixel(i).g) << "pixel " << i;
+        ASSERT_EQ(unreflected.getPixel(i).b, cutOff.getPixel(i).b) << "pixel " << i;
+        isAnyReflected |= unreflected.getPixel(i).r != reflected.getPixel(i).r;
+    }
+    EXPECT_TRUE(isAnyReflected);
+    EXPECT_THROW(ray_tracer.setMinThroughput(-0.5f), std::invalid_argument);
+}
+
+TEST(Throughput, RussianRouletteMatchesAcrossIntegrators)
+{
+    // roulette is decided by each hit itself, so both integrators cut short exactly the same paths
+    const CompiledScene scene{ DemoScenes::createRandomGroundScene(60, 3) };
+    Camera camera{};
+    camera.setAspectRatio(80.0f / 45.0f);
+    camera.lookAtFrom(Vec3(0.0f, 0.0f, 0.0f), Vec3(0.0f, 50.0f, 150.0f));
+    ThreadPool threadPool{2};
+
+    RayTracer ray_tracer;
+    ray_tracer.setMaxNumReflections(4);
+    ray_tracer.setMinThroughput(0.25f);
+    ray_tracer.setUsesRussianRoulette(true);
+    FrameBuffer recursive{80, 45};
+    ray_tracer.traceScene(camera, scene, recursive, threadPool);
+    ray_tracer.setIntegrator(Integrator::Wavefront);
+    FrameBuffer wavefront{80, 45};
+    ray_tracer.traceScene(camera, scene, wavefront, threadPool);
+
+    for (size_t i = 0; i < recursive.numPixels(); i++) {
+        ASSERT_EQ(recursive.getPixel(i).r, wavefront.getPixel(i).r) << "pixel " << i;
+        ASSERT_EQ(recursive.getPixel(i).g, wavefront.getPixel(i).g) << "pixel " << i;
+        ASSERT_EQ(recursive.getPixel(i).b, wavefront.getPixel(i).b) << "pixel " << i;
+    }
+}
+
+TEST(Lights, CulledLightsMatchAcrossIntegrators)
+{
+    // packets merge the differing lights of their lanes, while wavefronts batch hits by light, so both must agree
+    Scene scene = DemoScenes::createRandomGroundScene(60, 3);
+    std::mt19937 rng{ 5 };
+    std::uniform_real_distribution<float> offset{ -100.0f, 100.0f };
+    for (size_t i = 0; i < 50; i++) {
+        scene.addLight(PointLight(Vec3(offset(rng), 10.0f, 150.0f + offset(rng)), Color(0.5f, 0.5f, 0.5f), 1.0f, 0.0f, 1.0f));
+    }
+    const CompiledScene compiled{ scene };
+    Camera camera{};
+    camera.setAspectRatio(80.0f / 45.0f);
+    camera.lookAtFrom(Vec3(0.0f, 0.0f, 0.0f), Vec3(0.0f, 50.0f, 150.0f));
+    ThreadPool threadPool{2};
+
+    RayTracer ray_tracer;
+    ray_tracer.setMaxNumReflections(4);
+    FrameBuffer recursive{80, 45};
+    const RayStats recursiveStats = ray_tracer.traceScene(camera, compiled, recursive, threadPool);
+    ray_tracer.setIntegrator(Integrator::Wavefront);
+    FrameBuffer wavefront{80, 45};
+    const RayStats wavefrontStats = ray_tracer.traceScene(camera, compiled, wavefront, threadPool);
+
+    for (size_t i = 0; i < recursive.numPixels(); i++) {
+        ASSERT_EQ(recursive.getPixel(i).r, wavefront.getPixel(i).r) << "pixel " << i;
+        ASSERT_EQ(recursive.getPixel(i).g, wavefront.getPixel(i).g) << "pixel " << i;
+        ASSERT_EQ(recursive.getPixel(i).b, wavefront.getPixel(i).b) << "pixel " << i;
+    }
+    EXPECT_EQ(recursiveStats.occludedShadowRays, wavefrontStats.occludedShadowRays);
+    if constexpr (RayStats::IS_ENABLED) {
+        EXPECT_LT(recursiveStats.shadowRays, recursiveStats.intersectionHits * compiled.getNumLights());
+    }
+}
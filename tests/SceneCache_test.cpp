@@ -0,0 +1,171 @@
+#include "Material.hpp"
+#include "Objects.hpp"
+#include "TriangleMesh.hpp"
+#include "Lights.hpp"
+#include "Ray.hpp"
+#include "Scene.hpp"
+#include "CompiledScene.hpp"
+#include "SceneCache.hpp"
+#include "BVH.hpp"
+
+#include "gtest/gtest.h"
+
+#include <random>
+#include <functional>
+#include <fstream>
+#include <filesystem>
+#include <stdexcept>
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <limits>
+
+namespace {
+
+    Scene createMixedScene(float sphereRadius)
+    {
+        Material shiny{};
+        shiny.setWeights(0.50f, 0.50f);
+        shiny.setShininess(10);
+
+        Scene scene{};
+        scene.addLight(PointLight(Vec3(0, 10, 0), Color(1.0f, 0.5f, 0.5f), 1.0f, 0.1f, 0.01f));
+        for (int i = 0; i < 20; i++) {
+            scene.addSceneObject(Sphere(Vec3(i * 2.0f, 1.0f, -5.0f), sphereRadius, i % 2 == 0 ? shiny : Material()));
+        }
+        scene.addSceneObject(Triangle(Vec3(-50, 0, -50), Vec3(50, 0, -50), Vec3(50, 0, 50), Material()));
+        scene.addSceneObject(TriangleMesh({ Vec3(0, 0, 2), Vec3(4, 0, 2), Vec3(4, 4, 2), Vec3(0, 4, 2) },
+                                          { 0, 1, 2,  0, 2, 3 }, shiny));
+        return scene;
+    }
+
+    std::string tempPath(const std::string& name)
+    {
+        return (std::filesystem::temp_directory_path() / name).string();
+    }
+
+    // overwrite bytes within the given section, located via the table offset and section count ending the header
+    template <typename T>
+    void patchSection(const std::string& filepath, size_t section, size_t byteOffset, const T& value)
+    {
+        std::fstream fs(filepath, std::ios::in | std::ios::out | std::ios::binary);
+        uint64_t table[2];
+        fs.seekg(32);
+        fs.read(reinterpret_cast<char*>(table), sizeof(table));
+        const uint64_t index = section < table[1] ? section : table[1] + section;  // negative sections count from the end
+        uint64_t location[2];
+        fs.seekg(static_cast<std::streamoff>(table[0] + index * sizeof(location)));
+        fs.read(reinterpret_cast<char*>(location), sizeof(location));
+        fs.seekp(static_cast<std::streamoff>(location[0] + byteOffset));
+        fs.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    // shrink the given section by a number of bytes, leaving its contents in place
+    void shrinkSection(const std::string& filepath, size_t section, uint64_t numBytes)
+    {
+        std::fstream fs(filepath, std::ios::in | std::ios::out | std::ios::binary);
+        uint64_t table[2];
+        fs.seekg(32);
+        fs.read(reinterpret_cast<char*>(table), sizeof(table));
+        uint64_t location[2];
+        const std::streamoff entry = static_cast<std::streamoff>(table[0] + section * sizeof(location));
+        fs.seekg(entry);
+        fs.read(reinterpret_cast<char*>(location), sizeof(location));
+        location[1] -= numBytes;
+        fs.seekp(entry);
+        fs.write(reinterpret_cast<const char*>(location), sizeof(location));
+    }
+}
+
+TEST(SceneCache, RoundTrip)
+{
+    const Scene scene = createMixedScene(0.75f);
+    const CompiledScene compiled{scene};
+    const std::string filepath = tempPath("RayTracer_RoundTrip.rtscene");
+    SceneCache::write(filepath, compiled, SceneCache::fingerprint(scene));
+    ASSERT_TRUE(SceneCache::isUpToDate(filepath, SceneCache::fingerprint(scene)));
+
+    const CompiledScene cached = SceneCache::read(filepath);
+    EXPECT_EQ(cached.getNumLights(),     compiled.getNumLights());
+    EXPECT_EQ(cached.getNumMaterials(),  compiled.getNumMaterials());
+    EXPECT_EQ(cached.getNumSpheres(),    compiled.getNumSpheres());
+    EXPECT_EQ(cached.getNumTriangles(),  compiled.getNumTriangles());
+    EXPECT_EQ(cached.getNumMeshes(),     compiled.getNumMeshes());
+    EXPECT_EQ(cached.getNumPrimitives(), compiled.getNumPrimitives());
+    EXPECT_EQ(cached.getMaterial(0).shininess(), compiled.getMaterial(0).shininess());
+
+    std::mt19937 gen{ 11 };
+    std::uniform_real_distribution<float> p_dis(-5.0f, 40.0f);
+    std::uniform_real_distribution<float> d_dis(-1.0f, 1.0f);
+    for (int i = 0; i < 1000; i++) {
+        const Ray ray{ Vec3(p_dis(gen), 3.0f, p_dis(gen) * 0.25f), Math::normalize(Vec3(d_dis(gen), d_dis(gen), d_dis(gen) + 0.01f)) };
+        Intersection expected;
+        Intersection actual;
+        ASSERT_EQ(compiled.intersect(ray, expected), cached.intersect(ray, actual));
+        EXPECT_EQ(expected.t,         actual.t);
+        EXPECT_EQ(expected.primitive, actual.primitive);
+        EXPECT_EQ(expected.material,  actual.material);
+        EXPECT_EQ(compiled.isOccluded(ray, 5.0f), cached.isOccluded(ray, 5.0f));
+    }
+    std::filesystem::remove(filepath);
+}
+
+TEST(SceneCache, DetectsStaleOrInvalidCache)
+{
+    const Scene original = createMixedScene(0.75f);
+    const Scene modified = createMixedScene(0.80f);
+    EXPECT_EQ(SceneCache::fingerprint(original), SceneCache::fingerprint(createMixedScene(0.75f)));
+    EXPECT_NE(SceneCache::fingerprint(original), SceneCache::fingerprint(modified));
+
+    const std::string filepath = tempPath("RayTracer_Stale.rtscene");
+    SceneCache::write(filepath, CompiledScene(original), SceneCache::fingerprint(original));
+    EXPECT_FALSE(SceneCache::isUpToDate(filepath, SceneCache::fingerprint(modified)));
+    EXPECT_FALSE(SceneCache::isUpToDate(tempPath("RayTracer_Missing.rtscene"), SceneCache::fingerprint(original)));
+
+    // truncate such that the section table is lost
+    std::filesystem::resize_file(filepath, std::filesystem::file_size(filepath) / 2);
+    EXPECT_FALSE(SceneCache::isUpToDate(filepath, SceneCache::fingerprint(original)));
+    EXPECT_THROW(SceneCache::read(filepath), std::runtime_error);
+
+    std::ofstream(filepath, std::ios::out | std::ios::binary | std::ios::trunc) << "P6\n1 1\n255\n...";
+    EXPECT_THROW(SceneCache::read(filepath), std::runtime_error);
+    std::filesystem::remove(filepath);
+}
+
+TEST(SceneCache, RejectsCorruptContents)
+{
+    const Scene scene = createMixedScene(0.75f);
+    const CompiledScene compiled{scene};
+    const uint64_t fingerprint = SceneCache::fingerprint(scene);
+    const std::string filepath = tempPath("RayTracer_Corrupt.rtscene");
+
+    // sections 0 and 1 are the lights and materials, 2 and 6 are the sphere centers along x and sphere materials, and
+    // the sphere hierarchy's nodes are eighth from the end (followed by its indices, then the triangle and mesh
+    // hierarchies), with light and material records laid out as plain floats
+    const size_t lights          = 0;
+    const size_t materials       = 1;
+    const size_t centerX         = 2;
+    const size_t sphereMaterials = 6;
+    const size_t sphereNodes     = static_cast<size_t>(-8);
+    const auto corruptions = {
+        std::function<void()>([&] { patchSection(filepath, lights, 6 * sizeof(float), -1.0f); }),
+        std::function<void()>([&] { patchSection(filepath, lights, 3 * sizeof(float), std::numeric_limits<float>::quiet_NaN()); }),
+        std::function<void()>([&] { patchSection(filepath, materials, 9 * sizeof(float), 2.0f); }),
+        std::function<void()>([&] { patchSection(filepath, materials, 12 * sizeof(float), 0.0f); }),
+        std::function<void()>([&] { shrinkSection(filepath, centerX, sizeof(float)); }),
+        std::function<void()>([&] { patchSection(filepath, sphereMaterials, 0, uint32_t{ 1000 }); }),
+        std::function<void()>([&] { patchSection(filepath, sphereNodes, offsetof(BVH::Node, offset), uint32_t{ 1000 }); }),
+        std::function<void()>([&] { patchSection(filepath, sphereNodes, offsetof(BVH::Node, offset), uint32_t{ 0 }); }),
+    };
+    for (const std::function<void()>& corrupt : corruptions) {
+        SceneCache::write(filepath, compiled, fingerprint);
+        corrupt();
+        // contents aren't checked until read, which callers are expected to recover from by compiling again
+        EXPECT_TRUE(SceneCache::isUpToDate(filepath, fingerprint));
+        EXPECT_THROW(SceneCache::read(filepath), std::runtime_error);
+    }
+
+    SceneCache::write(filepath, compiled, fingerprint);
+    EXPECT_EQ(SceneCache::read(filepath).getNumPrimitives(), compiled.getNumPrimitives());
+    std::filesystem::remove(filepath);
+}
@@ -0,0 +1,20 @@
+#pragma once
+#include "Math.hpp"
+#include "Ray.hpp"
+
+#include <random>
+
+
+namespace TestRays {
+
+    // ray from anywhere in the cube [minOrigin, maxOrigin]^3 heading in any direction, nudged off the xy plane so
+    // that it's never degenerate
+    inline Ray randomRay(std::mt19937& gen, float minOrigin, float maxOrigin)
+    {
+        std::uniform_real_distribution<float> p_dis(minOrigin, maxOrigin);
+        std::uniform_real_distribution<float> d_dis(-1.0f, 1.0f);
+        const Vec3 origin{ p_dis(gen), p_dis(gen), p_dis(gen) };
+        const Vec3 direction{ d_dis(gen), d_dis(gen), d_dis(gen) + 0.01f };
+        return Ray(origin, Math::normalize(direction));
+    }
+}
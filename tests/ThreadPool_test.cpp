@@ -0,0 +1,89 @@
+#include "Material.hpp"
+#include "Objects.hpp"
+#include "Lights.hpp"
+#include "Camera.hpp"
+#include "Scene.hpp"
+#include "CompiledScene.hpp"
+#include "FrameBuffer.hpp"
+#include "RayTracer.hpp"
+#include "ThreadPool.hpp"
+
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+TEST(ThreadPool, RunsEveryTaskOnce)
+{
+    ThreadPool pool{4};
+    ASSERT_EQ(pool.numThreads(), 4u);
+
+    // reused across several jobs, including ones with fewer tasks than threads
+    for (size_t count : { 1000u, 3u, 0u, 1u, 257u }) {
+        std::vector<std::atomic<int>> visits(count);
+        std::atomic<bool> validWorker{ true };
+        pool.parallelFor(count, [&](size_t index, size_t worker) {
+            visits[index]++;
+            if (worker >= pool.numThreads()) {
+                validWorker = false;
+            }
+        });
+        for (const std::atomic<int>& visit : visits) {
+            EXPECT_EQ(visit.load(), 1);
+        }
+        EXPECT_TRUE(validWorker.load());
+    }
+}
+
+TEST(ThreadPool, RethrowsFirstTaskExceptionOnCaller)
+{
+    ThreadPool pool{4};
+    std::atomic<size_t> numRun{ 0 };
+    EXPECT_THROW(pool.parallelFor(10000, [&](size_t index, size_t) {
+        numRun++;
+        if (index % 100 == 7) {
+            throw std::runtime_error("task failed");
+        }
+    }), std::runtime_error);
+    EXPECT_LT(numRun.load(), 10000u);
+
+    // a cancelled job leaves the pool usable for the next one
+    std::atomic<size_t> numVisited{ 0 };
+    pool.parallelFor(1000, [&](size_t, size_t) { numVisited++; });
+    EXPECT_EQ(numVisited.load(), 1000u);
+}
+
+TEST(ThreadPool, DefaultsToHardwareConcurrency)
+{
+    ThreadPool pool{};
+    EXPECT_EQ(pool.numThreads(), ThreadPool::hardwareConcurrency());
+}
+
+TEST(ThreadPool, TiledTracingMatchesSingleThread)
+{
+    Scene scene{};
+    scene.addLight(PointLight(Vec3(0, 5, 5), Color(1.0f, 1.0f, 1.0f)));
+    scene.addSceneObject(Sphere(Vec3(-1, 0, -4), 1.0f, Material()));
+    scene.addSceneObject(Sphere(Vec3( 1, 0, -5), 1.5f, Material()));
+    scene.addSceneObject(Triangle(Vec3(-10, -1, -10), Vec3(10, -1, -10), Vec3(0, -1, 10), Material()));
+    const CompiledScene compiled{scene};
+
+    // dimensions chosen to leave partial tiles along both edges
+    Camera camera;
+    FrameBuffer expected{75, 45};
+    FrameBuffer actual{75, 45};
+    camera.setAspectRatio(expected.aspectRatio());
+    camera.lookAtFrom(Vec3(0, 0, -4), Vec3(0, 0, 5));
+
+    RayTracer ray_tracer;
+    ThreadPool singleThread{1};
+    ThreadPool multiThread{3};
+    ray_tracer.traceScene(camera, compiled, expected, singleThread);
+    ray_tracer.traceScene(camera, compiled, actual, multiThread);
+    for (size_t i = 0; i < expected.numPixels(); i++) {
+        EXPECT_EQ(expected.getPixel(i).r, actual.getPixel(i).r);
+        EXPECT_EQ(expected.getPixel(i).g, actual.getPixel(i).g);
+        EXPECT_EQ(expected.getPixel(i).b, actual.getPixel(i).b);
+    }
+}
@@ -0,0 +1,138 @@
+#include "Material.hpp"
+#include "Objects.hpp"
+#include "TriangleMesh.hpp"
+#include "Ray.hpp"
+#include "Scene.hpp"
+#include "CompiledScene.hpp"
+#include "TestRays.hpp"
+
+#include "gtest/gtest.h"
+
+#include <random>
+#include <stdexcept>
+
+namespace {
+
+    // unit octahedron, wound counter clockwise as seen from outside
+    TriangleMesh createOctahedron()
+    {
+        std::vector<Vec3> vertices{
+            Vec3( 1, 0, 0), Vec3(-1, 0, 0), Vec3(0,  1, 0), Vec3(0, -1, 0), Vec3(0, 0,  1), Vec3(0, 0, -1),
+        };
+        std::vector<uint32_t> indices{
+            0, 2, 4,  2, 1, 4,  1, 3, 4,  3, 0, 4,
+            2, 0, 5,  1, 2, 5,  3, 1, 5,  0, 3, 5,
+        };
+        return TriangleMesh(std::move(vertices), std::move(indices), Material());
+    }
+
+    // grid of unit squares in the xz plane, each split along its diagonal into two triangles
+    TriangleMesh createGrid(uint32_t numPerSide)
+    {
+        std::vector<Vec3> vertices;
+        std::vector<uint32_t> indices;
+        for (uint32_t z = 0; z <= numPerSide; z++) {
+            for (uint32_t x = 0; x <= numPerSide; x++) {
+                vertices.push_back(Vec3(static_cast<float>(x), 0.0f, static_cast<float>(z)));
+            }
+        }
+        for (uint32_t z = 0; z < numPerSide; z++) {
+            for (uint32_t x = 0; x < numPerSide; x++) {
+                const uint32_t corner = z * (numPerSide + 1) + x;
+                const uint32_t above  = corner + numPerSide + 1;
+                indices.insert(indices.end(), { corner, corner + 1, above + 1,  corner, above + 1, above });
+            }
+        }
+        return TriangleMesh(std::move(vertices), std::move(indices), Material());
+    }
+}
+
+TEST(TriangleMesh, SharedBuffers)
+{
+    TriangleMesh mesh = createGrid(4);
+    EXPECT_EQ(mesh.numVertices(), 25u);
+    EXPECT_EQ(mesh.numTriangles(), 32u);
+    EXPECT_EQ(mesh.accelerationStructure().numPrimitives(), 32u);
+    EXPECT_TRUE(Math::isApproximately(mesh.bounds().min, Vec3(0, 0, 0)));
+    EXPECT_TRUE(Math::isApproximately(mesh.bounds().max, Vec3(4, 0, 4)));
+}
+
+TEST(TriangleMesh, InvalidIndices)
+{
+    EXPECT_THROW(TriangleMesh({ Vec3(0, 0, 0), Vec3(1, 0, 0), Vec3(0, 1, 0) }, { 0, 1 }, Material()),
+                 std::invalid_argument);
+    EXPECT_THROW(TriangleMesh({ Vec3(0, 0, 0), Vec3(1, 0, 0), Vec3(0, 1, 0) }, { 0, 1, 3 }, Material()),
+                 std::invalid_argument);
+    // without any triangles there are no bounds to build a hierarchy over
+    EXPECT_THROW(TriangleMesh({ Vec3(0, 0, 0), Vec3(1, 0, 0), Vec3(0, 1, 0) }, {}, Material()),
+                 std::invalid_argument);
+}
+
+TEST(TriangleMesh, ClosedMeshHasNoCracks)
+{
+    TriangleMesh mesh = createOctahedron();
+    std::vector<Vec3> directions{
+        Vec3(1, 0, 0), Vec3(0, -1, 0), Vec3(0, 0, 1),      // through vertices
+        Vec3(1, 1, 0), Vec3(-1, 0, 1), Vec3(0, -1, -1),    // along edges
+        Vec3(1, 1, 1), Vec3(-1, 2, -3),
+    };
+    std::mt19937 gen{ 99 };
+    std::uniform_real_distribution<float> d_dis(-1.0f, 1.0f);
+    for (int i = 0; i < 1000; i++) {
+        directions.push_back(Vec3(d_dis(gen), d_dis(gen), d_dis(gen)));
+    }
+
+    for (const Vec3& direction : directions) {
+        const Ray ray{ Vec3(0, 0, 0), Math::normalize(direction) };
+        Intersection intersection;
+        ASSERT_TRUE(mesh.intersect(ray, intersection)) << ray;
+        // the octahedron's faces all lie on planes |x| + |y| + |z| = 1
+        const Vec3 p = intersection.point;
+        EXPECT_NEAR(std::abs(p.x) + std::abs(p.y) + std::abs(p.z), 1.0f, 0.001f) << ray;
+        EXPECT_GT(Math::dot(intersection.normal, ray.direction), 0.0f) << ray;
+    }
+}
+
+TEST(TriangleMesh, SharedEdgesHitExactlyOnce)
+{
+    TriangleMesh mesh = createGrid(8);
+    for (float x = 0.125f; x < 8.0f; x += 0.25f) {
+        // straight down onto the diagonals, and onto the edges between neighboring squares
+        const Ray diagonal{ Vec3(x, 5.0f, x), Vec3(0, -1, 0) };
+        const Ray edge    { Vec3(x, 5.0f, std::floor(x) + 1.0f), Vec3(0, -1, 0) };
+        for (const Ray& ray : { diagonal, edge }) {
+            Intersection intersection;
+            ASSERT_TRUE(mesh.intersect(ray, intersection)) << ray;
+            EXPECT_NEAR(intersection.t, 5.0f, 0.001f);
+            EXPECT_TRUE(mesh.occluded(ray, 6.0f));
+            EXPECT_FALSE(mesh.occluded(ray, 4.0f));
+        }
+    }
+}
+
+TEST(TriangleMesh, CompiledMatchesObject)
+{
+    Scene scene{};
+    scene.addSceneObject(Sphere(Vec3(0, 3, 0), 1.0f, Material()));
+    scene.addSceneObject(createGrid(6));
+    scene.addSceneObject(createOctahedron());
+    CompiledScene compiled{scene};
+    ASSERT_EQ(compiled.getNumMeshes(), 2u);
+    ASSERT_EQ(compiled.getNumPrimitives(), 1u + 72u + 8u);
+
+    std::mt19937 gen{ 7 };
+    for (int i = 0; i < 2000; i++) {
+        const Ray ray = TestRays::randomRay(gen, -2.0f, 8.0f);
+        Intersection expected;
+        Intersection actual;
+        const bool expectedHit = scene.intersect(ray, expected);
+        ASSERT_EQ(expectedHit, compiled.intersect(ray, actual));
+        if (expectedHit) {
+            EXPECT_NEAR(expected.t, actual.t, 0.001f);
+            EXPECT_TRUE(Math::isApproximately(expected.normal, actual.normal));
+            // the hit primitive doesn't block a ray leaving from it
+            EXPECT_FALSE(compiled.isOccluded(Ray(actual.point, ray.direction), 1e-04f, actual.primitive));
+        }
+        EXPECT_EQ(scene.isOccluded(ray, 3.0f), compiled.isOccluded(ray, 3.0f));
+    }
+}